@@ -0,0 +1,83 @@
+#include "benchCorpus.h"
+#include <random>
+
+#include "solver/coordinates.h"
+#include "solver/randomState.h"
+
+//Two turns of the same face in a row would cancel or merge, every other sequence is kept
+static void applyRandomMoves(cubieCube& cube, std::mt19937_64& random, int length)
+{
+    int lastFace = -1;
+    for (int i = 0; i < length; i++)
+    {
+        int m;
+        do
+        {
+            m = (int)(random() % MOVE_COUNT);
+        } while (m / 3 == lastFace);
+        cube.move(m);
+        lastFace = m / 3;
+    }
+}
+
+benchCorpus randomStateCorpus(size_t count, uint64_t seed)
+{
+    randomStateGenerator generator(seed);
+    return benchCorpus{ "random", generator.generate(count) };
+}
+
+benchCorpus superflipCorpus(size_t count, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    cubieCube superflip = cubieCube::solved();
+    setFlip(superflip, FLIP_COUNT - 1);
+
+    benchCorpus corpus{ "superflip", {} };
+    corpus.cubes.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        cubieCube cube = superflip;
+        applyRandomMoves(cube, random, (int)(i % 5));
+        corpus.cubes.push_back(cube);
+    }
+    return corpus;
+}
+
+benchCorpus shortScrambleCorpus(size_t count, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    benchCorpus corpus{ "short", {} };
+    corpus.cubes.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        cubieCube cube = cubieCube::solved();
+        applyRandomMoves(cube, random, 1 + (int)(i % SHORT_SCRAMBLE_MAX_LENGTH));
+        corpus.cubes.push_back(cube);
+    }
+    return corpus;
+}
+
+bigCubeCorpus bigScrambleCorpus(int size, size_t count, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    const bigCubeModel& model = bigCubeModel::get(size);
+    std::string side = std::to_string(size);
+    bigCubeCorpus corpus{ side + "x" + side + "x" + side, {}, {} };
+    corpus.cubes.reserve(count);
+    corpus.scrambles.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        std::vector<uint8_t> scramble;
+        while ((int)scramble.size() < BIG_SCRAMBLE_MOVES_PER_LAYER * model.layers())
+        {
+            int m = (int)(random() % model.moveCount());
+            if (model.isMove(m) && (scramble.empty() || scramble.back() / 3 != m / 3))
+                scramble.push_back((uint8_t)m);
+        }
+        bigCube cube(size);
+        cube.apply(scramble);
+        corpus.cubes.push_back(cube);
+        corpus.scrambles.push_back(scramble);
+    }
+    return corpus;
+}
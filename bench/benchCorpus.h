@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "solver/bigCube.h"
+#include "solver/cubieCube.h"
+
+//Fixed-seed cube sets the benchmark replays. The same count and seed give the same cubes on every platform
+//(std::mt19937_64 is fully specified, the distributions are not, so they are avoided), which keeps results comparable commit to commit
+struct benchCorpus
+{
+    std::string name;
+    std::vector<cubieCube> cubes;
+};
+
+const uint64_t BENCH_SEED = 20240607;
+const int SHORT_SCRAMBLE_MAX_LENGTH = 12;
+const int BIG_SCRAMBLE_MOVES_PER_LAYER = 20;    //Scramble length per layer a face can turn, 40 on a 4x4x4 and 80 on a 7x7x7
+
+//Uniformly random legal states (randomStateGenerator)
+benchCorpus randomStateCorpus(size_t count, uint64_t seed);
+
+//The superflip (20 moves) and the superflip followed by 1 to 4 random moves, positions two-phase needs long phase 1 searches for
+benchCorpus superflipCorpus(size_t count, uint64_t seed);
+
+//Scrambles of 1 to SHORT_SCRAMBLE_MAX_LENGTH moves, cycling through the lengths, short enough for the optimal solver
+benchCorpus shortScrambleCorpus(size_t count, uint64_t seed);
+
+//Big cubes scrambled with random layer turns, named after their size ("4x4x4")
+struct bigCubeCorpus
+{
+    std::string name;
+    std::vector<bigCube> cubes;
+    std::vector<std::vector<uint8_t>> scrambles;
+};
+
+bigCubeCorpus bigScrambleCorpus(int size, size_t count, uint64_t seed);
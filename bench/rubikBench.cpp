@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchCorpus.h"
+#include "cpuFeatures.h"
+#include "solver/bidirectionalSolver.h"
+#include "solver/bigCubeSolver.h"
+#include "solver/optimalSolver.h"
+#include "solver/tableFile.h"
+#include "solver/thistlethwaiteSolver.h"
+#include "solver/twoPhaseSolver.h"
+
+//rubik-bench: replays the fixed corpora through every solver and prints one JSON report on stdout
+//Built with RUBIK_SOLVER_STATS=1, so the pruning value distribution is counted too (which costs a few percent of node rate)
+
+struct benchOptions
+{
+    size_t randomCount = 10000;
+    size_t superflipCount = 100;
+    size_t shortCount = 1000;
+    size_t optimalCount = 120;      //Taken from the start of the short corpus
+    size_t optimalRandomCount = 0;  //Taken from the start of the random corpus, hours per state on one core even with 8 edge pieces
+    size_t bigCount = 1000;         //Per size from 4x4x4 to 7x7x7
+    int edgePieces = MIN_EDGE_PATTERN_PIECES;
+    std::vector<pruneEncoding> encodings = { pruneEncoding::nibble, pruneEncoding::cachedNibble, pruneEncoding::mod3, pruneEncoding::base3 };
+    size_t frontierBytes = DEFAULT_FRONTIER_BYTES;
+    uint64_t seed = BENCH_SEED;
+    std::string outPath;
+    solverOptions twoPhase;
+    optimalOptions optimal;
+    bidirectionalOptions bidirectional;
+};
+
+struct benchRun
+{
+    std::string solver;
+    std::string corpus;
+    size_t solved = 0;
+    size_t failed = 0;
+    size_t wrong = 0;       //Counted in failed too: found, but the moves do not solve the cube
+    uint64_t moveTotal = 0;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+    std::vector<float> latencies;
+    uint64_t pruneHits[2][PRUNE_HIT_VALUES] = {};
+
+    void add(const solverResult& result, bool solves, double latency)
+    {
+        latencies.push_back((float)latency);
+        if (result.found && solves)
+        {
+            solved++;
+            moveTotal += result.moves.size();
+        }
+        else
+            failed++;
+        if (result.found && !solves)
+            wrong++;
+        nodes += result.nodes;
+        for (int phase = 0; phase < 2; phase++)
+            for (int value = 0; value < PRUNE_HIT_VALUES; value++)
+                pruneHits[phase][value] += result.pruneHits[phase][value];
+    }
+
+    std::string json(bool twoPhases)
+    {
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) -> double
+        {
+            if (latencies.empty())
+                return 0.0;
+            return latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))] * 1000.0;
+        };
+        auto hits = [&](int phase)
+        {
+            std::ostringstream out;
+            out << "[";
+            for (int value = 0; value < PRUNE_HIT_VALUES; value++)
+                out << (value ? "," : "") << pruneHits[phase][value];
+            out << "]";
+            return out.str();
+        };
+
+        size_t count = latencies.size();
+        std::ostringstream out;
+        out << "{\"solver\":\"" << solver << "\",\"corpus\":\"" << corpus << "\",\"count\":" << count
+            << ",\"solved\":" << solved << ",\"failed\":" << failed << ",\"wrong\":" << wrong << ",\"seconds\":" << seconds
+            << ",\"solvesPerSecond\":" << (seconds > 0.0 ? count / seconds : 0.0)
+            << ",\"averageLength\":" << (solved ? (double)moveTotal / solved : 0.0)
+            << ",\"nodes\":" << nodes << ",\"nodesPerSolve\":" << (count ? (double)nodes / count : 0.0)
+            << ",\"nodesPerSecond\":" << (seconds > 0.0 ? nodes / seconds : 0.0)
+            << ",\"latencyMs\":{\"p50\":" << percentile(0.50) << ",\"p95\":" << percentile(0.95) << ",\"p99\":" << percentile(0.99)
+            << ",\"max\":" << (latencies.empty() ? 0.0 : latencies.back() * 1000.0) << "}"
+            << ",\"pruneHits\":{\"" << (twoPhases ? "phase1" : "heuristic") << "\":" << hits(0);
+        if (twoPhases)
+            out << ",\"phase2\":" << hits(1);
+        out << "}}";
+        return out.str();
+    }
+};
+
+static bool solves(const cubieCube& scrambled, const std::vector<uint8_t>& moves)
+{
+    cubieCube cube = scrambled;
+    cube.apply(moves);
+    return cube == cubieCube::solved();
+}
+
+static bool solves(const bigCube& scrambled, const std::vector<uint8_t>& moves)
+{
+    bigCube cube = scrambled;
+    cube.apply(moves);
+    return cube.isSolved();
+}
+
+//Solutions are replayed outside the timed section, so checking them does not skew the latencies
+template <typename Corpus, typename Solve>
+static benchRun runCorpus(const char* solver, const Corpus& corpus, size_t count, Solve solve)
+{
+    benchRun run;
+    run.solver = solver;
+    run.corpus = corpus.name;
+    count = std::min(count, corpus.cubes.size());
+    run.latencies.reserve(count);
+
+    double checkSeconds = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        auto solveStart = std::chrono::steady_clock::now();
+        solverResult result = solve(corpus.cubes[i]);
+        double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - solveStart).count();
+        auto checkStart = std::chrono::steady_clock::now();
+        run.add(result, result.found && solves(corpus.cubes[i], result.moves), latency);
+        checkSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - checkStart).count();
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - checkSeconds;
+
+    std::cerr << solver << " / " << corpus.name << ": " << count << " solves in " << run.seconds << " s\n";
+    if (run.wrong)
+        std::cerr << solver << " / " << corpus.name << ": " << run.wrong << " solutions do not solve their cube\n";
+    return run;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//Known results for the move cubes, checked before anything is timed so a broken move definition cannot pass as a fast solver:
+//the facelets after R, every face turn back to solved after four turns (M^4 = id) and the order of R U (105)
+static void checkMoveCubes()
+{
+    cubieCube r = cubieCube::solved();
+    r.move(parseMoves("R")[0]);
+    if (r.toFacelets() != "UUFUUFUUFRRRRRRRRRFFDFFDFFDDDBDDBDDBLLLLLLLLLUBBUBBUBB")
+        throw std::runtime_error("Move cube R gives the wrong facelets!");
+
+    for (int face = 0; face < 6; face++)
+    {
+        cubieCube cube = cubieCube::solved();
+        for (int turn = 0; turn < 4; turn++)
+            cube.move(face * 3);
+        if (cube != cubieCube::solved())
+            throw std::runtime_error("Four quarter turns of " + moveName(face * 3) + " do not return to solved!");
+    }
+
+    std::vector<uint8_t> rightUp = parseMoves("R U");
+    cubieCube cube = cubieCube::solved();
+    int order = 0;
+    do
+    {
+        applyMoves(cube, rightUp.data(), rightUp.size());
+        order++;
+    } while (cube != cubieCube::solved() && order <= 105);
+    if (order != 105)
+        throw std::runtime_error("R U does not have order 105!");
+}
+
+static int runBenchmark(const benchOptions& options)
+{
+    checkMoveCubes();
+
+    benchCorpus randomStates = randomStateCorpus(std::max(options.randomCount, options.optimalRandomCount), options.seed);
+    benchCorpus superflips = superflipCorpus(options.superflipCount, options.seed + 1);
+    benchCorpus shortScrambles = shortScrambleCorpus(std::max(options.shortCount, options.optimalCount), options.seed + 2);
+
+    std::vector<std::string> runs;
+
+    //Table loading is timed separately so it never shows up in the first latencies
+    auto tableStart = std::chrono::steady_clock::now();
+    twoPhaseSolver twoPhase;
+    double twoPhaseTables = secondsSince(tableStart);
+
+    auto solveTwoPhase = [&](const cubieCube& cube) { return twoPhase.solve(cube, options.twoPhase); };
+    runs.push_back(runCorpus("twoPhase", randomStates, options.randomCount, solveTwoPhase).json(true));
+    runs.push_back(runCorpus("twoPhase", superflips, options.superflipCount, solveTwoPhase).json(true));
+    runs.push_back(runCorpus("twoPhase", shortScrambles, options.shortCount, solveTwoPhase).json(true));
+
+    //The fallback engine does a fixed amount of work per cube, so it gets the random and superflip corpora in full
+    tableStart = std::chrono::steady_clock::now();
+    thistlethwaiteSolver thistlethwaite;
+    double thistlethwaiteTables = secondsSince(tableStart);
+
+    auto solveThistlethwaite = [&](const cubieCube& cube) { return thistlethwaite.solve(cube); };
+    runs.push_back(runCorpus("thistlethwaite", randomStates, options.randomCount, solveThistlethwaite).json(false));
+    runs.push_back(runCorpus("thistlethwaite", superflips, options.superflipCount, solveThistlethwaite).json(false));
+
+    //One optimal run per pattern table encoding (both tables encoded alike): memory against pruning and lookups per second
+    double optimalTables = 0.0;
+    std::ostringstream patternTables;
+    for (size_t i = 0; i < options.encodings.size() && options.optimalCount > 0; i++)
+    {
+        patternEncodings encodings = { options.encodings[i], options.encodings[i] };
+        const char* name = pruneEncodingName(options.encodings[i]);
+        tableStart = std::chrono::steady_clock::now();
+        patternDatabase database;
+        database.loadOrGenerate(tableDirectory() + "/" + patternDatabase::fileName(options.edgePieces, encodings), options.edgePieces, encodings);
+        optimalSolver optimal(database);
+        double seconds = secondsSince(tableStart);
+        if (i == 0)
+            optimalTables = seconds;
+        patternTables << (i ? "," : "") << "\"" << name << "\":{\"bytes\":" << database.bytes() << ",\"cacheBytes\":" << database.cacheBytes()
+                      << ",\"seconds\":" << seconds << "}";
+
+        auto solveOptimal = [&](const cubieCube& cube) { return optimal.solve(cube, options.optimal); };
+        std::string solver = encodings.edges == pruneEncoding::nibble ? "optimal" : std::string("optimal-") + name;
+        runs.push_back(runCorpus(solver.c_str(), shortScrambles, options.optimalCount, solveOptimal).json(false));
+
+        //Random states are about 18 moves from solved, the case the table sizes are chosen for. One encoding is enough
+        if (i == 0 && options.optimalRandomCount > 0)
+            runs.push_back(runCorpus(solver.c_str(), randomStates, options.optimalRandomCount, solveOptimal).json(false));
+    }
+
+    //Meet in the middle on the same short scrambles, up to the length a dispatcher would hand it. Longer ones count as failed
+    double frontierTables = 0.0;
+    std::ostringstream frontier;
+    int frontierDepth = frontierTable::depthForBudget(options.frontierBytes);
+    if (frontierDepth > 0 && options.optimalCount > 0)
+    {
+        tableStart = std::chrono::steady_clock::now();
+        const frontierTable& table = frontierTable::get(frontierDepth);
+        frontierTables = secondsSince(tableStart);
+        frontier << "\"depth\":" << table.depth() << ",\"bytes\":" << table.bytes() << ",\"states\":" << table.states();
+
+        bidirectionalSolver bidirectional(table);
+        bidirectionalOptions bidirectionalLimits = options.bidirectional;
+        bidirectionalLimits.maxLength = table.depth() + FRONTIER_FORWARD_DEPTH;
+        auto solveBidirectional = [&](const cubieCube& cube) { return bidirectional.solve(cube, bidirectionalLimits); };
+        runs.push_back(runCorpus("bidirectional", shortScrambles, options.optimalCount, solveBidirectional).json(false));
+    }
+
+    //Big cubes: layer turns per second replaying the scrambles, then reduction solves with the fixed-work 3x3x3 engine
+    std::ostringstream bigMoves;
+    if (options.bigCount > 0)
+    {
+        bigCubeSolver reduction(solverEngine::thistlethwaite);
+        for (int size = BIG_CUBE_MIN_SIZE; size <= BIG_CUBE_MAX_SIZE; size++)
+        {
+            bigCubeCorpus corpus = bigScrambleCorpus(size, options.bigCount, options.seed + 3 + size);
+            bigCubeCycles::get(size);   //Built here so the first solve's latency does not include it
+
+            bigCube cube(size);
+            uint64_t moveTotal = 0;
+            auto moveStart = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < 10; pass++)
+            {
+                for (const std::vector<uint8_t>& scramble : corpus.scrambles)
+                {
+                    cube.apply(scramble);
+                    moveTotal += scramble.size();
+                }
+            }
+            double moveSeconds = secondsSince(moveStart);
+            bigMoves << (size > BIG_CUBE_MIN_SIZE ? "," : "") << "\"" << corpus.name << "\":"
+                     << (moveSeconds > 0.0 ? moveTotal / moveSeconds : 0.0);
+
+            auto solveBig = [&](const bigCube& scrambled) { return reduction.solve(scrambled); };
+            runs.push_back(runCorpus("reduction", corpus, options.bigCount, solveBig).json(false));
+        }
+    }
+
+    std::ostringstream report;
+    report << "{\"benchmark\":\"rubik-bench\",\"seed\":" << options.seed << ",\"cpu\":\"" << cpuLevelName(dispatchLevel()) << "\""
+           << ",\"threads\":" << options.twoPhase.threads << ",\"timeLimit\":" << options.twoPhase.timeLimitSeconds
+           << ",\"targetLength\":" << options.twoPhase.targetLength << ",\"edgePieces\":" << options.edgePieces
+           << ",\"tableSeconds\":{\"twoPhase\":" << twoPhaseTables << ",\"thistlethwaite\":" << thistlethwaiteTables
+           << ",\"optimal\":" << optimalTables << ",\"frontier\":" << frontierTables << "},\"patternTables\":{" << patternTables.str()
+           << "},\"frontierTable\":{" << frontier.str() << "},\"bigCubeMovesPerSecond\":{" << bigMoves.str() << "},\"runs\":[\n";
+    for (size_t i = 0; i < runs.size(); i++)
+        report << "  " << runs[i] << (i + 1 < runs.size() ? ",\n" : "\n");
+    report << "]}\n";
+
+    std::cout << report.str();
+    if (!options.outPath.empty())
+    {
+        std::ofstream file(options.outPath);
+        file << report.str();
+        if (!file)
+            throw std::runtime_error("Failed to write the benchmark report!");
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    benchOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--random" && hasValue)
+            options.randomCount = (size_t)atoll(argv[++i]);
+        else if (argument == "--superflip" && hasValue)
+            options.superflipCount = (size_t)atoll(argv[++i]);
+        else if (argument == "--short" && hasValue)
+            options.shortCount = (size_t)atoll(argv[++i]);
+        else if (argument == "--optimal" && hasValue)
+            options.optimalCount = (size_t)atoll(argv[++i]);
+        else if (argument == "--optimal-random" && hasValue)
+            options.optimalRandomCount = (size_t)atoll(argv[++i]);
+        else if (argument == "--big" && hasValue)
+            options.bigCount = (size_t)atoll(argv[++i]);
+        else if (argument == "--edges" && hasValue)
+            options.edgePieces = atoi(argv[++i]);
+        else if (argument == "--encodings" && hasValue)
+        {
+            //Comma separated, e.g. nibble,mod3
+            options.encodings.clear();
+            std::stringstream list(argv[++i]);
+            std::string name;
+            pruneEncoding encoding;
+            while (std::getline(list, name, ','))
+            {
+                if (!parsePruneEncoding(name, encoding))
+                {
+                    std::cerr << "Unknown table encoding: " << name << "\n";
+                    return EXIT_FAILURE;
+                }
+                options.encodings.push_back(encoding);
+            }
+        }
+        else if (argument == "--frontier-mb" && hasValue)
+            options.frontierBytes = (size_t)atoll(argv[++i]) << 20;
+        else if (argument == "--seed" && hasValue)
+            options.seed = (uint64_t)strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--threads" && hasValue)
+            options.twoPhase.threads = options.optimal.threads = options.bidirectional.threads = atoi(argv[++i]);
+        else if (argument == "--time-limit" && hasValue)
+            options.twoPhase.timeLimitSeconds = atof(argv[++i]);
+        else if (argument == "--target" && hasValue)
+            options.twoPhase.targetLength = atoi(argv[++i]);
+        else if (argument == "--out" && hasValue)
+            options.outPath = argv[++i];
+        else
+        {
+            std::cerr << "Usage: rubik-bench [--random N] [--superflip N] [--short N] [--optimal N] [--optimal-random N] [--big N] [--edges 6-8] [--encodings nibble,cached,mod3,base3] [--frontier-mb MB]"
+                         " [--seed N] [--threads N] [--time-limit SECONDS] [--target MOVES] [--out PATH]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        return runBenchmark(options);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
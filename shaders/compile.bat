@@ -1,3 +1,5 @@
 C:/VulkanSDK/1.3.283.0/Bin/glslc.exe default.vert -o vert.spv
 C:/VulkanSDK/1.3.283.0/Bin/glslc.exe default.frag -o frag.spv
+C:/VulkanSDK/1.3.283.0/Bin/glslc.exe hud.vert -o hudVert.spv
+C:/VulkanSDK/1.3.283.0/Bin/glslc.exe hud.frag -o hudFrag.spv
 pause
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "cpuFeatures.h"
+#include <cstdlib>
+#include <cstring>
+
+#if RUBIK_X86 && defined(_MSC_VER)
+    #include <intrin.h>
+    #include <immintrin.h>
+#endif
+
+static cpuFeatures queryCpuFeatures()
+{
+    cpuFeatures features;
+#if RUBIK_X86 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    features.ssse3 = (info[2] & (1 << 9)) != 0;
+    features.sse41 = (info[2] & (1 << 19)) != 0;
+    features.popcnt = (info[2] & (1 << 23)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    //AVX2 is only usable if the OS saves the YMM registers on context switches
+    bool ymmEnabled = osxsave && avx && ((_xgetbv(0) & 0x6) == 0x6);
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        features.avx2 = ymmEnabled && (info[1] & (1 << 5)) != 0;
+        features.bmi2 = (info[1] & (1 << 8)) != 0;
+    }
+#elif RUBIK_X86 && (defined(__GNUC__) || defined(__clang__))
+    //The builtins already account for OS support of the YMM state
+    __builtin_cpu_init();
+    features.ssse3 = __builtin_cpu_supports("ssse3");
+    features.sse41 = __builtin_cpu_supports("sse4.1");
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.bmi2 = __builtin_cpu_supports("bmi2");
+#endif
+    return features;
+}
+
+const cpuFeatures& detectCpuFeatures()
+{
+    static const cpuFeatures features = queryCpuFeatures();
+    return features;
+}
+
+static cpuLevel queryDispatchLevel()
+{
+    const cpuFeatures& features = detectCpuFeatures();
+    cpuLevel level = cpuLevel::scalar;
+    if (features.ssse3 && features.sse41)
+        level = cpuLevel::ssse3;
+    if (level == cpuLevel::ssse3 && features.avx2 && features.bmi2 && features.popcnt)
+        level = cpuLevel::avx2;
+
+    //Allow forcing a lower level so fallbacks can be exercised on AVX2 machines
+    const char* forced = std::getenv("RUBIK_CPU_DISPATCH");
+    if (forced != nullptr)
+    {
+        cpuLevel requested = level;
+        if (strcmp(forced, "scalar") == 0)
+            requested = cpuLevel::scalar;
+        else if (strcmp(forced, "ssse3") == 0)
+            requested = cpuLevel::ssse3;
+        if (requested < level)
+            level = requested;
+    }
+    return level;
+}
+
+cpuLevel dispatchLevel()
+{
+    static const cpuLevel level = queryDispatchLevel();
+    return level;
+}
+
+const char* cpuLevelName(cpuLevel level)
+{
+    switch (level)
+    {
+    case cpuLevel::avx2:
+        return "avx2";
+    case cpuLevel::ssse3:
+        return "ssse3";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+//Runtime CPU dispatch support
+//Kernels are compiled several times with different target attributes and the best one for the running CPU is chosen once at start up,
+//so one binary built with the portable profile still uses AVX2 when it is available
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define RUBIK_X86 1
+#else
+    #define RUBIK_X86 0
+#endif
+
+//Marks a function as compiled for a specific instruction set. MSVC emits any intrinsic without this, GCC/Clang need the attribute
+#if RUBIK_X86 && (defined(__GNUC__) || defined(__clang__))
+    #define RUBIK_TARGET_SSSE3 __attribute__((target("ssse3,sse4.1")))
+    #define RUBIK_TARGET_AVX2 __attribute__((target("avx2,bmi2,popcnt")))
+#else
+    #define RUBIK_TARGET_SSSE3
+    #define RUBIK_TARGET_AVX2
+#endif
+
+//Starts loading the cache line holding address, so several independent table lookups can wait on memory at the same time
+#if defined(__GNUC__) || defined(__clang__)
+    #define RUBIK_PREFETCH(address) __builtin_prefetch(address)
+#elif RUBIK_X86
+    #include <intrin.h>
+    #define RUBIK_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+    #define RUBIK_PREFETCH(address) ((void)0)
+#endif
+
+//Instruction set levels in increasing order, each one implies the ones below it
+enum class cpuLevel : uint8_t
+{
+    scalar = 0,
+    ssse3 = 1,      //SSSE3 + SSE4.1 (pshufb, blend, ptest)
+    avx2 = 2        //AVX2 + BMI2 + POPCNT, with OS support for the YMM state
+};
+
+struct cpuFeatures
+{
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool popcnt = false;
+    bool avx2 = false;
+    bool bmi2 = false;
+};
+
+//Detected once and cached
+const cpuFeatures& detectCpuFeatures();
+
+//Highest level the kernels may use. The RUBIK_CPU_DISPATCH environment variable (scalar, ssse3, avx2) can lower it for testing fallbacks
+cpuLevel dispatchLevel();
+
+const char* cpuLevelName(cpuLevel level);
@@ -0,0 +1,188 @@
+#include "debugMessageSink.h"
+#include <iostream>
+#include <cstring>
+
+debugMessageSink::debugMessageSink()
+    : mSlots(new slot[QUEUE_SIZE]),
+      mSeverityMask(VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT),
+      mDefaultRateLimit(5)
+{
+    //Each slot starts out owned by the producer whose position equals its index
+    for (size_t i = 0; i < QUEUE_SIZE; i++)
+        mSlots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+debugMessageSink::~debugMessageSink()
+{
+    stop();
+}
+
+void debugMessageSink::start()
+{
+    if (mRunning.exchange(true))
+        return;
+    mLogger = std::thread(&debugMessageSink::loggerLoop, this);
+}
+
+void debugMessageSink::stop()
+{
+    if (!mRunning.exchange(false))
+        return;
+    mLogger.join();
+
+    //Anything pushed while the logger was shutting down still gets written
+    drain();
+    uint64_t suppressed = 0;
+    for (const auto& entry : mIdStates)
+        suppressed += entry.second.suppressed;
+    if (suppressed > 0)
+        std::cerr << "validation layer: suppressed " << suppressed << " repeats\n";
+    mIdStates.clear();
+    std::cerr.flush();
+}
+
+bool debugMessageSink::push(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData)
+{
+    if (!(mSeverityMask.load(std::memory_order_relaxed) & severity))
+        return false;
+
+    //Claim a slot (bounded MPMC ring, only ever drained by the logger thread)
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+    slot* target;
+    for (;;)
+    {
+        target = &mSlots[pos & (QUEUE_SIZE - 1)];
+        size_t sequence = target->sequence.load(std::memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+        if (difference == 0)
+        {
+            if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            //Queue is full. Never block inside the driver, just count the loss
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+    }
+
+    target->message.severity = severity;
+    target->message.type = type;
+    target->message.messageIdNumber = pCallbackData->messageIdNumber;
+    const char* text = pCallbackData->pMessage ? pCallbackData->pMessage : "";
+    strncpy(target->message.text, text, sizeof(target->message.text) - 1);
+    target->message.text[sizeof(target->message.text) - 1] = '\0';
+
+    //Publish the slot to the consumer
+    target->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void debugMessageSink::setSeverityFilter(VkDebugUtilsMessageSeverityFlagsEXT severityMask)
+{
+    mSeverityMask.store(severityMask, std::memory_order_relaxed);
+}
+
+void debugMessageSink::setRateLimit(uint32_t messagesPerSecond)
+{
+    mDefaultRateLimit.store(messagesPerSecond, std::memory_order_relaxed);
+}
+
+void debugMessageSink::setRateLimit(int32_t messageIdNumber, uint32_t messagesPerSecond)
+{
+    std::lock_guard<std::mutex> lock(mLimitMutex);
+    mRateLimits[messageIdNumber] = messagesPerSecond;
+}
+
+bool debugMessageSink::pop(debugMessage& message)
+{
+    slot& source = mSlots[mDequeuePos & (QUEUE_SIZE - 1)];
+    if (source.sequence.load(std::memory_order_acquire) != mDequeuePos + 1)
+        return false;
+
+    message = source.message;
+
+    //Hand the slot back to producers one lap ahead
+    source.sequence.store(mDequeuePos + QUEUE_SIZE, std::memory_order_release);
+    mDequeuePos++;
+    return true;
+}
+
+void debugMessageSink::drain()
+{
+    debugMessage message;
+    while (pop(message))
+        write(message);
+}
+
+void debugMessageSink::loggerLoop()
+{
+    uint64_t reportedDrops = 0;
+    while (mRunning.load(std::memory_order_relaxed))
+    {
+        drain();
+
+        uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops)
+        {
+            std::cerr << "validation layer: " << dropped - reportedDrops << " messages dropped, queue full\n";
+            reportedDrops = dropped;
+        }
+
+        //One flush per batch instead of one per message
+        std::cerr.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+int32_t debugMessageSink::rateKey(int32_t messageIdNumber, const char* text)
+{
+    if (messageIdNumber != 0)
+        return messageIdNumber;
+
+    uint32_t hash = 2166136261u;
+    for (const char* c = text; *c; c++)
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    return (int32_t)hash;
+}
+
+void debugMessageSink::write(const debugMessage& message)
+{
+    int32_t key = rateKey(message.messageIdNumber, message.text);
+    uint32_t limit = rateLimitFor(key);
+    idState& state = mIdStates[key];
+    auto now = std::chrono::steady_clock::now();
+
+    //Rate limits are counted over one second windows. Report how many repeats were hidden once a window closes
+    if (now - state.windowStart >= std::chrono::seconds(1))
+    {
+        if (state.suppressed > 0)
+            std::cerr << "validation layer: [0x" << std::hex << (uint32_t)key << std::dec << "] suppressed " << state.suppressed << " repeats\n";
+        state.windowStart = now;
+        state.printedInWindow = 0;
+        state.suppressed = 0;
+    }
+
+    if (state.printedInWindow >= limit)
+    {
+        state.suppressed++;
+        return;
+    }
+    state.printedInWindow++;
+
+    std::cerr << "validation layer: " << message.text << '\n';
+}
+
+uint32_t debugMessageSink::rateLimitFor(int32_t key)
+{
+    {
+        std::lock_guard<std::mutex> lock(mLimitMutex);
+        auto override = mRateLimits.find(key);
+        if (override != mRateLimits.end())
+            return override->second;
+    }
+    return mDefaultRateLimit.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+//Fixed size copy of a validation message. Copying into preallocated slots keeps the driver callback free of allocations and I/O
+struct debugMessage
+{
+    VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+    VkDebugUtilsMessageTypeFlagsEXT type;
+    int32_t messageIdNumber;
+    char text[1024];
+};
+
+//Asynchronous sink for validation layer messages
+//The driver callback only pushes into a bounded lock-free queue, a logger thread drains it, de-duplicates by message ID and writes to std::cerr
+class debugMessageSink
+{
+public:
+    debugMessageSink();
+    ~debugMessageSink();
+
+    void start();
+    void stop();
+
+    //Called from inside Vulkan calls on any thread. Returns false if the message was filtered or the queue was full
+    bool push(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData);
+
+    //Runtime configuration
+    void setSeverityFilter(VkDebugUtilsMessageSeverityFlagsEXT severityMask);       //Severities that are queued at all
+    void setRateLimit(uint32_t messagesPerSecond);                                  //Default limit applied to every message ID
+    void setRateLimit(int32_t messageIdNumber, uint32_t messagesPerSecond);         //Override for a single rateKey, 0 silences it completely
+
+    //Key that rate limits, overrides and suppression summaries use: the message ID, or for ID 0 (loader and general messages
+    //all share it) an FNV-1a hash of the text
+    static int32_t rateKey(int32_t messageIdNumber, const char* text);
+
+    uint64_t droppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    //Power of two so the ring index is a mask
+    static const size_t QUEUE_SIZE = 256;
+
+    struct slot
+    {
+        std::atomic<size_t> sequence;
+        debugMessage message;
+    };
+
+    //Per message ID bookkeeping, only touched by the logger thread
+    struct idState
+    {
+        std::chrono::steady_clock::time_point windowStart;
+        uint32_t printedInWindow = 0;
+        uint64_t suppressed = 0;
+    };
+
+    std::unique_ptr<slot[]> mSlots;
+    alignas(64) std::atomic<size_t> mEnqueuePos{ 0 };
+    alignas(64) size_t mDequeuePos = 0;
+
+    std::atomic<uint32_t> mSeverityMask;
+    std::atomic<uint32_t> mDefaultRateLimit;
+    std::atomic<uint64_t> mDropped{ 0 };
+
+    std::mutex mLimitMutex;
+    std::unordered_map<int32_t, uint32_t> mRateLimits;
+    std::unordered_map<int32_t, idState> mIdStates;
+
+    std::thread mLogger;
+    std::atomic<bool> mRunning{ false };
+
+    bool pop(debugMessage& message);
+    void drain();
+    void loggerLoop();
+    void write(const debugMessage& message);
+    uint32_t rateLimitFor(int32_t key);
+};
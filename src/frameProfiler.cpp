@@ -0,0 +1,80 @@
+#include "frameProfiler.h"
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <fstream>
+
+std::atomic<bool> frameProfiler::sEnabled{ FRAME_PROFILER != 0 };
+
+namespace
+{
+    //Single writer (the owning thread), read only while exporting
+    struct threadBuffer
+    {
+        uint32_t threadId;
+        std::atomic<uint64_t> head{ 0 };
+        std::unique_ptr<profileEvent[]> events{ new profileEvent[frameProfiler::RING_SIZE] };
+    };
+
+    //Buffers outlive their threads so short lived workers still show up in the export
+    std::mutex gRegistryMutex;
+    std::vector<std::unique_ptr<threadBuffer>> gBuffers;
+    thread_local threadBuffer* tBuffer = nullptr;
+
+    //Reference point used to convert timestamps to microseconds at export time
+    const uint64_t gClockStart = frameProfiler::now();
+    const std::chrono::steady_clock::time_point gWallStart = std::chrono::steady_clock::now();
+
+    threadBuffer* registerThread()
+    {
+        std::lock_guard<std::mutex> lock(gRegistryMutex);
+        gBuffers.emplace_back(new threadBuffer());
+        gBuffers.back()->threadId = static_cast<uint32_t>(gBuffers.size());
+        return gBuffers.back().get();
+    }
+}
+
+void frameProfiler::record(const char* name, uint64_t start, uint64_t end)
+{
+    if (tBuffer == nullptr)
+        tBuffer = registerThread();
+
+    uint64_t head = tBuffer->head.load(std::memory_order_relaxed);
+    tBuffer->events[head & (RING_SIZE - 1)] = { name, start, end };
+    tBuffer->head.store(head + 1, std::memory_order_release);
+}
+
+bool frameProfiler::exportChromeTrace(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+        return false;
+
+    //Work out how many timestamp ticks make up one microsecond
+    double elapsedMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gWallStart).count();
+    double ticksPerMicrosecond = elapsedMicroseconds > 0.0 ? (double)(now() - gClockStart) / elapsedMicroseconds : 1.0;
+
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    file << std::fixed;
+    file.precision(3);
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buffer : gBuffers)
+    {
+        //Only the most recent RING_SIZE events are still intact. Skip one extra slot that may be mid-write
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > RING_SIZE - 1 ? head - (RING_SIZE - 1) : 0;
+        for (uint64_t i = begin; i < head; i++)
+        {
+            const profileEvent& event = buffer->events[i & (RING_SIZE - 1)];
+            double ts = (double)(event.start - gClockStart) / ticksPerMicrosecond;
+            double duration = (double)(event.end - event.start) / ticksPerMicrosecond;
+            file << (first ? "" : ",\n")
+                 << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << ts << ",\"dur\":" << duration << "}";
+            first = false;
+        }
+    }
+    file << "\n]}\n";
+    return true;
+}
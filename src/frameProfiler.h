@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <chrono>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+//FRAME_PROFILER is set by CMake. When it is 0 every PROFILE_ZONE expands to nothing
+#ifndef FRAME_PROFILER
+    #define FRAME_PROFILER 0
+#endif
+
+//One completed zone. Names must be string literals since only the pointer is stored
+struct profileEvent
+{
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+class frameProfiler
+{
+public:
+    //Events per thread before the ring wraps and overwrites the oldest ones
+    static const uint32_t RING_SIZE = 1 << 16;
+
+    //Timestamps are raw TSC ticks on x86 and steady_clock nanoseconds elsewhere
+    static inline uint64_t now()
+    {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    static void setEnabled(bool enabled) { sEnabled.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+    //Append a finished zone to the calling thread's ring buffer
+    static void record(const char* name, uint64_t start, uint64_t end);
+
+    //Write every buffered event as Chrome Trace Event JSON (load in chrome://tracing or Perfetto)
+    static bool exportChromeTrace(const std::string& path);
+
+    //Records a zone from construction to destruction
+    class scopedZone
+    {
+    public:
+        explicit scopedZone(const char* name) : mName(name), mStart(isEnabled() ? now() : 0) {}
+        ~scopedZone()
+        {
+            if (mStart != 0)
+                record(mName, mStart, now());
+        }
+        scopedZone(const scopedZone&) = delete;
+        scopedZone& operator=(const scopedZone&) = delete;
+    private:
+        const char* mName;
+        uint64_t mStart;
+    };
+
+private:
+    static std::atomic<bool> sEnabled;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if FRAME_PROFILER
+    #define PROFILE_ZONE(name) frameProfiler::scopedZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+    #define PROFILE_ZONE(name) ((void)0)
+#endif
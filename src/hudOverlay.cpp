@@ -0,0 +1,509 @@
+#include "hudOverlay.h"
+#include "hudFont.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+//Atlas layout: 16 x 4 glyph cells of 6 x 8 pixels (one pixel of padding), then a solid white strip for untextured quads
+static const uint32_t ATLAS_COLUMNS = 16;
+static const uint32_t CELL_WIDTH = HUD_FONT_GLYPH_WIDTH + 1;
+static const uint32_t CELL_HEIGHT = HUD_FONT_GLYPH_HEIGHT + 1;
+static const uint32_t WHITE_STRIP_HEIGHT = 8;
+
+void hudSeries::push(float value)
+{
+    values[next] = value;
+    next = (next + 1) % LENGTH;
+}
+
+float hudSeries::latest() const
+{
+    return values[(next + LENGTH - 1) % LENGTH];
+}
+
+float hudSeries::maximum() const
+{
+    return *std::max_element(values, values + LENGTH);
+}
+
+void hudOverlay::init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue queue, VkRenderPass renderPass, VkExtent2D extent, const std::vector<char>& vertCode, const std::vector<char>& fragCode, memoryBudget& budget)
+{
+    mDevice = device;
+    mPhysicalDevice = physicalDevice;
+    mExtent = extent;
+    mBudget = &budget;
+
+    createAtlas(commandPool, queue);
+    createDescriptors();
+    createPipeline(renderPass, vertCode, fragCode);
+
+    //One host visible vertex buffer, mapped for the lifetime of the overlay. The frame fence guarantees the GPU is done with it before we rewrite it
+    createBuffer(sizeof(hudVertex) * MAX_VERTICES, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mVertexBuffer, mVertexMemory);
+    vkMapMemory(mDevice, mVertexMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&mVertices));
+}
+
+void hudOverlay::destroy()
+{
+    if (mDevice == VK_NULL_HANDLE)
+        return;
+
+    vkUnmapMemory(mDevice, mVertexMemory);
+    vkDestroyBuffer(mDevice, mVertexBuffer, nullptr);
+    freeMemory(mVertexMemory);
+
+    vkDestroyPipeline(mDevice, mPipeline, nullptr);
+    vkDestroyPipelineLayout(mDevice, mPipelineLayout, nullptr);
+    vkDestroyDescriptorPool(mDevice, mDescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(mDevice, mDescriptorSetLayout, nullptr);
+
+    vkDestroySampler(mDevice, mAtlasSampler, nullptr);
+    vkDestroyImageView(mDevice, mAtlasView, nullptr);
+    vkDestroyImage(mDevice, mAtlasImage, nullptr);
+    freeMemory(mAtlasMemory);
+    mDevice = VK_NULL_HANDLE;
+}
+
+void hudOverlay::beginFrame()
+{
+    mVertexCount = 0;
+}
+
+void hudOverlay::text(float x, float y, const std::string& str, uint32_t color)
+{
+    const float glyphWidth = (float)(HUD_FONT_GLYPH_WIDTH * GLYPH_SCALE);
+    const float glyphHeight = (float)(HUD_FONT_GLYPH_HEIGHT * GLYPH_SCALE);
+    const float advance = (float)(CELL_WIDTH * GLYPH_SCALE);
+
+    for (char c : str)
+    {
+        //Lowercase shares the uppercase glyphs, anything else outside the atlas becomes '?'
+        if (c >= 'a' && c <= 'z')
+            c = c - 'a' + 'A';
+        uint32_t index = (uint32_t)(uint8_t)c - HUD_FONT_FIRST_CHAR;
+        if (index >= HUD_FONT_GLYPH_COUNT)
+            index = '?' - HUD_FONT_FIRST_CHAR;
+
+        if (index != 0)
+        {
+            float u0 = (float)((index % ATLAS_COLUMNS) * CELL_WIDTH) / mAtlasWidth;
+            float v0 = (float)((index / ATLAS_COLUMNS) * CELL_HEIGHT) / mAtlasHeight;
+            float u1 = u0 + (float)HUD_FONT_GLYPH_WIDTH / mAtlasWidth;
+            float v1 = v0 + (float)HUD_FONT_GLYPH_HEIGHT / mAtlasHeight;
+            quad(x, y, x + glyphWidth, y + glyphHeight, u0, v0, u1, v1, color);
+        }
+        x += advance;
+    }
+}
+
+void hudOverlay::rect(float x, float y, float width, float height, uint32_t color)
+{
+    //Sample the middle of the white strip
+    float u = 2.0f / mAtlasWidth;
+    float v = (mAtlasHeight - WHITE_STRIP_HEIGHT / 2.0f) / mAtlasHeight;
+    quad(x, y, x + width, y + height, u, v, u, v, color);
+}
+
+void hudOverlay::graph(float x, float y, float width, float height, const hudSeries& series, float scaleMax, uint32_t color)
+{
+    rect(x, y, width, height, rgba(0, 0, 0, 128));
+    if (scaleMax <= 0.0f)
+        return;
+
+    //One bar per sample, oldest on the left
+    float barWidth = width / hudSeries::LENGTH;
+    for (uint32_t i = 0; i < hudSeries::LENGTH; i++)
+    {
+        float value = std::min(series.values[(series.next + i) % hudSeries::LENGTH] / scaleMax, 1.0f);
+        float barHeight = std::max(value * height, 1.0f);
+        rect(x + i * barWidth, y + height - barHeight, barWidth, barHeight, color);
+    }
+}
+
+void hudOverlay::record(VkCommandBuffer commandBuffer)
+{
+    if (mVertexCount == 0)
+        return;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1, &mDescriptorSet, 0, nullptr);
+
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mVertexBuffer, &offset);
+    vkCmdDraw(commandBuffer, mVertexCount, 1, 0, 0);
+}
+
+void hudOverlay::quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, uint32_t color)
+{
+    //Silently drop geometry past the end of the buffer rather than overrun it
+    if (mVertexCount + 6 > MAX_VERTICES)
+        return;
+
+    //Pixels to normalized device coordinates (Vulkan's y axis points down, like the screen)
+    float left = x0 / mExtent.width * 2.0f - 1.0f;
+    float right = x1 / mExtent.width * 2.0f - 1.0f;
+    float top = y0 / mExtent.height * 2.0f - 1.0f;
+    float bottom = y1 / mExtent.height * 2.0f - 1.0f;
+
+    hudVertex* v = mVertices + mVertexCount;
+    v[0] = { left, top, u0, v0, color };
+    v[1] = { right, top, u1, v0, color };
+    v[2] = { right, bottom, u1, v1, color };
+    v[3] = { left, top, u0, v0, color };
+    v[4] = { right, bottom, u1, v1, color };
+    v[5] = { left, bottom, u0, v1, color };
+    mVertexCount += 6;
+}
+
+uint32_t hudOverlay::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memoryProperties);
+
+    //typeFilter has one bit per memory type that the resource can live in
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+        if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+
+    throw std::runtime_error("Failed to find a suitable memory type for the HUD!");
+}
+
+void hudOverlay::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(mDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD buffer!");
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(mDevice, buffer, &memoryRequirements);
+    memory = allocateMemory(memoryRequirements, properties, "Failed to allocate HUD buffer memory!");
+    vkBindBufferMemory(mDevice, buffer, memory, 0);
+}
+
+VkDeviceMemory hudOverlay::allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, const char* error)
+{
+    VkMemoryAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = requirements.size;
+    allocateInfo.memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(mDevice, &allocateInfo, nullptr, &memory) != VK_SUCCESS)
+        throw std::runtime_error(error);
+
+    mBudget->trackAllocation(allocateInfo.memoryTypeIndex, allocateInfo.allocationSize);
+    mAllocations.push_back({ memory, allocateInfo.memoryTypeIndex, allocateInfo.allocationSize });
+    return memory;
+}
+
+void hudOverlay::freeMemory(VkDeviceMemory memory)
+{
+    for (size_t i = 0; i < mAllocations.size(); i++)
+    {
+        if (mAllocations[i].memory != memory)
+            continue;
+        mBudget->trackFree(mAllocations[i].memoryTypeIndex, mAllocations[i].size);
+        mAllocations.erase(mAllocations.begin() + i);
+        break;
+    }
+    vkFreeMemory(mDevice, memory, nullptr);
+}
+
+void hudOverlay::createAtlas(VkCommandPool commandPool, VkQueue queue)
+{
+    //Bake the font into a single channel bitmap
+    mAtlasWidth = ATLAS_COLUMNS * CELL_WIDTH;
+    mAtlasHeight = (HUD_FONT_GLYPH_COUNT / ATLAS_COLUMNS) * CELL_HEIGHT + WHITE_STRIP_HEIGHT;
+    std::vector<uint8_t> pixels(mAtlasWidth * mAtlasHeight, 0);
+    for (uint32_t glyph = 0; glyph < HUD_FONT_GLYPH_COUNT; glyph++)
+    {
+        uint32_t originX = (glyph % ATLAS_COLUMNS) * CELL_WIDTH;
+        uint32_t originY = (glyph / ATLAS_COLUMNS) * CELL_HEIGHT;
+        for (uint32_t row = 0; row < HUD_FONT_GLYPH_HEIGHT; row++)
+            for (uint32_t column = 0; column < HUD_FONT_GLYPH_WIDTH; column++)
+                if (HUD_FONT[glyph][row] & (1 << (HUD_FONT_GLYPH_WIDTH - 1 - column)))
+                    pixels[(originY + row) * mAtlasWidth + originX + column] = 255;
+    }
+    std::fill(pixels.end() - mAtlasWidth * WHITE_STRIP_HEIGHT, pixels.end(), 255);
+
+    //Copy the bitmap into a staging buffer
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    createBuffer(pixels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+    void* data;
+    vkMapMemory(mDevice, stagingMemory, 0, pixels.size(), 0, &data);
+    memcpy(data, pixels.data(), pixels.size());
+    vkUnmapMemory(mDevice, stagingMemory);
+
+    //Device local, optimally tiled image the shader samples from
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = { mAtlasWidth, mAtlasHeight, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = VK_FORMAT_R8_UNORM;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    if (vkCreateImage(mDevice, &imageInfo, nullptr, &mAtlasImage) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD glyph atlas!");
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(mDevice, mAtlasImage, &memoryRequirements);
+    mAtlasMemory = allocateMemory(memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "Failed to allocate HUD glyph atlas memory!");
+    vkBindImageMemory(mDevice, mAtlasImage, mAtlasMemory, 0);
+
+    //One time command buffer for the upload
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandPool = commandPool;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+    VkCommandBuffer commandBuffer;
+    vkAllocateCommandBuffers(mDevice, &commandBufferAllocateInfo, &commandBuffer);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    //Undefined -> transfer destination, copy, then transfer destination -> shader read
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = mAtlasImage;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { mAtlasWidth, mAtlasHeight, 1 };
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, mAtlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);     //Happens once at start up, so a full wait is fine
+
+    vkFreeCommandBuffers(mDevice, commandPool, 1, &commandBuffer);
+    vkDestroyBuffer(mDevice, stagingBuffer, nullptr);
+    freeMemory(stagingMemory);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = mAtlasImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8_UNORM;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    if (vkCreateImageView(mDevice, &viewInfo, nullptr, &mAtlasView) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD glyph atlas view!");
+
+    //Nearest filtering keeps the pixel font crisp at integer scales
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    if (vkCreateSampler(mDevice, &samplerInfo, nullptr, &mAtlasSampler) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD sampler!");
+}
+
+void hudOverlay::createDescriptors()
+{
+    //The atlas is the only resource the overlay shaders read
+    VkDescriptorSetLayoutBinding samplerBinding{};
+    samplerBinding.binding = 0;
+    samplerBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    samplerBinding.descriptorCount = 1;
+    samplerBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &samplerBinding;
+    if (vkCreateDescriptorSetLayout(mDevice, &layoutInfo, nullptr, &mDescriptorSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD descriptor set layout!");
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD descriptor pool!");
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = mDescriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &mDescriptorSetLayout;
+    if (vkAllocateDescriptorSets(mDevice, &allocateInfo, &mDescriptorSet) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate HUD descriptor set!");
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = mAtlasView;
+    imageInfo.sampler = mAtlasSampler;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = mDescriptorSet;
+    write.dstBinding = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.descriptorCount = 1;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(mDevice, 1, &write, 0, nullptr);
+}
+
+static VkShaderModule createHudShaderModule(VkDevice device, const std::vector<char>& code)
+{
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD shader module!");
+    return shaderModule;
+}
+
+void hudOverlay::createPipeline(VkRenderPass renderPass, const std::vector<char>& vertCode, const std::vector<char>& fragCode)
+{
+    VkShaderModule vertShaderModule = createHudShaderModule(mDevice, vertCode);
+    VkShaderModule fragShaderModule = createHudShaderModule(mDevice, fragCode);
+
+    VkPipelineShaderStageCreateInfo shaderStages[2]{};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = vertShaderModule;
+    shaderStages[0].pName = "main";
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = fragShaderModule;
+    shaderStages[1].pName = "main";
+
+    //Interleaved position, texture coordinate and packed color
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(hudVertex);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    VkVertexInputAttributeDescription attributeDescriptions[3]{};
+    attributeDescriptions[0] = { 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(hudVertex, x) };
+    attributeDescriptions[1] = { 1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(hudVertex, u) };
+    attributeDescriptions[2] = { 2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(hudVertex, color) };
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = 3;
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
+    inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportStateInfo{};
+    viewportStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportStateInfo.viewportCount = 1;
+    viewportStateInfo.scissorCount = 1;
+
+    //No culling, the overlay is flat and winding is irrelevant
+    VkPipelineRasterizationStateCreateInfo rasterizationInfo{};
+    rasterizationInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizationInfo.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizationInfo.lineWidth = 1.0f;
+    rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
+    rasterizationInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+    VkPipelineMultisampleStateCreateInfo multisamplingInfo{};
+    multisamplingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisamplingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    //Standard alpha blending over the scene
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlendingInfo{};
+    colorBlendingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlendingInfo.attachmentCount = 1;
+    colorBlendingInfo.pAttachments = &colorBlendAttachment;
+
+    std::vector<VkDynamicState> dynamicStates =
+    {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+    VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
+    dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicStateInfo.pDynamicStates = dynamicStates.data();
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &mDescriptorSetLayout;
+    if (vkCreatePipelineLayout(mDevice, &pipelineLayoutInfo, nullptr, &mPipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD pipeline layout!");
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssemblyInfo;
+    pipelineInfo.pViewportState = &viewportStateInfo;
+    pipelineInfo.pRasterizationState = &rasterizationInfo;
+    pipelineInfo.pMultisampleState = &multisamplingInfo;
+    pipelineInfo.pColorBlendState = &colorBlendingInfo;
+    pipelineInfo.pDynamicState = &dynamicStateInfo;
+    pipelineInfo.layout = mPipelineLayout;
+    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.subpass = 0;
+
+    if (vkCreateGraphicsPipelines(mDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &mPipeline) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD pipeline!");
+
+    vkDestroyShaderModule(mDevice, vertShaderModule, nullptr);
+    vkDestroyShaderModule(mDevice, fragShaderModule, nullptr);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include "memoryBudget.h"
+
+//Vertex layout of the overlay pipeline. Position is in normalized device coordinates
+struct hudVertex
+{
+    float x, y;
+    float u, v;
+    uint32_t color;     //RGBA8, red in the lowest byte
+};
+
+//Fixed length history used for the sparkline graphs
+struct hudSeries
+{
+    static const uint32_t LENGTH = 120;
+    float values[LENGTH] = {};
+    uint32_t next = 0;
+
+    void push(float value);
+    float latest() const;
+    float maximum() const;
+};
+
+//Text and sparkline overlay drawn inside the main render pass after the scene
+//Quads are rebuilt on the CPU every frame into one persistently mapped vertex buffer and drawn with a single draw call
+class hudOverlay
+{
+public:
+    static const uint32_t MAX_VERTICES = 6 * 4096;
+    static const uint32_t GLYPH_SCALE = 2;  //Screen pixels per font pixel
+
+    //Every device memory allocation of the overlay is reported to budget, which must outlive it
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue queue, VkRenderPass renderPass, VkExtent2D extent, const std::vector<char>& vertCode, const std::vector<char>& fragCode, memoryBudget& budget);
+    void destroy();
+
+    //Geometry calls between beginFrame and record are in screen pixels, origin top left
+    void beginFrame();
+    void text(float x, float y, const std::string& str, uint32_t color);
+    void rect(float x, float y, float width, float height, uint32_t color);
+    void graph(float x, float y, float width, float height, const hudSeries& series, float scaleMax, uint32_t color);
+    void record(VkCommandBuffer commandBuffer);
+
+    static float lineHeight() { return 9.0f * GLYPH_SCALE; }
+    static uint32_t rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) { return r | (g << 8) | (b << 16) | ((uint32_t)a << 24); }
+
+private:
+    //Memory type and size of each live allocation, for memoryBudget::trackFree
+    struct allocation
+    {
+        VkDeviceMemory memory;
+        uint32_t memoryTypeIndex;
+        VkDeviceSize size;
+    };
+
+    VkDevice mDevice = VK_NULL_HANDLE;
+    VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
+    VkExtent2D mExtent{};
+    memoryBudget* mBudget = nullptr;
+    std::vector<allocation> mAllocations;
+
+    VkImage mAtlasImage = VK_NULL_HANDLE;
+    VkDeviceMemory mAtlasMemory = VK_NULL_HANDLE;
+    VkImageView mAtlasView = VK_NULL_HANDLE;
+    VkSampler mAtlasSampler = VK_NULL_HANDLE;
+    uint32_t mAtlasWidth = 0;
+    uint32_t mAtlasHeight = 0;
+
+    VkDescriptorSetLayout mDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet mDescriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline mPipeline = VK_NULL_HANDLE;
+
+    VkBuffer mVertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mVertexMemory = VK_NULL_HANDLE;
+    hudVertex* mVertices = nullptr;     //Persistently mapped, host coherent
+    uint32_t mVertexCount = 0;
+
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+    VkDeviceMemory allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, const char* error);
+    void freeMemory(VkDeviceMemory memory);
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory);
+    void createAtlas(VkCommandPool commandPool, VkQueue queue);
+    void createDescriptors();
+    void createPipeline(VkRenderPass renderPass, const std::vector<char>& vertCode, const std::vector<char>& fragCode);
+    void quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, uint32_t color);
+};
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <iostream>
 #include <SDL.h>
 #include <SDL_vulkan.h>
@@ -5,14 +6,29 @@
 #include <vulkan/vulkan.h>
 
 #include "renderApp.h"
+#include "solverService.h"
 #include "vulkanDebugger.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #undef main
 
-int main()
+int main(int argc, char* argv[])
 {
+    //Headless batch solving, no window or Vulkan device is created
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0)
+    {
+        try
+        {
+            return runSolverService(argc - 2, argv + 2);
+        }
+        catch (const std::exception& error)
+        {
+            std::cerr << error.what() << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
     renderApp app;
     try 
     {
@@ -0,0 +1,101 @@
+#include "memoryBudget.h"
+#include <cstring>
+
+bool memoryBudget::isSupported(VkPhysicalDevice device)
+{
+    //The budget struct is chained into vkGetPhysicalDeviceMemoryProperties2, which is core from Vulkan 1.1
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_1)
+        return false;
+
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+
+    for (const auto& extension : extensions)
+        if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+            return true;
+    return false;
+}
+
+void memoryBudget::init(VkPhysicalDevice device, bool budgetExtensionEnabled)
+{
+    mPhysicalDevice = device;
+    mBudgetExtension = budgetExtensionEnabled;
+    vkGetPhysicalDeviceMemoryProperties(device, &mMemoryProperties);
+
+    mHeaps.resize(mMemoryProperties.memoryHeapCount);
+    mTrackedUsage.assign(mMemoryProperties.memoryHeapCount, 0);
+    for (uint32_t i = 0; i < mMemoryProperties.memoryHeapCount; i++)
+    {
+        mHeaps[i].size = mMemoryProperties.memoryHeaps[i].size;
+        mHeaps[i].deviceLocal = (mMemoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    update();
+}
+
+void memoryBudget::update()
+{
+    if (mBudgetExtension)
+    {
+        //Chain the budget struct so the driver fills in live usage and budget per heap
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+        memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memoryProperties.pNext = &budgetProperties;
+        vkGetPhysicalDeviceMemoryProperties2(mPhysicalDevice, &memoryProperties);
+
+        for (size_t i = 0; i < mHeaps.size(); i++)
+        {
+            mHeaps[i].budget = budgetProperties.heapBudget[i];
+            mHeaps[i].usage = budgetProperties.heapUsage[i];
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < mHeaps.size(); i++)
+        {
+            mHeaps[i].budget = static_cast<VkDeviceSize>(mHeaps[i].size * FALLBACK_BUDGET_SHARE);
+            mHeaps[i].usage = mTrackedUsage[i];
+        }
+    }
+}
+
+uint32_t memoryBudget::heapIndexForType(uint32_t memoryTypeIndex) const
+{
+    return mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+}
+
+void memoryBudget::trackAllocation(uint32_t memoryTypeIndex, VkDeviceSize size)
+{
+    mTrackedUsage[heapIndexForType(memoryTypeIndex)] += size;
+}
+
+void memoryBudget::trackFree(uint32_t memoryTypeIndex, VkDeviceSize size)
+{
+    VkDeviceSize& usage = mTrackedUsage[heapIndexForType(memoryTypeIndex)];
+    usage = usage > size ? usage - size : 0;
+}
+
+VkDeviceSize memoryBudget::deviceLocalUsage() const
+{
+    VkDeviceSize total = 0;
+    for (const auto& heap : mHeaps)
+        if (heap.deviceLocal)
+            total += heap.usage;
+    return total;
+}
+
+VkDeviceSize memoryBudget::deviceLocalBudget() const
+{
+    VkDeviceSize total = 0;
+    for (const auto& heap : mHeaps)
+        if (heap.deviceLocal)
+            total += heap.budget;
+    return total;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+struct heapBudget
+{
+    VkDeviceSize size = 0;      //Total size of the heap
+    VkDeviceSize budget = 0;    //How much this process can use before the OS/driver starts evicting or failing allocations
+    VkDeviceSize usage = 0;     //How much this process currently uses
+    bool deviceLocal = false;
+};
+
+//Tracks per-heap memory use against the budget reported by VK_EXT_memory_budget
+//Without the extension the budget falls back to a fixed share of the heap and usage to what was reported through trackAllocation
+class memoryBudget
+{
+public:
+    //Share of a heap assumed to be available when the driver cannot tell us
+    static constexpr double FALLBACK_BUDGET_SHARE = 0.8;
+
+    static bool isSupported(VkPhysicalDevice device);
+
+    void init(VkPhysicalDevice device, bool budgetExtensionEnabled);
+    void update();  //Called once per frame
+
+    const std::vector<heapBudget>& heaps() const { return mHeaps; }
+    uint32_t heapIndexForType(uint32_t memoryTypeIndex) const;
+
+    //Every vkAllocateMemory and vkFreeMemory is reported here, which is all the usage there is without the extension
+    void trackAllocation(uint32_t memoryTypeIndex, VkDeviceSize size);
+    void trackFree(uint32_t memoryTypeIndex, VkDeviceSize size);
+
+    //Device local usage and budget summed over all device local heaps
+    VkDeviceSize deviceLocalUsage() const;
+    VkDeviceSize deviceLocalBudget() const;
+
+private:
+    VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
+    bool mBudgetExtension = false;
+    VkPhysicalDeviceMemoryProperties mMemoryProperties{};
+    std::vector<heapBudget> mHeaps;
+    std::vector<VkDeviceSize> mTrackedUsage;
+};
@@ -30,6 +30,10 @@ void renderApp::initVulkan()
     createCommandPool();
     createCommandBuffer();
     createSyncObjects();
+    createTimestampQueries();
+
+    //Overlay shares the main render pass and draws after the scene
+    mHud.init(mDevice, mPhysicalDevice, mCommandPool, mGraphicsQueue, mRenderPass, mSwapChainExtent, readFile("../../../../shaders/hudVert.spv"), readFile("../../../../shaders/hudFrag.spv"), mMemoryBudget);
 }
 
 void renderApp::loop()
@@ -40,21 +44,97 @@ void renderApp::loop()
     //Main loop
     while (running)
     {
-        while (SDL_PollEvent(&event))
-            if (event.type == SDL_QUIT)
-                running = false;
+        PROFILE_ZONE("frame");
+        {
+            PROFILE_ZONE("SDL_PollEvent");
+            while (SDL_PollEvent(&event))
+            {
+                if (event.type == SDL_QUIT)
+                    running = false;
+
+                //F9 dumps the recorded frame phases for chrome://tracing
+                if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F9 && FRAME_PROFILER)
+                {
+                    if (frameProfiler::exportChromeTrace("frame_trace.json"))
+                        std::cout << "Frame trace written to frame_trace.json\n";
+                }
+
+                if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE)
+                    startSolve();
+            }
+        }
+        updateSolve();
         drawFrame();
     }
     vkDeviceWaitIdle(mDevice);
 }
 
+void renderApp::startSolve()
+{
+    //Replacing the handle cancels the previous search
+    mSolve.reset();
+    std::mt19937 random((uint32_t)SDL_GetPerformanceCounter());
+    mScrambled = cubieCube::solved();
+    for (int i = 0; i < SCRAMBLE_LENGTH; i++)
+        mScrambled.move((int)(random() % MOVE_COUNT));
+    mPlayback = mScrambled;
+    mSolution.clear();
+    mSolutionStep = 0;
+
+    //Keep improving until the time limit instead of stopping at the usual 20 moves
+    solverOptions options;
+    options.targetLength = 0;
+    options.timeLimitSeconds = SOLVE_SECONDS;
+    if (defaultSolverEngine() == solverEngine::thistlethwaite)
+        mSolve = thistlethwaiteSolver::solveAnytime(mScrambled, options);
+    else
+        mSolve = twoPhaseSolver::solveAnytime(mScrambled, options);
+}
+
+void renderApp::updateSolve()
+{
+    PROFILE_ZONE("updateSolve");
+    if (!mSolve)
+        return;
+
+    //finished is read before polling: a solution published just before the search ends is then still picked up by this poll
+    bool searching = !mSolve->finished();
+    solverResult result;
+    bool published = mSolve->poll(result);
+    if (published)
+    {
+        mSolution = mOptimizer.optimize(result.moves);
+        mSolutionStep = 0;
+        mPlayback = mScrambled;
+        mNextStepTicks = SDL_GetTicks() + SOLUTION_STEP_MS;
+    }
+
+    if (mSolutionStep < mSolution.size() && SDL_GetTicks() >= mNextStepTicks)
+    {
+        mPlayback.move(mSolution[mSolutionStep++]);
+        mNextStepTicks = SDL_GetTicks() + SOLUTION_STEP_MS;
+    }
+
+    //The handle stays until playback is done so a late solution still restarts it
+    setSolverRate(searching ? (float)mSolve->nodesPerSecond() : -1.0f);
+    if (!searching && !published && mSolutionStep == mSolution.size())
+        mSolve.reset();
+}
+
 void renderApp::clean()
 {
+    mSolve.reset();
+
     //Destroy Semaphores and Fence
     vkDestroySemaphore(mDevice, mSwapchainSemaphore, nullptr);
     vkDestroySemaphore(mDevice, mRenderingSemaphore, nullptr);
     vkDestroyFence(mDevice, mInFlightFence, nullptr);
 
+    //Destroy the overlay and the GPU timer queries
+    mHud.destroy();
+    if (mTimestampPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(mDevice, mTimestampPool, nullptr);
+
     //Destroy the command pool
     vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
 
@@ -90,6 +170,9 @@ void renderApp::clean()
     
     //Destroy instance
     vkDestroyInstance(mInstance, nullptr);
+
+    //Flush any queued validation messages now that no more callbacks can fire
+    mDebugger.messageSink.stop();
     SDL_DestroyWindow(mWindow);
     SDL_Quit();
 }
@@ -107,7 +190,7 @@ void renderApp::createInstance()
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "Test Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_1;   //1.1 for vkGetPhysicalDeviceMemoryProperties2 (memory budget queries)
 
     //Fill struct with instance info (requried)
     VkInstanceCreateInfo createInfo{};
@@ -215,6 +298,17 @@ int renderApp::rateDeviceSuitability(VkPhysicalDevice device)
     //Maximum possible size of textures affects graphics quality
     score += deviceProperties.limits.maxImageDimension2D;
 
+    //More device local memory means more room for textures and capture buffers, 100 points per GiB
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+        if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            score += static_cast<int>(memoryProperties.memoryHeaps[i].size / (1024 * 1024 * 1024) * 100);
+
+    //Devices that report their memory budget let us back off before overcommitting
+    if (memoryBudget::isSupported(device))
+        score += 100;
+
     //Query the queue families of the device
     QueueFamilyIndices indices = findQueueFamilies(device);
 
@@ -295,8 +389,14 @@ void renderApp::createLogicalDevice()
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(mDeviceExtensions.size()); //These last two calls enable the swap chain extension
-    createInfo.ppEnabledExtensionNames = mDeviceExtensions.data();                      //
+
+    //Required extensions plus the memory budget extension when the device has it
+    std::vector<const char*> enabledExtensions = mDeviceExtensions;
+    mMemoryBudgetEnabled = memoryBudget::isSupported(mPhysicalDevice);
+    if (mMemoryBudgetEnabled)
+        enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size()); //These last two calls enable the swap chain extension
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();                      //
 
     //Check for debugging
     if (enableValidationLayers) 
@@ -315,6 +415,9 @@ void renderApp::createLogicalDevice()
     //Index is 0 because we are only creating 1 queue from this family
     vkGetDeviceQueue(mDevice, indices.graphicsFamily.value(), 0, &mGraphicsQueue);
     vkGetDeviceQueue(mDevice, indices.presentFamily.value(), 0, &mPresentQueue);
+
+    //Start tracking heap usage against the budget
+    mMemoryBudget.init(mPhysicalDevice, mMemoryBudgetEnabled);
 }
 
 void renderApp::createSurface()
@@ -805,6 +908,13 @@ void renderApp::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imag
     if (vkBeginCommandBuffer(mCommandBuffer, &commandBufferBeginInfo) != VK_SUCCESS)    //If the command buffer was recorded already, then a new call to vkBeginCommandBuffer resets it. It does NOT append commands to a buffer.
         throw std::runtime_error("Failed to begin recording command buffers!");
 
+    //Bracket the frame's GPU work with timestamps for the overlay
+    if (mTimestampPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(mCommandBuffer, mTimestampPool, 0, 2);
+        vkCmdWriteTimestamp(mCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mTimestampPool, 0);
+    }
+
     VkRenderPassBeginInfo renderPassBeginInfo{};
     renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassBeginInfo.renderPass = mRenderPass;                           //The render pass
@@ -844,9 +954,21 @@ void renderApp::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imag
     //Issue the draw command (commandBuffer, vertices, instances, first vertex, first instance)
     vkCmdDraw(mCommandBuffer, 3, 1, 0, 0);
 
+    //Draw the overlay on top of the scene in the same render pass
+    {
+        PROFILE_ZONE("hudRecord");
+        mHud.record(mCommandBuffer);
+    }
+
     //End the render pass
     vkCmdEndRenderPass(mCommandBuffer);
 
+    if (mTimestampPool != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(mCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mTimestampPool, 1);
+        mTimestampsWritten = true;
+    }
+
     if (vkEndCommandBuffer(mCommandBuffer) != VK_SUCCESS)
         throw std::runtime_error("Failed to record command buffer!");
 }
@@ -854,16 +976,33 @@ void renderApp::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imag
 void renderApp::drawFrame()
 {
     //Wait for host to signal all fences, then reset the fence to an unsignaled state
-    vkWaitForFences(mDevice, 1, &mInFlightFence, VK_TRUE, UINT64_MAX);
-    vkResetFences(mDevice, 1, &mInFlightFence);
+    {
+        PROFILE_ZONE("vkWaitForFences");
+        vkWaitForFences(mDevice, 1, &mInFlightFence, VK_TRUE, UINT64_MAX);
+        vkResetFences(mDevice, 1, &mInFlightFence);
+    }
+
+    //The previous frame has finished, so its timestamps and the overlay vertex buffer are free to use
+    {
+        PROFILE_ZONE("updateStatsDisplay");
+        readGpuTime();
+        mMemoryBudget.update();
+        updateStatsDisplay();
+    }
 
     //Acquire image from the swapchain
     uint32_t imageIndex;
-    vkAcquireNextImageKHR(mDevice, mSwapChain, UINT64_MAX, mSwapchainSemaphore, VK_NULL_HANDLE, &imageIndex);    //When image is fetched, signal the swapchain semaphore
+    {
+        PROFILE_ZONE("vkAcquireNextImageKHR");
+        vkAcquireNextImageKHR(mDevice, mSwapChain, UINT64_MAX, mSwapchainSemaphore, VK_NULL_HANDLE, &imageIndex);    //When image is fetched, signal the swapchain semaphore
+    }
 
     //Reset the command buffer to allow for recording, then record the command buffer
-    vkResetCommandBuffer(mCommandBuffer, 0);
-    recordCommandBuffer(mCommandBuffer, imageIndex);
+    {
+        PROFILE_ZONE("recordCommandBuffer");
+        vkResetCommandBuffer(mCommandBuffer, 0);
+        recordCommandBuffer(mCommandBuffer, imageIndex);
+    }
 
     //Prepare to submit the command buffer
     VkSubmitInfo commandBufferSubmitInfo{};
@@ -881,8 +1020,11 @@ void renderApp::drawFrame()
     commandBufferSubmitInfo.pSignalSemaphores = signalSemaphores; //Specify which semaphore to signal once the command buffer finishes executing
 
     //Submit the command buffer to the graphcis queue, specifying the fence to signal in order to tell if the command buffer can be reused
-    if (vkQueueSubmit(mGraphicsQueue, 1, &commandBufferSubmitInfo, mInFlightFence) != VK_SUCCESS)
-        throw std::runtime_error("Failed to submit draw command buffer!");
+    {
+        PROFILE_ZONE("vkQueueSubmit");
+        if (vkQueueSubmit(mGraphicsQueue, 1, &commandBufferSubmitInfo, mInFlightFence) != VK_SUCCESS)
+            throw std::runtime_error("Failed to submit draw command buffer!");
+    }
 
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -895,6 +1037,7 @@ void renderApp::drawFrame()
     presentInfo.pImageIndices = &imageIndex;
     presentInfo.pResults = nullptr; //Optional: allows for speficication of an array of VK_RESULT values to check if each swapchain presentation was successful or not. More useful when using more than one swapchain
 
+    PROFILE_ZONE("vkQueuePresentKHR");
     vkQueuePresentKHR(mPresentQueue, &presentInfo); //Submit request to present image to swap chain
 }
 
@@ -913,6 +1056,130 @@ void renderApp::createSyncObjects()
         throw std::runtime_error("Failed to create synchronization objects!");
 }
 
+void renderApp::createTimestampQueries()
+{
+    //Timestamps need support on the graphics queue, otherwise the overlay just leaves GPU time out
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(mPhysicalDevice, &deviceProperties);
+    if (!deviceProperties.limits.timestampComputeAndGraphics)
+        return;
+    mTimestampPeriod = deviceProperties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2;   //Start and end of the frame
+
+    if (vkCreateQueryPool(mDevice, &queryPoolInfo, nullptr, &mTimestampPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create timestamp query pool!");
+}
+
+void renderApp::readGpuTime()
+{
+    if (mTimestampPool == VK_NULL_HANDLE || !mTimestampsWritten)
+        return;
+
+    //The in flight fence was already waited on, so the results are available without stalling
+    uint64_t timestamps[2];
+    if (vkGetQueryPoolResults(mDevice, mTimestampPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+        mGpuTimes.push((float)((timestamps[1] - timestamps[0]) * mTimestampPeriod / 1e6));
+}
+
+void renderApp::updateStatsDisplay()
+{
+    //CPU frame time is measured between consecutive calls
+    uint64_t counter = SDL_GetPerformanceCounter();
+    if (mLastFrameCounter != 0)
+        mFrameTimes.push((float)((counter - mLastFrameCounter) * 1000.0 / SDL_GetPerformanceFrequency()));
+    mLastFrameCounter = counter;
+
+    auto format = [](const char* label, float value, const char* unit)
+    {
+        char line[64];
+        snprintf(line, sizeof(line), "%-8s %8.2f %s", label, value, unit);
+        return std::string(line);
+    };
+
+    const uint32_t white = hudOverlay::rgba(255, 255, 255);
+    const uint32_t green = hudOverlay::rgba(80, 220, 120, 200);
+    const uint32_t orange = hudOverlay::rgba(255, 170, 60, 200);
+    const float x = 12.0f;
+    const float graphX = 260.0f;
+    const float graphWidth = 240.0f;
+    const float line = hudOverlay::lineHeight();
+    float y = 12.0f;
+
+    mHud.beginFrame();
+    mHud.rect(x - 6.0f, y - 6.0f, graphX + graphWidth + 6.0f, line * 7.0f + 12.0f, hudOverlay::rgba(0, 0, 0, 140));
+
+    //Frame and GPU times with their sparklines scaled to the slower of the two
+    float scale = std::max({ mFrameTimes.maximum(), mGpuTimes.maximum(), 16.7f });
+    mHud.text(x, y, format("FRAME", mFrameTimes.latest(), "MS"), white);
+    mHud.graph(graphX, y - 2.0f, graphWidth, line - 2.0f, mFrameTimes, scale, green);
+    y += line;
+    if (mTimestampPool != VK_NULL_HANDLE)
+        mHud.text(x, y, format("GPU", mGpuTimes.latest(), "MS"), white);
+    else
+        mHud.text(x, y, "GPU      N/A", white);
+    mHud.graph(graphX, y - 2.0f, graphWidth, line - 2.0f, mGpuTimes, scale, orange);
+    y += line;
+
+    if (mSolverNodesPerSecond >= 0.0f)
+        mHud.text(x, y, format("SOLVER", mSolverNodesPerSecond / 1e6f, "MNODE/S"), white);
+    else
+        mHud.text(x, y, "SOLVER   IDLE", white);
+    y += line;
+
+    if (mCameraFps >= 0.0f)
+        mHud.text(x, y, format("CAMERA", mCameraFps, "FPS"), white);
+    else
+        mHud.text(x, y, "CAMERA   OFF", white);
+    y += line;
+
+    //Best solution so far, how far playback got and the move shown next
+    if (!mSolution.empty())
+    {
+        std::string solution = "SOLUTION " + std::to_string(mSolution.size()) + " MOVES " + std::to_string(mSolutionStep) + "/" + std::to_string(mSolution.size());
+        if (mSolutionStep < mSolution.size())
+            solution += "  " + moveName(mSolution[mSolutionStep]);
+        mHud.text(x, y, solution, white);
+    }
+    else
+        mHud.text(x, y, mSolve ? "SOLUTION SEARCHING" : "SOLUTION SPACE TO SCRAMBLE", white);
+    y += line;
+
+    //Device local memory against the budget reported by the driver
+    const VkDeviceSize MB = 1024 * 1024;
+    std::string memory = "VRAM     " + std::to_string(mMemoryBudget.deviceLocalUsage() / MB) + " / " + std::to_string(mMemoryBudget.deviceLocalBudget() / MB) + " MB";
+    if (!mMemoryBudgetEnabled)
+        memory += " (EST)";
+    mHud.text(x, y, memory, white);
+
+    //The scrambled cube as the solution plays back, below the stats
+    drawCubeNet(x, 12.0f + line * 7.0f + 12.0f, mPlayback);
+}
+
+void renderApp::drawCubeNet(float x, float y, const cubieCube& cube)
+{
+    //Faces in facelet order URFDLB, placed as the usual cross shaped net: U above F, L F R B in a row, D below F
+    static const float FACE_COLUMN[6] = { 1, 2, 1, 1, 0, 3 };
+    static const float FACE_ROW[6] = { 0, 1, 1, 2, 1, 1 };
+    static const uint32_t FACE_COLOR[6] = { hudOverlay::rgba(245, 245, 245), hudOverlay::rgba(200, 30, 40), hudOverlay::rgba(30, 160, 70),
+                                            hudOverlay::rgba(250, 210, 30), hudOverlay::rgba(250, 120, 20), hudOverlay::rgba(30, 70, 200) };
+    static const std::string FACES = "URFDLB";
+    const float face = CUBE_NET_STICKER * 3.0f + 2.0f;
+    const std::string facelets = cube.toFacelets();
+
+    mHud.rect(x - 6.0f, y - 6.0f, face * 4.0f + 12.0f, face * 3.0f + 12.0f, hudOverlay::rgba(0, 0, 0, 140));
+    for (int i = 0; i < 54; i++)
+    {
+        int f = i / 9;
+        float stickerX = x + FACE_COLUMN[f] * face + (i % 3) * CUBE_NET_STICKER;
+        float stickerY = y + FACE_ROW[f] * face + (i % 9 / 3) * CUBE_NET_STICKER;
+        int color = (int)FACES.find(facelets[i]);
+        mHud.rect(stickerX, stickerY, CUBE_NET_STICKER - 1.0f, CUBE_NET_STICKER - 1.0f, FACE_COLOR[color]);
+    }
+}
 
 void renderApp::run()
 {
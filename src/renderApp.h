@@ -12,14 +12,27 @@
 #include <limits>
 #include <algorithm>
 #include <fstream>
+#include <memory>
+#include <random>
 
 #include "vulkanDebugger.h"
+#include "frameProfiler.h"
+#include "memoryBudget.h"
+#include "hudOverlay.h"
+#include "solver/solutionOptimizer.h"
+#include "solver/thistlethwaiteSolver.h"
+#include "solver/twoPhaseSolver.h"
 
 #define VK_USE_PLATFORM_WIN32_KHR
 
 const uint32_t SCREEN_WIDTH = 1080;
 const uint32_t SCREEN_HEIGHT = 720;
 
+const int SCRAMBLE_LENGTH = 25;
+const double SOLVE_SECONDS = 5.0;       //How long the anytime solve keeps looking for shorter solutions
+const uint32_t SOLUTION_STEP_MS = 400;  //Playback speed of the solution
+const float CUBE_NET_STICKER = 12.0f;   //Sticker pitch of the playback cube net in screen pixels
+
 struct QueueFamilyIndices
 {
     //std::optional contains no value until we assign one to it. This is useful in case a queue family is unavailable
@@ -69,6 +82,29 @@ private:
     VkSemaphore mSwapchainSemaphore;
     VkSemaphore mRenderingSemaphore;
     VkFence mInFlightFence;
+    memoryBudget mMemoryBudget;
+    bool mMemoryBudgetEnabled = false;
+
+    //Performance overlay and the stats it shows
+    hudOverlay mHud;
+    hudSeries mFrameTimes;
+    hudSeries mGpuTimes;
+    uint64_t mLastFrameCounter = 0;
+    VkQueryPool mTimestampPool = VK_NULL_HANDLE;
+    float mTimestampPeriod = 0.0f;      //Nanoseconds per timestamp tick, 0 if the graphics queue cannot write timestamps
+    bool mTimestampsWritten = false;
+    float mSolverNodesPerSecond = -1.0f;
+    float mCameraFps = -1.0f;
+
+    //Space scrambles the cube and starts an anytime solve. The best solution so far is played back a move at a time
+    //and playback restarts whenever a shorter one arrives. Solutions are cancelled down and reordered for hand execution first
+    std::unique_ptr<solveHandle> mSolve;
+    solutionOptimizer mOptimizer{ moveMetric::execution };
+    cubieCube mScrambled = cubieCube::solved();
+    cubieCube mPlayback = cubieCube::solved();
+    std::vector<uint8_t> mSolution;
+    size_t mSolutionStep = 0;
+    uint32_t mNextStepTicks = 0;
 
     const std::vector<const char*> mDeviceExtensions = 
     {
@@ -103,6 +139,16 @@ private:
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
     void drawFrame();
     void createSyncObjects();
+    void createTimestampQueries();
+    void readGpuTime();
+    void updateStatsDisplay();
+    void drawCubeNet(float x, float y, const cubieCube& cube);
+    void startSolve();
+    void updateSolve();
 public:
     void run();
+
+    //Feeds for the overlay from subsystems outside the renderer. Negative values show as idle
+    void setSolverRate(float nodesPerSecond) { mSolverNodesPerSecond = nodesPerSecond; }
+    void setCameraFps(float fps) { mCameraFps = fps; }
 };
\ No newline at end of file
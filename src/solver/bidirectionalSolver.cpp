@@ -0,0 +1,441 @@
+#include "bidirectionalSolver.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "coordinates.h"
+#include "tableFile.h"
+
+//How many nodes a worker expands between clock reads
+static const uint64_t TIME_CHECK_MASK = 0xFFF;
+
+//States at most d moves from solved in the half-turn metric (Rokicki's counts), what a table of depth d holds
+static const uint64_t STATES_WITHIN[MAX_FRONTIER_DEPTH + 1] = { 1, 19, 262, 3502, 46741, 621649, 8240087, 109043123, 1441386411 };
+static const double MAX_LOAD = 0.6;
+
+static inline int popcount(uint32_t bits)
+{
+#if defined(_MSC_VER)
+    return (int)__popcnt(bits);
+#else
+    return __builtin_popcount(bits);
+#endif
+}
+
+//splitmix64's finalizer, a bijection on 64 bits
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+int frontierTable::bucketBits(int depth)
+{
+    int bits = MIN_BUCKET_BITS;
+    while ((double)((uint64_t)BUCKET_SLOTS << bits) * MAX_LOAD < (double)STATES_WITHIN[depth])
+        bits++;
+    return bits;
+}
+
+const frontierTable& frontierTable::get(int depth)
+{
+    if (depth < 0 || depth > MAX_FRONTIER_DEPTH)
+        throw std::runtime_error("Frontier table depth is out of range!");
+
+    static std::mutex mutex;
+    static std::unique_ptr<frontierTable> tables[MAX_FRONTIER_DEPTH + 1];
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!tables[depth])
+        tables[depth].reset(new frontierTable(depth));
+    return *tables[depth];
+}
+
+int frontierTable::depthForBudget(size_t bytes)
+{
+    int depth = 0;
+    while (depth < MAX_FRONTIER_DEPTH && bytesForDepth(depth + 1) <= bytes)
+        depth++;
+    return depth;
+}
+
+size_t frontierTable::bytesForDepth(int depth)
+{
+    return ((size_t)1 << bucketBits(depth)) * BUCKET_SLOTS * sizeof(uint64_t);
+}
+
+frontierTable::frontierTable(int depth) : mMoves(moveTables::get()), mAutomaton(moveAutomaton::full()), mDepth(depth)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    mBucketBits = bucketBits(depth);
+    mBucketCount = (size_t)1 << mBucketBits;
+
+    //Zeroed, an empty slot is 0 and every entry stores distance + 1
+    size_t slotCount = mBucketCount * BUCKET_SLOTS;
+    mStorage.reset(new std::atomic<uint64_t>[slotCount + BUCKET_SLOTS]());
+    uintptr_t address = reinterpret_cast<uintptr_t>(mStorage.get());
+    mSlots = reinterpret_cast<std::atomic<uint64_t>*>((address + 63) & ~(uintptr_t)63);
+
+    int threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int d = 0; d <= depth; d++)
+        insertDepth(d, threadCount);
+    mStates = mInserted;
+    mBuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+frontierTable::stateKey frontierTable::key(const cubieCube& cube, int cornerPerm, int twist, int flip)
+{
+    //Rank of the edge permutation without its last two factorial digits: the last is always 0 and the one before makes the edge
+    //parity match the corners'
+    uint64_t edges = 0;
+    uint32_t used = 0;
+    for (int j = 0; j < EDGE_COUNT - 2; j++)
+    {
+        int piece = cube.edgePerm(j);
+        edges = edges * (EDGE_COUNT - j) + (piece - popcount(used & ((1u << piece) - 1)));
+        used |= 1u << piece;
+    }
+
+    uint64_t corners = (uint64_t)cornerPerm * TWIST_COUNT + twist;
+    uint64_t low = edges | (uint64_t)flip << 28 | (corners & ((1u << 25) - 1)) << 39;
+    uint64_t high = corners >> 25;
+    return { mix(low ^ high * 0x9E3779B97F4A7C15ull), high };
+}
+
+int frontierTable::distance(const stateKey& key) const
+{
+    size_t home = bucketOf(key);
+    for (int k = 0; k < MAX_DISPLACEMENT; k++)
+    {
+        const std::atomic<uint64_t>* bucket = mSlots + ((home + k) & (mBucketCount - 1)) * BUCKET_SLOTS;
+        uint64_t tag = tagOf(key, k);
+        for (int slot = 0; slot < BUCKET_SLOTS; slot++)
+        {
+            uint64_t entry = bucket[slot].load(std::memory_order_relaxed);
+            if (entry == 0)
+                return mDepth + 1;
+            if ((entry & ~(uint64_t)0xF) == tag)
+                return (int)(entry & 0xF) - 1;
+        }
+    }
+    return mDepth + 1;
+}
+
+//Slots fill in order and are never cleared, so two threads inserting one state race for the same first empty slot and the loser
+//sees the winner's entry there
+bool frontierTable::insert(const stateKey& key, int distance)
+{
+    size_t home = bucketOf(key);
+    for (int k = 0; k < MAX_DISPLACEMENT; k++)
+    {
+        std::atomic<uint64_t>* bucket = mSlots + ((home + k) & (mBucketCount - 1)) * BUCKET_SLOTS;
+        uint64_t tag = tagOf(key, k);
+        for (int slot = 0; slot < BUCKET_SLOTS; slot++)
+        {
+            uint64_t entry = bucket[slot].load(std::memory_order_relaxed);
+            if (entry == 0 && bucket[slot].compare_exchange_strong(entry, tag | (uint64_t)(distance + 1), std::memory_order_relaxed))
+                return true;
+            if ((entry & ~(uint64_t)0xF) == tag)
+                return false;
+        }
+    }
+    throw std::runtime_error("Frontier table is full!");
+}
+
+void frontierTable::insertDepth(int depth, int threadCount)
+{
+    if (depth == 0)
+    {
+        mInserted += insert(key(cubieCube::solved(), 0, 0, 0), 0) ? 1 : 0;
+        return;
+    }
+
+    //Sequences of depth moves reach every state depth moves away, the ones found at a smaller distance are in the table already.
+    //Split into the canonical sequences of up to two moves, one unit of work each
+    struct prefix
+    {
+        cubieCube cube;
+        int length;
+        uint16_t state;
+    };
+    std::vector<prefix> prefixes;
+    for (int first = 0; first < MOVE_COUNT; first++)
+    {
+        uint16_t state = mAutomaton.next(moveAutomaton::START, first);
+        if (depth == 1)
+        {
+            prefixes.push_back({ cubieCube::moveCube(first), 1, state });
+            continue;
+        }
+        for (int second = 0; second < MOVE_COUNT; second++)
+        {
+            if (mAutomaton.next(state, second) == moveAutomaton::FORBIDDEN)
+                continue;
+            prefix work = { cubieCube::moveCube(first), 2, mAutomaton.next(state, second) };
+            work.cube.move(second);
+            prefixes.push_back(work);
+        }
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]()
+    {
+        uint64_t inserted = 0;
+        for (size_t index = next++; index < prefixes.size(); index = next++)
+        {
+            const prefix& work = prefixes[index];
+            int cornerPerm = getCornerPerm(work.cube);
+            int twist = getTwist(work.cube);
+            int flip = getFlip(work.cube);
+            if (work.length == depth)
+                inserted += insert(key(work.cube, cornerPerm, twist, flip), depth) ? 1 : 0;
+            else
+                inserted += insertBelow(work.cube, cornerPerm, twist, flip, depth, depth - work.length, work.state);
+        }
+        mInserted += inserted;
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threadCount; i++)
+        workers.emplace_back(worker);
+    worker();
+    for (std::thread& thread : workers)
+        thread.join();
+}
+
+uint64_t frontierTable::insertBelow(const cubieCube& cube, int cornerPerm, int twist, int flip, int distance, int togo, uint16_t state)
+{
+    uint64_t inserted = 0;
+    for (int m = 0; m < MOVE_COUNT; m++)
+    {
+        uint16_t nextState = mAutomaton.next(state, m);
+        if (nextState == moveAutomaton::FORBIDDEN)
+            continue;
+        cubieCube child;
+        multiply(cube, cubieCube::moveCube(m), child);
+        int nextCornerPerm = mMoves.cornerPerm[cornerPerm][m];
+        int nextTwist = mMoves.twist[twist][m];
+        int nextFlip = mMoves.flip[flip][m];
+        if (togo == 1)
+            inserted += insert(key(child, nextCornerPerm, nextTwist, nextFlip), distance) ? 1 : 0;
+        else
+            inserted += insertBelow(child, nextCornerPerm, nextTwist, nextFlip, distance, togo - 1, nextState);
+    }
+    return inserted;
+}
+
+std::vector<uint8_t> frontierTable::pathToSolved(const cubieCube& cube) const
+{
+    std::vector<uint8_t> moves;
+    cubieCube current = cube;
+    int cornerPerm = getCornerPerm(cube);
+    int twist = getTwist(cube);
+    int flip = getFlip(cube);
+    int togo = distance(key(current, cornerPerm, twist, flip));
+    if (togo > mDepth)
+        return moves;
+
+    //Some move always leads one closer, the table holds every state on the way
+    while (togo > 0)
+    {
+        for (int m = 0; m < MOVE_COUNT; m++)
+        {
+            cubieCube next;
+            multiply(current, cubieCube::moveCube(m), next);
+            int nextCornerPerm = mMoves.cornerPerm[cornerPerm][m];
+            int nextTwist = mMoves.twist[twist][m];
+            int nextFlip = mMoves.flip[flip][m];
+            if (distance(key(next, nextCornerPerm, nextTwist, nextFlip)) != togo - 1)
+                continue;
+            moves.push_back((uint8_t)m);
+            current = next;
+            cornerPerm = nextCornerPerm;
+            twist = nextTwist;
+            flip = nextFlip;
+            togo--;
+            break;
+        }
+    }
+    return moves;
+}
+
+bidirectionalSolver::bidirectionalSolver(const frontierTable& table) : mTable(table), mMoves(moveTables::get()), mAutomaton(moveAutomaton::full())
+{
+}
+
+solverResult bidirectionalSolver::solve(const cubieCube& cube, const bidirectionalOptions& options)
+{
+    if (cube.verify() != 0)
+        throw std::runtime_error("Cube state is not solvable!");
+    requireIntactTables();
+
+    auto startTime = std::chrono::steady_clock::now();
+    mStart = cube;
+    mResult = solverResult();
+    mNodes = 0;
+    mStop = false;
+    mHasDeadline = options.timeLimitSeconds > 0.0;
+    mDeadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeLimitSeconds));
+
+    int threadCount = options.threads > 0 ? options.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    int maxLength = std::min(options.maxLength, MAX_DEPTH);
+
+    //Within the table the backward half alone is the whole solution
+    int startDistance = mTable.distance(frontierTable::key(cube, getCornerPerm(cube), getTwist(cube), getFlip(cube)));
+    if (startDistance <= mTable.depth())
+    {
+        if (startDistance <= maxLength)
+        {
+            mResult.moves = mTable.pathToSolved(cube);
+            mResult.found = true;
+        }
+        mResult.nodes = 1;
+        mResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return mResult;
+    }
+
+    //The cube is further than the table reaches, so each length takes one more forward move
+    for (int forward = 1; forward + mTable.depth() <= maxLength && !mStop; forward++)
+    {
+        std::vector<prefix> prefixes;
+        int length = std::min(forward, PREFIX_LENGTH);
+        for (int first = 0; first < MOVE_COUNT; first++)
+        {
+            uint16_t state = mAutomaton.next(moveAutomaton::START, first);
+            if (length == 1)
+            {
+                prefixes.push_back({ { (uint8_t)first, 0 }, 1, state });
+                continue;
+            }
+            for (int second = 0; second < MOVE_COUNT; second++)
+                if (mAutomaton.next(state, second) != moveAutomaton::FORBIDDEN)
+                    prefixes.push_back({ { (uint8_t)first, (uint8_t)second }, 2, mAutomaton.next(state, second) });
+        }
+
+        mNextPrefix = 0;
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threadCount; i++)
+            workers.emplace_back(&bidirectionalSolver::runWorker, this, std::cref(prefixes), forward);
+        runWorker(prefixes, forward);
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    mResult.nodes = mNodes;
+    mResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return mResult;
+}
+
+void bidirectionalSolver::runWorker(const std::vector<prefix>& prefixes, int forward)
+{
+    uint8_t path[MAX_DEPTH];
+    uint64_t nodes = 0;
+    uint64_t hits[PRUNE_HIT_VALUES] = {};
+    while (!mStop)
+    {
+        size_t index = mNextPrefix++;
+        if (index >= prefixes.size())
+            break;
+
+        const prefix& work = prefixes[index];
+        cubieCube cube = mStart;
+        int cornerPerm = getCornerPerm(cube);
+        int twist = getTwist(cube);
+        int flip = getFlip(cube);
+        for (int i = 0; i < work.length; i++)
+        {
+            cube.move(work.moves[i]);
+            cornerPerm = mMoves.cornerPerm[cornerPerm][work.moves[i]];
+            twist = mMoves.twist[twist][work.moves[i]];
+            flip = mMoves.flip[flip][work.moves[i]];
+            path[i] = work.moves[i];
+        }
+        nodes += work.length;
+
+        if (work.length < forward)
+            search(cube, cornerPerm, twist, flip, work.length, forward - work.length, work.state, path, nodes, hits);
+        else
+        {
+            int distance = mTable.distance(frontierTable::key(cube, cornerPerm, twist, flip));
+            if (RUBIK_SOLVER_STATS)
+                hits[distance]++;
+            if (distance <= mTable.depth())
+                recordSolution(path, forward, cube);
+        }
+    }
+    mNodes += nodes;
+    if (RUBIK_SOLVER_STATS)
+    {
+        std::lock_guard<std::mutex> lock(mResultMutex);
+        for (int value = 0; value < PRUNE_HIT_VALUES; value++)
+            mResult.pruneHits[0][value] += hits[value];
+    }
+}
+
+bool bidirectionalSolver::search(const cubieCube& cube, int cornerPerm, int twist, int flip, int depth, int togo, uint16_t state,
+                                 uint8_t* path, uint64_t& nodes, uint64_t* hits)
+{
+    //The table cannot prune above the leaves, any hit there would be a shorter solution an earlier length already ruled out.
+    //The leaves are generated and prefetched together so their bucket reads overlap
+    cubieCube children[MOVE_COUNT];
+    frontierTable::stateKey keys[MOVE_COUNT];
+    uint8_t moves[MOVE_COUNT];
+    uint16_t states[MOVE_COUNT];
+    int count = 0;
+    for (int m = 0; m < MOVE_COUNT; m++)
+    {
+        uint16_t nextState = mAutomaton.next(state, m);
+        if (nextState == moveAutomaton::FORBIDDEN)
+            continue;
+        multiply(cube, cubieCube::moveCube(m), children[count]);
+        if (togo == 1)
+        {
+            keys[count] = frontierTable::key(children[count], mMoves.cornerPerm[cornerPerm][m], mMoves.twist[twist][m], mMoves.flip[flip][m]);
+            mTable.prefetch(keys[count]);
+        }
+        moves[count] = (uint8_t)m;
+        states[count++] = nextState;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int m = moves[i];
+        if ((++nodes & TIME_CHECK_MASK) == 0 && mHasDeadline && std::chrono::steady_clock::now() >= mDeadline)
+            mStop = true;
+        if (mStop)
+            return false;
+
+        path[depth] = (uint8_t)m;
+        if (togo == 1)
+        {
+            int distance = mTable.distance(keys[i]);
+            if (RUBIK_SOLVER_STATS)
+                hits[distance]++;
+            if (distance > mTable.depth())
+                continue;
+            recordSolution(path, depth + 1, children[i]);
+            return true;
+        }
+
+        if (search(children[i], mMoves.cornerPerm[cornerPerm][m], mMoves.twist[twist][m], mMoves.flip[flip][m], depth + 1, togo - 1,
+                   states[i], path, nodes, hits))
+            return true;
+    }
+    return false;
+}
+
+void bidirectionalSolver::recordSolution(const uint8_t* path, int length, const cubieCube& meet)
+{
+    std::lock_guard<std::mutex> lock(mResultMutex);
+    if (!mResult.found)
+    {
+        mResult.moves.assign(path, path + length);
+        std::vector<uint8_t> backward = mTable.pathToSolved(meet);
+        mResult.moves.insert(mResult.moves.end(), backward.begin(), backward.end());
+        mResult.found = true;
+    }
+    mStop = true;
+}
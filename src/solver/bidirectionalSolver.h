@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "moveAutomaton.h"
+#include "moveTables.h"
+#include "solverResult.h"
+
+const int MAX_FRONTIER_DEPTH = 8;                       //1.4 billion states, 32 GB
+const size_t DEFAULT_FRONTIER_BYTES = 128u << 20;       //Depth 6, about 8.2 million states
+const int FRONTIER_FORWARD_DEPTH = 5;                   //Longest forward search a dispatcher should ask for, about 430,000 leaves
+
+//Every state within depth moves of solved with its distance, the backward half of the bidirectional search
+//Open addressing over 64 byte buckets of eight 64-bit entries, so a lookup usually reads one cache line. A state is packed into
+//66 bits (corner permutation and twist, flip, and the edge permutation rank without its last digit, which the corner parity fixes)
+//and its low 64 bits go through an invertible mix. The top bits of the mix pick the home bucket, the rest is stored with the two
+//high state bits, how many buckets past home the entry landed (up to 7) and the distance, so keys are exact without storing them whole
+//Built breadth first from solved, one pass per distance, with worker threads inserting lock free through compare and swap
+class frontierTable
+{
+public:
+    //Built on first use per depth and kept, thread safe
+    static const frontierTable& get(int depth);
+
+    //Deepest table that fits in bytes, 0 if not even depth 1 does
+    static int depthForBudget(size_t bytes);
+    static size_t bytesForDepth(int depth);
+
+    int depth() const { return mDepth; }
+    size_t bytes() const { return mBucketCount * BUCKET_SLOTS * sizeof(uint64_t); }
+    uint64_t states() const { return mStates; }
+    double buildSeconds() const { return mBuildSeconds; }
+
+    struct stateKey
+    {
+        uint64_t mixed;     //Invertible mix of the low 64 bits
+        uint64_t high;      //The two high bits
+    };
+
+    //cornerPerm, twist and flip are the cube's coordinates, passed in so a search can follow them through the move tables
+    static stateKey key(const cubieCube& cube, int cornerPerm, int twist, int flip);
+
+    void prefetch(const stateKey& key) const { RUBIK_PREFETCH(mSlots + bucketOf(key) * BUCKET_SLOTS); }
+
+    //Distance to solved, depth() + 1 for every state further away
+    int distance(const stateKey& key) const;
+
+    //Moves from cube, distance moves or fewer away, to solved. Empty if the cube is not in the table
+    std::vector<uint8_t> pathToSolved(const cubieCube& cube) const;
+
+private:
+    static const int BUCKET_SLOTS = 8;
+    static const int MAX_DISPLACEMENT = 8;
+    static const int MIN_BUCKET_BITS = 9;   //Leaves the low 9 bits of each entry for the high state bits, displacement and distance
+
+    explicit frontierTable(int depth);
+    static int bucketBits(int depth);
+
+    void insertDepth(int depth, int threadCount);
+    uint64_t insertBelow(const cubieCube& cube, int cornerPerm, int twist, int flip, int distance, int togo, uint16_t state);
+    bool insert(const stateKey& key, int distance);     //False if the state is in the table already
+
+    size_t bucketOf(const stateKey& key) const { return (size_t)(key.mixed >> (64 - mBucketBits)); }
+    uint64_t tagOf(const stateKey& key, int displacement) const
+    {
+        return (key.mixed << mBucketBits >> mBucketBits << 9) | key.high << 7 | (uint64_t)displacement << 4;
+    }
+
+    const moveTables& mMoves;
+    const moveAutomaton& mAutomaton;
+    int mDepth;
+    int mBucketBits;
+    size_t mBucketCount;
+    std::unique_ptr<std::atomic<uint64_t>[]> mStorage;
+    std::atomic<uint64_t>* mSlots;     //mStorage aligned to 64 bytes
+    std::atomic<uint64_t> mInserted{0};
+    uint64_t mStates = 0;
+    double mBuildSeconds = 0.0;
+};
+
+struct bidirectionalOptions
+{
+    int maxLength = 20;             //Give up on longer solutions, found = false
+    int threads = 0;                //0 uses every hardware thread
+    double timeLimitSeconds = 0.0;  //0 means no limit, otherwise the search gives up without a solution
+};
+
+//Meet in the middle: iterative deepening forward from the cube until a leaf lands in the frontier table, so a solution of
+//length L costs the canonical sequences of length L - depth instead of an IDA* tree over the whole length. Returns a shortest
+//solution in the half-turn metric; anything within the table depth is a single lookup. Fast up to about depth +
+//FRONTIER_FORWARD_DEPTH moves, after which each move multiplies the work by about 13, so dispatchers call it for cubes another
+//engine already solved that short
+//Each iteration is split into two-move prefixes that worker threads take from a shared counter
+class bidirectionalSolver
+{
+public:
+    explicit bidirectionalSolver(const frontierTable& table);
+
+    //Throws if the cube is not a legal state
+    solverResult solve(const cubieCube& cube, const bidirectionalOptions& options = bidirectionalOptions());
+
+private:
+    static constexpr int MAX_DEPTH = 32;
+    static constexpr int PREFIX_LENGTH = 2;
+
+    struct prefix
+    {
+        uint8_t moves[PREFIX_LENGTH];
+        int length;
+        uint16_t state;     //Move automaton state after the prefix
+    };
+
+    void runWorker(const std::vector<prefix>& prefixes, int forward);
+    bool search(const cubieCube& cube, int cornerPerm, int twist, int flip, int depth, int togo, uint16_t state, uint8_t* path,
+                uint64_t& nodes, uint64_t* hits);
+    void recordSolution(const uint8_t* path, int length, const cubieCube& meet);
+
+    const frontierTable& mTable;
+    const moveTables& mMoves;
+    const moveAutomaton& mAutomaton;
+
+    cubieCube mStart;
+    std::chrono::steady_clock::time_point mDeadline;
+    bool mHasDeadline = false;
+
+    std::atomic<size_t> mNextPrefix{0};
+    std::atomic<bool> mStop{false};
+    std::atomic<uint64_t> mNodes{0};
+    std::mutex mResultMutex;
+    solverResult mResult;
+};
@@ -0,0 +1,434 @@
+#include "bigCube.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+static const char FACE_LETTERS[] = "URFDLB";
+
+//Outward normals in URFDLB order
+static const int FACE_NORMAL[6][3] = { { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, 1 }, { 0, -1, 0 }, { -1, 0, 0 }, { 0, 0, -1 } };
+
+//A facelet in space: its cubie's position and its normal. Positions are doubled and centered (2 x - (size - 1)) so they stay integers
+typedef std::array<int, 6> faceletPoint;
+
+static faceletPoint faceletPosition(int size, int facelet)
+{
+    int n = size - 1;
+    int face = facelet / (size * size);
+    int row = facelet / size % size;
+    int column = facelet % size;
+    int x = 0;
+    int y = 0;
+    int z = 0;
+    switch (face)
+    {
+    case FACE_U: x = column; y = n; z = row; break;
+    case FACE_R: x = n; y = n - row; z = n - column; break;
+    case FACE_F: x = column; y = n - row; z = n; break;
+    case FACE_D: x = column; y = 0; z = n - row; break;
+    case FACE_L: x = 0; y = n - row; z = column; break;
+    default: x = n - column; y = n - row; z = 0; break;
+    }
+    return { 2 * x - n, 2 * y - n, 2 * z - n, FACE_NORMAL[face][0], FACE_NORMAL[face][1], FACE_NORMAL[face][2] };
+}
+
+//Quarter turn clockwise seen from outside the face: v -> (n . v) n - n x v
+static void rotate(const int* normal, int* v)
+{
+    int cross[3] = { normal[1] * v[2] - normal[2] * v[1], normal[2] * v[0] - normal[0] * v[2], normal[0] * v[1] - normal[1] * v[0] };
+    int dot = normal[0] * v[0] + normal[1] * v[1] + normal[2] * v[2];
+    for (int i = 0; i < 3; i++)
+        v[i] = dot * normal[i] - cross[i];
+}
+
+static int extremeCoordinates(int size, const faceletPoint& point)
+{
+    int count = 0;
+    for (int i = 0; i < 3; i++)
+        count += point[i] == size - 1 || point[i] == 1 - size;
+    return count;
+}
+
+static bool sameCubie(const faceletPoint& a, const faceletPoint& b)
+{
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+bigCubeModel::bigCubeModel(int size) : mSize(size), mLayers((size + 1) / 2)
+{
+    const int facelets = faceletCount();
+    std::vector<faceletPoint> points(facelets);
+    std::map<faceletPoint, int> indexOf;
+    for (int f = 0; f < facelets; f++)
+    {
+        points[f] = faceletPosition(size, f);
+        indexOf[points[f]] = f;
+    }
+
+    //destination[m][f]: where move m carries the facelet at f
+    std::vector<std::vector<int>> destination(moveCount(), std::vector<int>(facelets));
+    for (int m = 0; m < moveCount(); m++)
+    {
+        for (int f = 0; f < facelets; f++)
+            destination[m][f] = f;
+        if (!isMove(m))
+            continue;
+
+        const int* normal = FACE_NORMAL[face(m)];
+        int layer = size - 1 - 2 * depth(m);
+        for (int f = 0; f < facelets; f++)
+        {
+            const faceletPoint& point = points[f];
+            if (point[0] * normal[0] + point[1] * normal[1] + point[2] * normal[2] != layer)
+                continue;
+            int position[3] = { point[0], point[1], point[2] };
+            int direction[3] = { point[3], point[4], point[5] };
+            for (int turn = 0; turn < power(m); turn++)
+            {
+                rotate(normal, position);
+                rotate(normal, direction);
+            }
+            destination[m][f] = indexOf.at({ position[0], position[1], position[2], direction[0], direction[1], direction[2] });
+        }
+    }
+
+    //Orbits are the closures of single facelets under all moves. A wing's other facelet closes to a second set, which is
+    //left out and tracked as partners
+    std::vector<int> orbitOf(facelets, -1);
+    std::vector<std::vector<int>> closures;
+    for (int start = 0; start < facelets; start++)
+    {
+        if (orbitOf[start] != -1)
+            continue;
+        std::vector<int> closure = { start };
+        orbitOf[start] = (int)closures.size();
+        for (size_t i = 0; i < closure.size(); i++)
+        {
+            for (int m = 0; m < moveCount(); m++)
+            {
+                int next = destination[m][closure[i]];
+                if (orbitOf[next] == -1)
+                {
+                    orbitOf[next] = orbitOf[start];
+                    closure.push_back(next);
+                }
+            }
+        }
+        for (int f : closure)
+        {
+            for (int other = 0; other < facelets; other++)
+            {
+                if (other != f && orbitOf[other] == -1 && sameCubie(points[f], points[other]))
+                    orbitOf[other] = -2;
+            }
+        }
+        closures.push_back(closure);
+    }
+
+    for (std::vector<int>& closure : closures)
+    {
+        std::sort(closure.begin(), closure.end());
+        cubeOrbit orbit = {};
+        orbit.slots = (int)closure.size();
+        if (orbit.slots != ORBIT_SLOTS && orbit.slots != 6)
+            throw std::runtime_error("Unexpected orbit size!");
+
+        int extremes = extremeCoordinates(size, points[closure[0]]);
+        bool middleEdge = size % 2 == 1 && (points[closure[0]][0] == 0 || points[closure[0]][1] == 0 || points[closure[0]][2] == 0);
+        if (extremes == 3)
+            orbit.kind = orbitKind::corners;
+        else if (extremes == 2)
+            orbit.kind = middleEdge ? orbitKind::midges : orbitKind::wings;
+        else
+            orbit.kind = orbit.slots == 6 ? orbitKind::middleCenters : orbitKind::centers;
+
+        for (int i = 0; i < orbit.slots; i++)
+        {
+            orbit.facelets[i] = (uint16_t)closure[i];
+            orbit.partners[i] = (uint16_t)closure[i];
+            if (orbit.kind != orbitKind::wings)
+                continue;
+            for (int other = 0; other < facelets; other++)
+            {
+                if (other != closure[i] && sameCubie(points[closure[i]], points[other]))
+                    orbit.partners[i] = (uint16_t)other;
+            }
+        }
+        mOrbits.push_back(orbit);
+    }
+    std::stable_sort(mOrbits.begin(), mOrbits.end(), [](const cubeOrbit& a, const cubeOrbit& b) { return a.kind < b.kind; });
+    if ((int)mOrbits.size() > BIG_CUBE_MAX_ORBITS)
+        throw std::runtime_error("Too many orbits!");
+
+    mTouchedCount.resize(moveCount());
+    mTouchedStorage.resize(moveCount());
+    mTouched.resize(moveCount());
+    mPermutationStorage.assign(moveCount(), std::vector<orbitPermutation>(mOrbits.size()));
+    mPermutations.assign(moveCount(), std::vector<const uint8_t*>(mOrbits.size()));
+    for (int m = 0; m < moveCount(); m++)
+    {
+        for (int k = 0; k < orbitCount(); k++)
+        {
+            const cubeOrbit& orbit = mOrbits[k];
+            uint8_t* slots = mPermutationStorage[m][k].slots;
+            for (int i = 0; i < ORBIT_STRIDE; i++)
+                slots[i] = (uint8_t)i;
+
+            bool moved = false;
+            for (int i = 0; i < orbit.slots; i++)
+            {
+                int to = destination[m][orbit.facelets[i]];
+                int slot = (int)(std::lower_bound(orbit.facelets, orbit.facelets + orbit.slots, to) - orbit.facelets);
+                slots[slot] = (uint8_t)i;
+                moved = moved || slot != i;
+            }
+            mPermutations[m][k] = slots;
+            if (moved)
+                mTouchedStorage[m].push_back((uint8_t)k);
+        }
+        mTouchedCount[m] = (uint8_t)mTouchedStorage[m].size();
+        mTouched[m] = mTouchedStorage[m].data();
+    }
+}
+
+const bigCubeModel& bigCubeModel::get(int size)
+{
+    if (size < BIG_CUBE_MIN_SIZE || size > BIG_CUBE_MAX_SIZE)
+        throw std::runtime_error("Cube size is out of range!");
+
+    static std::mutex mutex;
+    static std::unique_ptr<bigCubeModel> models[BIG_CUBE_MAX_SIZE + 1];
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!models[size])
+        models[size].reset(new bigCubeModel(size));
+    return *models[size];
+}
+
+bool bigCubeModel::isMove(int move) const
+{
+    if (move < 0 || move >= moveCount())
+        return false;
+    //The middle layer of an odd size is turned from U, R and F only
+    return 2 * depth(move) < mSize - 1 || (2 * depth(move) == mSize - 1 && face(move) < FACE_D);
+}
+
+int bigCubeModel::bigMove(int face, int depth, int power) const
+{
+    if (face < 0 || face >= 6 || depth < 0 || depth >= mLayers || power < 1 || power > 3)
+        return -1;
+    int move = (face * mLayers + depth) * 3 + power - 1;
+    return isMove(move) ? move : -1;
+}
+
+std::string bigCubeModel::moveName(int move) const
+{
+    static const char* suffixes[] = { "", "2", "'" };
+    std::string name = depth(move) > 0 ? std::to_string(depth(move) + 1) : "";
+    return name + FACE_LETTERS[face(move)] + suffixes[move % 3];
+}
+
+std::vector<uint8_t> bigCubeModel::parseMoves(const std::string& text) const
+{
+    std::vector<uint8_t> moves;
+    std::istringstream stream(text);
+    std::string token;
+    while (stream >> token)
+    {
+        size_t i = 0;
+        int layer = 1;
+        if (isdigit((unsigned char)token[0]))
+        {
+            layer = 0;
+            while (i < token.size() && isdigit((unsigned char)token[i]))
+                layer = layer * 10 + (token[i++] - '0');
+        }
+        int move = -1;
+        const char* letter = i < token.size() && token[i] != '\0' ? strchr(FACE_LETTERS, token[i]) : nullptr;
+        if (letter != nullptr)
+        {
+            std::string suffix = token.substr(i + 1);
+            int power = suffix.empty() ? 1 : suffix == "2" ? 2 : suffix == "'" ? 3 : 0;
+            move = bigMove((int)(letter - FACE_LETTERS), layer - 1, power);
+        }
+        if (move < 0)
+            throw std::runtime_error("Unknown move: " + token);
+        moves.push_back((uint8_t)move);
+    }
+    return moves;
+}
+
+std::string bigCubeModel::formatMoves(const std::vector<uint8_t>& moves) const
+{
+    std::string text;
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        if (i > 0)
+            text += ' ';
+        text += moveName(moves[i]);
+    }
+    return text;
+}
+
+bigCube::bigCube(int size) : mModel(&bigCubeModel::get(size))
+{
+    for (int k = 0; k < BIG_CUBE_MAX_ORBITS; k++)
+        for (int i = 0; i < ORBIT_STRIDE; i++)
+            mRows[k][i] = (uint8_t)i;
+}
+
+//One 32-byte row gather per touched orbit: slot i takes row[permutation[i]]
+static void gatherRowsScalar(uint8_t (*rows)[ORBIT_STRIDE], const bigCubeModel& model, int move)
+{
+    const uint8_t* touched = model.touched(move);
+    for (int t = 0; t < model.touchedCount(move); t++)
+    {
+        uint8_t* row = rows[touched[t]];
+        const uint8_t* permutation = model.permutation(move, touched[t]);
+        uint8_t result[ORBIT_STRIDE];
+        for (int i = 0; i < ORBIT_SLOTS; i++)
+            result[i] = row[permutation[i]];
+        memcpy(row, result, ORBIT_SLOTS);
+    }
+}
+
+#if RUBIK_X86
+//pshufb only reaches 16 bytes, so each half of the result is looked up in both halves of the row and the two merged
+RUBIK_TARGET_SSSE3 static void gatherRowsSsse3(uint8_t (*rows)[ORBIT_STRIDE], const bigCubeModel& model, int move)
+{
+    const __m128i lowBias = _mm_set1_epi8(0x70);
+    const __m128i highBias = _mm_set1_epi8(16);
+    const uint8_t* touched = model.touched(move);
+    for (int t = 0; t < model.touchedCount(move); t++)
+    {
+        uint8_t* row = rows[touched[t]];
+        const uint8_t* permutation = model.permutation(move, touched[t]);
+        __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(row));
+        __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(row + 16));
+        __m128i index[2] = { _mm_load_si128(reinterpret_cast<const __m128i*>(permutation)),
+                             _mm_load_si128(reinterpret_cast<const __m128i*>(permutation + 16)) };
+        for (int half = 0; half < 2; half++)
+        {
+            //Indices 0..15 come out of the low half (index + 0x70 keeps bit 7 clear), 16..31 out of the high one
+            __m128i fromLow = _mm_shuffle_epi8(low, _mm_add_epi8(index[half], lowBias));
+            __m128i fromHigh = _mm_shuffle_epi8(high, _mm_sub_epi8(index[half], highBias));
+            _mm_store_si128(reinterpret_cast<__m128i*>(row + 16 * half), _mm_or_si128(fromLow, fromHigh));
+        }
+    }
+}
+
+RUBIK_TARGET_AVX2 static void gatherRowsAvx2(uint8_t (*rows)[ORBIT_STRIDE], const bigCubeModel& model, int move)
+{
+    const __m256i lowBias = _mm256_set1_epi8(0x70);
+    const __m256i highBias = _mm256_set1_epi8(16);
+    const uint8_t* touched = model.touched(move);
+    for (int t = 0; t < model.touchedCount(move); t++)
+    {
+        uint8_t* row = rows[touched[t]];
+        __m256i index = _mm256_load_si256(reinterpret_cast<const __m256i*>(model.permutation(move, touched[t])));
+        __m256i low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(row)));
+        __m256i high = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(row + 16)));
+        __m256i fromLow = _mm256_shuffle_epi8(low, _mm256_add_epi8(index, lowBias));
+        __m256i fromHigh = _mm256_shuffle_epi8(high, _mm256_sub_epi8(index, highBias));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(row), _mm256_or_si256(fromLow, fromHigh));
+    }
+}
+#endif
+
+typedef void (*gatherRowsKernel)(uint8_t (*)[ORBIT_STRIDE], const bigCubeModel&, int);
+
+static gatherRowsKernel selectGatherRows()
+{
+#if RUBIK_X86
+    if (dispatchLevel() >= cpuLevel::avx2)
+        return gatherRowsAvx2;
+    if (dispatchLevel() >= cpuLevel::ssse3)
+        return gatherRowsSsse3;
+#endif
+    return gatherRowsScalar;
+}
+
+void bigCube::move(int m)
+{
+    static const gatherRowsKernel kernel = selectGatherRows();
+    kernel(mRows, *mModel, m);
+}
+
+void bigCube::apply(const std::vector<uint8_t>& moves)
+{
+    for (uint8_t m : moves)
+        move(m);
+}
+
+bool bigCube::isSolved() const
+{
+    const int faceSize = size() * size();
+    for (int k = 0; k < mModel->orbitCount(); k++)
+    {
+        const cubeOrbit& orbit = mModel->orbit(k);
+        for (int i = 0; i < orbit.slots; i++)
+        {
+            int home = mRows[k][i];
+            if (orbit.facelets[home] / faceSize != orbit.facelets[i] / faceSize)
+                return false;
+            if (orbit.kind == orbitKind::wings && orbit.partners[home] / faceSize != orbit.partners[i] / faceSize)
+                return false;
+        }
+    }
+    return true;
+}
+
+std::string bigCube::toFacelets() const
+{
+    const int faceSize = size() * size();
+    std::string facelets(6 * faceSize, '?');
+    for (int k = 0; k < mModel->orbitCount(); k++)
+    {
+        const cubeOrbit& orbit = mModel->orbit(k);
+        for (int i = 0; i < orbit.slots; i++)
+        {
+            int home = mRows[k][i];
+            facelets[orbit.facelets[i]] = FACE_LETTERS[orbit.facelets[home] / faceSize];
+            if (orbit.kind == orbitKind::wings)
+                facelets[orbit.partners[i]] = FACE_LETTERS[orbit.partners[home] / faceSize];
+        }
+    }
+    return facelets;
+}
+
+cubieCube bigCube::reduced() const
+{
+    const int n = size();
+    const int middle = n / 2;
+    std::string facelets = toFacelets();
+    std::string small(54, '?');
+    for (int face = 0; face < 6; face++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                bool edge = (row == 1) != (column == 1);
+                char& letter = small[face * 9 + row * 3 + column];
+                if ((row == 1 && column == 1) || (edge && n % 2 == 0))
+                    letter = FACE_LETTERS[face];
+                else
+                    letter = facelets[face * n * n + (row == 0 ? 0 : row == 1 ? middle : n - 1) * n + (column == 0 ? 0 : column == 1 ? middle : n - 1)];
+            }
+        }
+    }
+
+    cubieCube cube;
+    if (!cubieCube::fromFacelets(small, cube))
+        throw std::runtime_error("Corners or midges do not form a 3x3x3 state!");
+    return cube;
+}
+
+bool bigCube::operator==(const bigCube& other) const
+{
+    return mModel == other.mModel && memcmp(mRows, other.mRows, sizeof(mRows)) == 0;
+}
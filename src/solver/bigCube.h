@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cubieCube.h"
+
+//Cubes from 4x4x4 to 7x7x7
+const int BIG_CUBE_MIN_SIZE = 4;
+const int BIG_CUBE_MAX_SIZE = 7;
+const int BIG_CUBE_MAX_ORBITS = 11;     //7x7x7: corners, midges, 2 wing, 6 center and the middle center orbit
+const int ORBIT_SLOTS = 24;
+const int ORBIT_STRIDE = 32;            //Slots 24..31 are padding that always holds its own index
+
+//Pieces only ever move within their orbit, the set of facelets a move sequence can carry one facelet to
+//Corners and midges are tracked by all their facelets since they twist and flip in place. A wing never flips in its slot,
+//so its orbit holds one facelet per wing and the other one (partner) follows from it. Centers are tracked one facelet each
+//even though the four of a color are interchangeable, the solver compares colors
+enum class orbitKind : uint8_t
+{
+    corners,
+    midges,         //Middle edges of odd sizes
+    wings,
+    middleCenters,  //Fixed centers of odd sizes, only 6 slots
+    centers
+};
+
+struct cubeOrbit
+{
+    orbitKind kind;
+    int slots;
+    uint16_t facelets[ORBIT_SLOTS];     //Facelet of each slot, increasing
+    uint16_t partners[ORBIT_SLOTS];     //Wings: the other facelet of the slot's piece
+};
+
+//Geometry of one cube size: facelets, orbits and what each layer turn does to each orbit
+//Facelets follow the 3x3x3 order scaled up, face by face in URFDLB order, row by row as seen from outside, so facelet
+//f * size^2 + row * size + column shows face f's color when solved
+//Move m turns layer depth(m) (0 the outer face) of face(m) by power(m) quarter turns clockwise, m = (face * layers + depth) * 3 + power - 1
+//Only layers in the face's own half are moves (an inner layer of the other half is the opposite face's move); the middle
+//layer of odd sizes is a move of U, R and F. Outer turns keep the 3x3x3 numbering: move m < 18 of a cubieCube is bigMove(m / 3, 0, m % 3 + 1)
+class bigCubeModel
+{
+public:
+    //Built on first use for each size, thread safe. Throws if size is out of range
+    static const bigCubeModel& get(int size);
+
+    int size() const { return mSize; }
+    int faceletCount() const { return 6 * mSize * mSize; }
+    int layers() const { return mLayers; }
+    int moveCount() const { return 18 * mLayers; }
+    int orbitCount() const { return (int)mOrbits.size(); }
+    const cubeOrbit& orbit(int index) const { return mOrbits[index]; }
+
+    int face(int move) const { return move / 3 / mLayers; }
+    int depth(int move) const { return move / 3 % mLayers; }
+    int power(int move) const { return move % 3 + 1; }
+    bool isMove(int move) const;
+
+    //-1 if the layer is not a move of that face
+    int bigMove(int face, int depth, int power) const;
+    int inverse(int move) const { return move - move % 3 + 2 - move % 3; }
+
+    //Names count layers from the face: R, 2R, 3R (the third layer alone). Throws on anything else
+    std::string moveName(int move) const;
+    std::vector<uint8_t> parseMoves(const std::string& text) const;
+    std::string formatMoves(const std::vector<uint8_t>& moves) const;
+
+    //Orbits move m changes, and slot i of such an orbit takes the piece from slot permutation(m, k)[i]
+    int touchedCount(int move) const { return mTouchedCount[move]; }
+    const uint8_t* touched(int move) const { return mTouched[move]; }
+    const uint8_t* permutation(int move, int orbit) const { return mPermutations[move][orbit]; }
+
+private:
+    explicit bigCubeModel(int size);
+
+    int mSize;
+    int mLayers;    //Moves per face: the layers up to the middle
+    std::vector<cubeOrbit> mOrbits;
+    std::vector<uint8_t> mTouchedCount;
+    std::vector<std::vector<uint8_t>> mTouchedStorage;
+    std::vector<const uint8_t*> mTouched;
+
+    struct alignas(32) orbitPermutation { uint8_t slots[ORBIT_STRIDE]; };
+    std::vector<std::vector<orbitPermutation>> mPermutationStorage;
+    std::vector<std::vector<const uint8_t*>> mPermutations;
+};
+
+//Cube state as one row of ORBIT_STRIDE bytes per orbit, each slot holding the home slot of the piece now in it
+//Copying is a flat copy of at most 352 bytes, and a move gathers only the rows it touches
+class alignas(32) bigCube
+{
+public:
+    explicit bigCube(int size);
+
+    int size() const { return mModel->size(); }
+    const bigCubeModel& model() const { return *mModel; }
+
+    void move(int m);
+    void apply(const std::vector<uint8_t>& moves);
+
+    //Home slot of the piece in slot i of orbit, and its color (the face of that home) for center orbits
+    uint8_t piece(int orbit, int slot) const { return mRows[orbit][slot]; }
+    int color(int orbit, int slot) const { return mModel->orbit(orbit).facelets[mRows[orbit][slot]] / (size() * size()); }
+    uint8_t* row(int orbit) { return mRows[orbit]; }
+    const uint8_t* row(int orbit) const { return mRows[orbit]; }
+
+    //Every facelet shows its face's color. Center pieces of one color count as interchangeable
+    bool isSolved() const;
+
+    //size^2 letters per face in URFDLB order, as for the 3x3x3
+    std::string toFacelets() const;
+
+    //The corners and midges as a 3x3x3 whose centers are U R F D L B. Even sizes have no midges, their edges come out solved
+    cubieCube reduced() const;
+
+    bool operator==(const bigCube& other) const;
+    bool operator!=(const bigCube& other) const { return !(*this == other); }
+
+private:
+    alignas(32) uint8_t mRows[BIG_CUBE_MAX_ORBITS][ORBIT_STRIDE];
+    const bigCubeModel* mModel;
+};
@@ -0,0 +1,356 @@
+#include "bigCubeSolver.h"
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+static bool hasCycles(const cubeOrbit& orbit)
+{
+    return orbit.kind == orbitKind::wings || orbit.kind == orbitKind::centers;
+}
+
+bigCubeCycles::bigCubeCycles(int size) : mModel(bigCubeModel::get(size))
+{
+    const int tripleCount = ORBIT_SLOTS * ORBIT_SLOTS * ORBIT_SLOTS;
+    mCycles.resize(mModel.orbitCount());
+    for (int k = 0; k < mModel.orbitCount(); k++)
+        if (hasCycles(mModel.orbit(k)))
+            mCycles[k].assign(tripleCount, cycleEntry{ -1, 0, 0, 0 });
+
+    std::vector<int> moves;
+    for (int m = 0; m < mModel.moveCount(); m++)
+        if (mModel.isMove(m))
+            moves.push_back(m);
+
+    //Commutators [A, X Y X'] of single moves, kept when they are a 3-cycle of one orbit and the identity elsewhere
+    std::vector<std::deque<int>> queues(mModel.orbitCount());
+    for (int a : moves)
+    {
+        for (int x : moves)
+        {
+            for (int y : moves)
+            {
+                if (y / 3 == x / 3)
+                    continue;
+
+                std::vector<uint8_t> sequence =
+                {
+                    (uint8_t)a, (uint8_t)x, (uint8_t)y, (uint8_t)mModel.inverse(x),
+                    (uint8_t)mModel.inverse(a), (uint8_t)x, (uint8_t)mModel.inverse(y), (uint8_t)mModel.inverse(x)
+                };
+                bigCube cube(size);
+                cube.apply(sequence);
+
+                int changedOrbit = -1;
+                int changedSlots = 0;
+                int slot = 0;
+                bool oneOrbit = true;
+                for (int k = 0; k < mModel.orbitCount() && oneOrbit && changedSlots <= 3; k++)
+                {
+                    for (int i = 0; i < mModel.orbit(k).slots; i++)
+                    {
+                        if (cube.piece(k, i) == i)
+                            continue;
+                        oneOrbit &= changedOrbit < 0 || changedOrbit == k;
+                        changedOrbit = k;
+                        changedSlots++;
+                        slot = i;
+                    }
+                }
+                if (!oneOrbit || changedSlots != 3 || !hasCycles(mModel.orbit(changedOrbit)))
+                    continue;
+
+                //The piece from c is now in the changed slot, the one from b in c
+                int c = cube.piece(changedOrbit, slot);
+                int b = cube.piece(changedOrbit, c);
+                std::vector<cycleEntry>& entries = mCycles[changedOrbit];
+                if (entries[tripleIndex(c, slot, b)].length != 0)
+                    continue;
+
+                cycleEntry entry = { (int16_t)mCommutators.size(), 0, 0, (uint8_t)sequence.size() };
+                mCommutators.push_back(sequence);
+                const int rotations[3] = { tripleIndex(c, slot, b), tripleIndex(slot, b, c), tripleIndex(b, c, slot) };
+                for (int index : rotations)
+                {
+                    entries[index] = entry;
+                    queues[changedOrbit].push_back(index);
+                }
+            }
+        }
+    }
+
+    //Setup m, cycle (a, b, c), m undone cycles the slots m takes a, b and c from. Breadth first, so setups are shortest
+    for (int k = 0; k < mModel.orbitCount(); k++)
+    {
+        std::vector<cycleEntry>& entries = mCycles[k];
+        std::deque<int>& queue = queues[k];
+        while (!queue.empty())
+        {
+            int index = queue.front();
+            queue.pop_front();
+            int a = index / (ORBIT_SLOTS * ORBIT_SLOTS);
+            int b = index / ORBIT_SLOTS % ORBIT_SLOTS;
+            int c = index % ORBIT_SLOTS;
+            for (int m : moves)
+            {
+                const uint8_t* touched = mModel.touched(m);
+                bool touchesOrbit = false;
+                for (int t = 0; t < mModel.touchedCount(m); t++)
+                    touchesOrbit |= touched[t] == k;
+                if (!touchesOrbit)
+                    continue;
+
+                const uint8_t* perm = mModel.permutation(m, k);
+                int next = tripleIndex(perm[a], perm[b], perm[c]);
+                if (entries[next].length != 0 || entries[index].length + 2 > 255)
+                    continue;
+                entries[next] = cycleEntry{ -1, (uint16_t)index, (uint8_t)m, (uint8_t)(entries[index].length + 2) };
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+const bigCubeCycles& bigCubeCycles::get(int size)
+{
+    if (size < BIG_CUBE_MIN_SIZE || size > BIG_CUBE_MAX_SIZE)
+        throw std::runtime_error("Cube size is out of range!");
+
+    static std::mutex mutex;
+    static std::unique_ptr<bigCubeCycles> cycles[BIG_CUBE_MAX_SIZE + 1];
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!cycles[size])
+        cycles[size].reset(new bigCubeCycles(size));
+    return *cycles[size];
+}
+
+int bigCubeCycles::length(int orbit, int a, int b, int c) const
+{
+    if (mCycles[orbit].empty())
+        return 0;
+    return mCycles[orbit][tripleIndex(a, b, c)].length;
+}
+
+void bigCubeCycles::appendEntry(const std::vector<cycleEntry>& entries, int index, std::vector<uint8_t>& moves) const
+{
+    const cycleEntry& entry = entries[index];
+    if (entry.commutator >= 0)
+    {
+        const std::vector<uint8_t>& commutator = mCommutators[entry.commutator];
+        moves.insert(moves.end(), commutator.begin(), commutator.end());
+        return;
+    }
+    moves.push_back(entry.setup);
+    appendEntry(entries, entry.parent, moves);
+    moves.push_back((uint8_t)mModel.inverse(entry.setup));
+}
+
+void bigCubeCycles::append(int orbit, int a, int b, int c, std::vector<uint8_t>& moves) const
+{
+    if (length(orbit, a, b, c) == 0)
+        throw std::runtime_error("No 3-cycle for these slots!");
+    appendEntry(mCycles[orbit], tripleIndex(a, b, c), moves);
+}
+
+bigCubeSolver::bigCubeSolver(solverEngine engine) : mEngine(engine)
+{
+    if (engine == solverEngine::thistlethwaite)
+        mThistlethwaite.reset(new thistlethwaiteSolver());
+    else
+        mTwoPhase.reset(new twoPhaseSolver());
+}
+
+//A turn of the same layer as the last one merges with it, setups and commutators often meet that way
+static void appendMove(const bigCubeModel& model, std::vector<uint8_t>& moves, int move)
+{
+    if (!moves.empty() && moves.back() / 3 == move / 3)
+    {
+        int quarterTurns = (model.power(moves.back()) + model.power(move)) % 4;
+        moves.pop_back();
+        if (quarterTurns != 0)
+            moves.push_back((uint8_t)(move - move % 3 + quarterTurns - 1));
+        return;
+    }
+    moves.push_back((uint8_t)move);
+}
+
+static void play(bigCube& cube, std::vector<uint8_t>& moves, int move)
+{
+    cube.move(move);
+    appendMove(cube.model(), moves, move);
+}
+
+//A cycle of length n is n - 1 transpositions
+static bool isPermutationOdd(const uint8_t* perm, int slots)
+{
+    int cycles = 0;
+    bool seen[ORBIT_SLOTS] = {};
+    for (int i = 0; i < slots; i++)
+    {
+        if (seen[i])
+            continue;
+        cycles++;
+        for (int j = i; !seen[j]; j = perm[j])
+            seen[j] = true;
+    }
+    return (slots - cycles) % 2 == 1;
+}
+
+//The middle slices turn the middle centers like whole cube rotations, each of the 24 is at most three of them away
+static bool alignFrame(bigCube& cube, int orbit, int depth, std::vector<uint8_t>& moves)
+{
+    const uint8_t* row = cube.row(orbit);
+    bool aligned = true;
+    for (int i = 0; i < cube.model().orbit(orbit).slots; i++)
+        aligned &= row[i] == i;
+    if (aligned)
+        return true;
+    if (depth == 0)
+        return false;
+
+    const bigCubeModel& model = cube.model();
+    for (int face = 0; face < 3; face++)
+    {
+        if (!moves.empty() && model.face(moves.back()) == face)
+            continue;
+        for (int power = 1; power <= 3; power++)
+        {
+            int move = model.bigMove(face, model.layers() - 1, power);
+            bigCube next = cube;
+            next.move(move);
+            moves.push_back((uint8_t)move);
+            if (alignFrame(next, orbit, depth - 1, moves))
+            {
+                cube = next;
+                return true;
+            }
+            moves.pop_back();
+        }
+    }
+    return false;
+}
+
+//Slot i is right when its piece belongs there, for centers when the piece has the color of the slot's face. Each cycle
+//starts from the first wrong slot a, sends its piece to a wrong slot b where it is right and picks the third slot fixing
+//the most pieces, the shortest sequence among those. An even permutation (wings) never needs a cycle fixing nothing
+static void solveOrbit(bigCube& cube, int orbit, const bigCubeCycles& cycles, std::vector<uint8_t>& moves)
+{
+    const bigCubeModel& model = cube.model();
+    const cubeOrbit& slots = model.orbit(orbit);
+    const int area = model.size() * model.size();
+    int home[ORBIT_SLOTS];
+    for (int i = 0; i < slots.slots; i++)
+        home[i] = slots.kind == orbitKind::centers ? slots.facelets[i] / area : i;
+
+    std::vector<uint8_t> sequence;
+    for (;;)
+    {
+        const uint8_t* row = cube.row(orbit);
+        auto right = [&](int slot, int piece) { return home[slot] == home[piece]; };
+
+        int a = 0;
+        while (a < slots.slots && right(a, row[a]))
+            a++;
+        if (a == slots.slots)
+            return;
+
+        int bestB = -1, bestC = -1, bestGain = 0, bestLength = 0;
+        for (int b = 0; b < slots.slots; b++)
+        {
+            if (b == a || right(b, row[b]) || !right(b, row[a]))
+                continue;
+            for (int c = 0; c < slots.slots; c++)
+            {
+                if (c == a || c == b)
+                    continue;
+                int gain = 1 + right(c, row[b]) + right(a, row[c]) - right(c, row[c]);
+                int length = cycles.length(orbit, a, b, c);
+                if (length != 0 && (gain > bestGain || (gain == bestGain && length < bestLength)))
+                {
+                    bestB = b;
+                    bestC = c;
+                    bestGain = gain;
+                    bestLength = length;
+                }
+            }
+        }
+        if (bestGain <= 0)
+            throw std::runtime_error("Orbit cannot be solved with 3-cycles!");
+
+        sequence.clear();
+        cycles.append(orbit, a, bestB, bestC, sequence);
+        for (uint8_t move : sequence)
+            play(cube, moves, move);
+    }
+}
+
+solverResult bigCubeSolver::solve(const bigCube& start, const solverOptions& options)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    const bigCubeModel& model = start.model();
+    const bigCubeCycles& cycles = bigCubeCycles::get(model.size());
+    bigCube cube = start;
+    solverResult result;
+    std::vector<uint8_t>& moves = result.moves;
+
+    for (int k = 0; k < model.orbitCount(); k++)
+    {
+        if (model.orbit(k).kind != orbitKind::middleCenters)
+            continue;
+        std::vector<uint8_t> frame;
+        if (!alignFrame(cube, k, 3, frame))
+            throw std::runtime_error("Middle centers cannot be aligned!");
+        for (uint8_t move : frame)
+            appendMove(model, moves, move);
+    }
+
+    //A quarter turn of a wing orbit's inner slice is a 4-cycle of it and leaves the other wing orbits alone
+    for (int k = 0; k < model.orbitCount(); k++)
+    {
+        if (model.orbit(k).kind != orbitKind::wings || !isPermutationOdd(cube.row(k), ORBIT_SLOTS))
+            continue;
+        for (int m = 0; m < model.moveCount(); m++)
+        {
+            if (!model.isMove(m) || model.depth(m) == 0 || model.power(m) != 1)
+                continue;
+            const uint8_t* touched = model.touched(m);
+            bool turnsOrbit = false;
+            for (int t = 0; t < model.touchedCount(m); t++)
+                turnsOrbit |= touched[t] == k;
+            if (turnsOrbit && isPermutationOdd(model.permutation(m, k), ORBIT_SLOTS))
+            {
+                play(cube, moves, m);
+                break;
+            }
+        }
+    }
+
+    for (int k = 0; k < model.orbitCount(); k++)
+        if (model.orbit(k).kind == orbitKind::centers)
+            solveOrbit(cube, k, cycles, moves);
+
+    //Even sizes have no midges to carry the corners' permutation parity, an outer turn makes it even
+    cubieCube reduced = cube.reduced();
+    if (reduced.cornerParity() != reduced.edgeParity())
+    {
+        play(cube, moves, model.bigMove(FACE_U, 0, 1));
+        reduced = cube.reduced();
+    }
+    solverResult outer = mEngine == solverEngine::thistlethwaite ? mThistlethwaite->solve(reduced, options) : mTwoPhase->solve(reduced, options);
+    result.nodes = outer.nodes;
+    if (!outer.found)
+    {
+        result.moves.clear();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return result;
+    }
+    for (uint8_t move : outer.moves)
+        play(cube, moves, model.bigMove(move / 3, 0, move % 3 + 1));
+
+    for (int k = 0; k < model.orbitCount(); k++)
+        if (model.orbit(k).kind == orbitKind::wings)
+            solveOrbit(cube, k, cycles, moves);
+
+    result.found = true;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
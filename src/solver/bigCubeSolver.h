@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bigCube.h"
+#include "solverResult.h"
+#include "thistlethwaiteSolver.h"
+#include "twoPhaseSolver.h"
+
+//Every 3-cycle of the wing and center orbits of one size as a pure move sequence: a commutator [A, X Y X'] that cycles
+//three pieces of one orbit and nothing else, conjugated by the fewest setup moves. Under 1 MB per size
+class bigCubeCycles
+{
+public:
+    //Found by a search of up to 0.2 s (7x7x7) on first use for each size, thread safe
+    static const bigCubeCycles& get(int size);
+
+    //Moves of the cycle carrying the piece in slot a to b, b to c and c to a, 0 for orbits without 3-cycles
+    //(corners, midges and the middle centers)
+    int length(int orbit, int a, int b, int c) const;
+
+    //Appends the cycle's moves, which leave every other piece where it is
+    void append(int orbit, int a, int b, int c, std::vector<uint8_t>& moves) const;
+
+private:
+    explicit bigCubeCycles(int size);
+
+    //A cycle is either a commutator or setup, the cycle parent, then setup undone
+    struct cycleEntry
+    {
+        int16_t commutator;     //-1 for a conjugate
+        uint16_t parent;
+        uint8_t setup;
+        uint8_t length;         //0 if not found
+    };
+
+    static int tripleIndex(int a, int b, int c) { return (a * ORBIT_SLOTS + b) * ORBIT_SLOTS + c; }
+    void appendEntry(const std::vector<cycleEntry>& entries, int index, std::vector<uint8_t>& moves) const;
+
+    const bigCubeModel& mModel;
+    std::vector<std::vector<uint8_t>> mCommutators;
+    std::vector<std::vector<cycleEntry>> mCycles;   //Per orbit, indexed by ordered triple
+};
+
+//Reduction: the centers and wings are brought into 3x3x3 shape, the outer layers are solved by a 3x3x3 engine
+//  1. odd sizes turn the middle slices until the middle centers are home, which fixes the frame
+//  2. each wing orbit with an odd permutation gets a quarter turn of its inner slice, the parity a 3x3x3 cannot fix
+//  3. centers are solved color by color with pure 3-cycles
+//  4. corners and midges are solved as a 3x3x3 with outer turns, which keep every center on its face
+//  5. wings are solved with pure 3-cycles, the outer turns of step 4 only ever permute them evenly
+//Cycles are picked greedily (the most pieces fixed, then the shortest sequence), so solutions are long, about 180 moves
+//on a 4x4x4 to 600 on a 7x7x7, but everything besides the 3x3x3 search takes well under 0.1 ms
+class bigCubeSolver
+{
+public:
+    //The 3x3x3 engine's tables are loaded here
+    explicit bigCubeSolver(solverEngine engine = defaultSolverEngine());
+
+    //Moves of the cube's own size. The options go to the 3x3x3 engine, found is false only if it finds no solution
+    solverResult solve(const bigCube& cube, const solverOptions& options = solverOptions());
+
+private:
+    solverEngine mEngine;
+    std::unique_ptr<twoPhaseSolver> mTwoPhase;
+    std::unique_ptr<thistlethwaiteSolver> mThistlethwaite;
+};
@@ -0,0 +1,201 @@
+#include "coordinates.h"
+
+static const int FACTORIAL[13] = { 1, 1, 2, 6, 24, 120, 720, 5040, 40320, 362880, 3628800, 39916800, 479001600 };
+
+struct binomialTable
+{
+    int values[13][13] = {};
+
+    binomialTable()
+    {
+        for (int n = 0; n <= 12; n++)
+        {
+            values[n][0] = 1;
+            for (int k = 1; k <= n; k++)
+                values[n][k] = values[n - 1][k - 1] + (k < n ? values[n - 1][k] : 0);
+        }
+    }
+};
+
+int binomial(int n, int k)
+{
+    if (k < 0 || k > n)
+        return 0;
+    static const binomialTable table;
+    return table.values[n][k];
+}
+
+//Lehmer code: for every element, how many later elements are smaller, weighted by the factorial number system
+int permutationRank(const uint8_t* perm, int length)
+{
+    int rank = 0;
+    for (int i = 0; i < length - 1; i++)
+    {
+        int smaller = 0;
+        for (int j = i + 1; j < length; j++)
+            if (perm[j] < perm[i])
+                smaller++;
+        rank += smaller * FACTORIAL[length - 1 - i];
+    }
+    return rank;
+}
+
+void permutationUnrank(int rank, uint8_t* perm, int length)
+{
+    uint8_t remaining[12];
+    for (int i = 0; i < length; i++)
+        remaining[i] = (uint8_t)i;
+
+    int left = length;
+    for (int i = 0; i < length; i++)
+    {
+        int digit = rank / FACTORIAL[length - 1 - i];
+        rank %= FACTORIAL[length - 1 - i];
+        perm[i] = remaining[digit];
+        for (int j = digit; j < left - 1; j++)
+            remaining[j] = remaining[j + 1];
+        left--;
+    }
+}
+
+int getTwist(const cubieCube& cube)
+{
+    //The last corner's twist follows from the others
+    int twist = 0;
+    for (int i = URF; i < DRB; i++)
+        twist = 3 * twist + cube.cornerOri(i);
+    return twist;
+}
+
+void setTwist(cubieCube& cube, int twist)
+{
+    int sum = 0;
+    for (int i = DRB - 1; i >= URF; i--)
+    {
+        cube.setCorner(i, cube.cornerPerm(i), twist % 3);
+        sum += twist % 3;
+        twist /= 3;
+    }
+    cube.setCorner(DRB, cube.cornerPerm(DRB), (3 - sum % 3) % 3);
+}
+
+int getFlip(const cubieCube& cube)
+{
+    int flip = 0;
+    for (int i = UR; i < BR; i++)
+        flip = 2 * flip + cube.edgeOri(i);
+    return flip;
+}
+
+void setFlip(cubieCube& cube, int flip)
+{
+    int sum = 0;
+    for (int i = BR - 1; i >= UR; i--)
+    {
+        cube.setEdge(i, cube.edgePerm(i), flip & 1);
+        sum += flip & 1;
+        flip >>= 1;
+    }
+    cube.setEdge(BR, cube.edgePerm(BR), sum & 1);
+}
+
+//Slice positions use the combinatorial number system: scanning from BR down to UR, the x-th slice edge found at slot j adds C(11 - j, x + 1)
+int getSlice(const cubieCube& cube)
+{
+    int slice = 0;
+    int found = 0;
+    for (int j = BR; j >= UR; j--)
+        if (cube.edgePerm(j) >= FR)
+            slice += binomial(11 - j, ++found);
+    return slice;
+}
+
+//Slots of the four slice edges in increasing order
+static void decodeSlicePositions(int slice, int* positions)
+{
+    for (int x = 3; x >= 0; x--)
+    {
+        int k = x;
+        while (binomial(k + 1, x + 1) <= slice)
+            k++;
+        slice -= binomial(k, x + 1);
+        positions[3 - x] = 11 - k;
+    }
+}
+
+static void placeSliceEdges(cubieCube& cube, int slice, const uint8_t* sliceOrder)
+{
+    int positions[4];
+    decodeSlicePositions(slice, positions);
+
+    bool isSliceSlot[12] = {};
+    for (int i = 0; i < 4; i++)
+    {
+        cube.setEdge(positions[i], FR + sliceOrder[i], 0);
+        isSliceSlot[positions[i]] = true;
+    }
+
+    //The remaining slots get the U and D edges in order
+    int other = UR;
+    for (int j = UR; j <= BR; j++)
+        if (!isSliceSlot[j])
+            cube.setEdge(j, other++, 0);
+}
+
+void setSlice(cubieCube& cube, int slice)
+{
+    static const uint8_t identity[4] = { 0, 1, 2, 3 };
+    placeSliceEdges(cube, slice, identity);
+}
+
+int getSliceSorted(const cubieCube& cube)
+{
+    uint8_t order[4];
+    int count = 0;
+    for (int j = UR; j <= BR; j++)
+        if (cube.edgePerm(j) >= FR)
+            order[count++] = (uint8_t)(cube.edgePerm(j) - FR);
+    return getSlice(cube) * SLICE_PERM_COUNT + permutationRank(order, 4);
+}
+
+void setSliceSorted(cubieCube& cube, int sliceSorted)
+{
+    uint8_t order[4];
+    permutationUnrank(sliceSorted % SLICE_PERM_COUNT, order, 4);
+    placeSliceEdges(cube, sliceSorted / SLICE_PERM_COUNT, order);
+}
+
+int getCornerPerm(const cubieCube& cube)
+{
+    uint8_t perm[8];
+    for (int i = 0; i < CORNER_COUNT; i++)
+        perm[i] = cube.cornerPerm(i);
+    return permutationRank(perm, 8);
+}
+
+void setCornerPerm(cubieCube& cube, int cornerPerm)
+{
+    uint8_t perm[8];
+    permutationUnrank(cornerPerm, perm, 8);
+    for (int i = 0; i < CORNER_COUNT; i++)
+        cube.setCorner(i, perm[i], cube.cornerOri(i));
+}
+
+int getUdEdgePerm(const cubieCube& cube)
+{
+    //Only valid while every U/D edge sits in a U/D slot, which holds throughout phase 2
+    uint8_t perm[8];
+    for (int i = UR; i <= DB; i++)
+        perm[i] = cube.edgePerm(i) & 7;
+    return permutationRank(perm, 8);
+}
+
+void setUdEdgePerm(cubieCube& cube, int udEdgePerm)
+{
+    uint8_t perm[8];
+    permutationUnrank(udEdgePerm, perm, 8);
+    for (int i = UR; i <= DB; i++)
+        cube.setEdge(i, perm[i], 0);
+    for (int i = FR; i <= BR; i++)
+        cube.setEdge(i, i, 0);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+#include "cubieCube.h"
+
+//Coordinates map one aspect of a cubieCube to a dense integer so it can index move and pruning tables
+//Every coordinate is 0 for the solved cube. Setters only define the part of the cube the coordinate describes, the rest is left solved
+const int TWIST_COUNT = 2187;           //3^7 corner orientations
+const int FLIP_COUNT = 2048;            //2^11 edge orientations
+const int SLICE_COUNT = 495;            //C(12,4) positions of the UD-slice edges (FR, FL, BL, BR), order ignored
+const int SLICE_SORTED_COUNT = 11880;   //Positions and order of the UD-slice edges, 495 * 24
+const int SLICE_PERM_COUNT = 24;        //Order of the UD-slice edges while they stay in the slice (phase 2)
+const int CORNER_PERM_COUNT = 40320;    //8! corner permutations
+const int UD_EDGE_PERM_COUNT = 40320;   //8! permutations of the U and D layer edges, only meaningful in phase 2
+
+int getTwist(const cubieCube& cube);
+void setTwist(cubieCube& cube, int twist);
+
+int getFlip(const cubieCube& cube);
+void setFlip(cubieCube& cube, int flip);
+
+int getSlice(const cubieCube& cube);
+void setSlice(cubieCube& cube, int slice);
+
+int getSliceSorted(const cubieCube& cube);
+void setSliceSorted(cubieCube& cube, int sliceSorted);
+
+int getCornerPerm(const cubieCube& cube);
+void setCornerPerm(cubieCube& cube, int cornerPerm);
+
+int getUdEdgePerm(const cubieCube& cube);
+void setUdEdgePerm(cubieCube& cube, int udEdgePerm);
+
+//Helpers shared with the other coordinate schemes
+int binomial(int n, int k);
+int permutationRank(const uint8_t* perm, int length);
+void permutationUnrank(int rank, uint8_t* perm, int length);
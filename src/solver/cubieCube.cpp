@@ -0,0 +1,496 @@
+#include "cubieCube.h"
+#include <stdexcept>
+#include <sstream>
+
+//Face turns as permutation/orientation of the slots (Kociemba's definitions). Powers are built by repeated multiplication
+static const uint8_t BASIC_CORNER_PERM[6][8] =
+{
+    { UBR, URF, UFL, ULB, DFR, DLF, DBL, DRB },     //U
+    { DFR, UFL, ULB, URF, DRB, DLF, DBL, UBR },     //R
+    { UFL, DLF, ULB, UBR, URF, DFR, DBL, DRB },     //F
+    { URF, UFL, ULB, UBR, DLF, DBL, DRB, DFR },     //D
+    { URF, ULB, DBL, UBR, DFR, UFL, DLF, DRB },     //L
+    { URF, UFL, UBR, DRB, DFR, DLF, ULB, DBL }      //B
+};
+static const uint8_t BASIC_CORNER_ORI[6][8] =
+{
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 2, 0, 0, 1, 1, 0, 0, 2 },
+    { 1, 2, 0, 0, 2, 1, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 2, 0, 0, 2, 1, 0 },
+    { 0, 0, 1, 2, 0, 0, 2, 1 }
+};
+static const uint8_t BASIC_EDGE_PERM[6][12] =
+{
+    { UB, UR, UF, UL, DR, DF, DL, DB, FR, FL, BL, BR },
+    { FR, UF, UL, UB, BR, DF, DL, DB, DR, FL, BL, UR },
+    { UR, FL, UL, UB, DR, FR, DL, DB, UF, DF, BL, BR },
+    { UR, UF, UL, UB, DF, DL, DB, DR, FR, FL, BL, BR },
+    { UR, UF, BL, UB, DR, DF, FL, DB, FR, UL, DL, BR },
+    { UR, UF, UL, BR, DR, DF, DL, BL, FR, FL, UB, DB }
+};
+static const uint8_t BASIC_EDGE_ORI[6][12] =
+{
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1 }
+};
+
+//Facelet positions of each corner/edge slot, first entry is the U or D facelet (or F/B for the middle layer edges)
+static const uint8_t CORNER_FACELET[8][3] =
+{
+    { 8, 9, 20 }, { 6, 18, 38 }, { 0, 36, 47 }, { 2, 45, 11 },
+    { 29, 26, 15 }, { 27, 44, 24 }, { 33, 53, 42 }, { 35, 17, 51 }
+};
+static const uint8_t EDGE_FACELET[12][2] =
+{
+    { 5, 10 }, { 7, 19 }, { 3, 37 }, { 1, 46 }, { 32, 16 }, { 28, 25 },
+    { 30, 43 }, { 34, 52 }, { 23, 12 }, { 21, 41 }, { 50, 39 }, { 48, 14 }
+};
+static const uint8_t CORNER_COLOR[8][3] =
+{
+    { FACE_U, FACE_R, FACE_F }, { FACE_U, FACE_F, FACE_L }, { FACE_U, FACE_L, FACE_B }, { FACE_U, FACE_B, FACE_R },
+    { FACE_D, FACE_F, FACE_R }, { FACE_D, FACE_L, FACE_F }, { FACE_D, FACE_B, FACE_L }, { FACE_D, FACE_R, FACE_B }
+};
+static const uint8_t EDGE_COLOR[12][2] =
+{
+    { FACE_U, FACE_R }, { FACE_U, FACE_F }, { FACE_U, FACE_L }, { FACE_U, FACE_B }, { FACE_D, FACE_R }, { FACE_D, FACE_F },
+    { FACE_D, FACE_L }, { FACE_D, FACE_B }, { FACE_F, FACE_R }, { FACE_F, FACE_L }, { FACE_B, FACE_L }, { FACE_B, FACE_R }
+};
+static const char FACE_NAMES[] = "URFDLB";
+
+const cubieCube& cubieCube::solved()
+{
+    static const cubieCube cube = []
+    {
+        cubieCube c;
+        for (int i = 0; i < 16; i++)
+        {
+            c.corners[i] = (uint8_t)i;
+            c.edges[i] = (uint8_t)i;
+        }
+        return c;
+    }();
+    return cube;
+}
+
+struct moveCubeTable
+{
+    cubieCube cubes[MOVE_COUNT];
+
+    moveCubeTable()
+    {
+        for (int face = 0; face < 6; face++)
+        {
+            cubieCube basic = cubieCube::solved();
+            for (int i = 0; i < CORNER_COUNT; i++)
+                basic.setCorner(i, BASIC_CORNER_PERM[face][i], BASIC_CORNER_ORI[face][i]);
+            for (int i = 0; i < EDGE_COUNT; i++)
+                basic.setEdge(i, BASIC_EDGE_PERM[face][i], BASIC_EDGE_ORI[face][i]);
+
+            //Quarter, half and three quarter turns
+            cubieCube power = basic;
+            for (int p = 0; p < 3; p++)
+            {
+                cubes[face * 3 + p] = power;
+                multiply(power, basic, power);
+            }
+        }
+    }
+};
+
+const cubieCube& cubieCube::moveCube(int move)
+{
+    static const moveCubeTable table;
+    return table.cubes[move];
+}
+
+void cubieCube::apply(const std::vector<uint8_t>& moves)
+{
+    applyMoves(*this, moves.data(), moves.size());
+}
+
+cubieCube cubieCube::inverse() const
+{
+    cubieCube inv = solved();
+    for (int i = 0; i < CORNER_COUNT; i++)
+        inv.setCorner(cornerPerm(i), i, (3 - cornerOri(i)) % 3);
+    for (int i = 0; i < EDGE_COUNT; i++)
+        inv.setEdge(edgePerm(i), i, edgeOri(i));
+    return inv;
+}
+
+int cubieCube::cornerParity() const
+{
+    int parity = 0;
+    for (int i = CORNER_COUNT - 1; i > 0; i--)
+        for (int j = i - 1; j >= 0; j--)
+            if (cornerPerm(j) > cornerPerm(i))
+                parity++;
+    return parity & 1;
+}
+
+int cubieCube::edgeParity() const
+{
+    int parity = 0;
+    for (int i = EDGE_COUNT - 1; i > 0; i--)
+        for (int j = i - 1; j >= 0; j--)
+            if (edgePerm(j) > edgePerm(i))
+                parity++;
+    return parity & 1;
+}
+
+//-2 missing/duplicate edge, -3 edge flip sum, -4 missing/duplicate corner, -5 corner twist sum, -6 parity mismatch
+int cubieCube::verify() const
+{
+    uint32_t seen = 0;
+    int flipSum = 0;
+    for (int i = 0; i < EDGE_COUNT; i++)
+    {
+        if (edgePerm(i) >= EDGE_COUNT || edgeOri(i) > 1)
+            return -2;
+        seen |= 1u << edgePerm(i);
+        flipSum += edgeOri(i);
+    }
+    if (seen != 0xFFF)
+        return -2;
+    if (flipSum % 2 != 0)
+        return -3;
+
+    seen = 0;
+    int twistSum = 0;
+    for (int i = 0; i < CORNER_COUNT; i++)
+    {
+        if (cornerPerm(i) >= CORNER_COUNT || cornerOri(i) > 2)
+            return -4;
+        seen |= 1u << cornerPerm(i);
+        twistSum += cornerOri(i);
+    }
+    if (seen != 0xFF)
+        return -4;
+    if (twistSum % 3 != 0)
+        return -5;
+
+    if (cornerParity() != edgeParity())
+        return -6;
+    return 0;
+}
+
+std::string cubieCube::toFacelets() const
+{
+    std::string facelets(54, ' ');
+    for (int face = 0; face < 6; face++)
+        facelets[face * 9 + 4] = FACE_NAMES[face];
+
+    for (int i = 0; i < CORNER_COUNT; i++)
+        for (int n = 0; n < 3; n++)
+            facelets[CORNER_FACELET[i][(n + cornerOri(i)) % 3]] = FACE_NAMES[CORNER_COLOR[cornerPerm(i)][n]];
+    for (int i = 0; i < EDGE_COUNT; i++)
+        for (int n = 0; n < 2; n++)
+            facelets[EDGE_FACELET[i][(n + edgeOri(i)) % 2]] = FACE_NAMES[EDGE_COLOR[edgePerm(i)][n]];
+    return facelets;
+}
+
+//Sticker colors of a slot, first sticker first, to piece | ori << 4. 0xFF where no piece has those colors in that order
+struct faceletLookup
+{
+    uint8_t corners[6 * 6 * 6];
+    uint8_t edges[6 * 6];
+
+    faceletLookup()
+    {
+        memset(corners, 0xFF, sizeof(corners));
+        memset(edges, 0xFF, sizeof(edges));
+        for (int piece = 0; piece < CORNER_COUNT; piece++)
+        {
+            //With orientation ori, sticker n of the piece sits on facelet (n + ori) % 3 of the slot
+            for (int ori = 0; ori < 3; ori++)
+            {
+                uint8_t seen[3];
+                for (int n = 0; n < 3; n++)
+                    seen[(n + ori) % 3] = CORNER_COLOR[piece][n];
+                corners[seen[0] * 36 + seen[1] * 6 + seen[2]] = (uint8_t)(piece | (ori << 4));
+            }
+        }
+        for (int piece = 0; piece < EDGE_COUNT; piece++)
+        {
+            edges[EDGE_COLOR[piece][0] * 6 + EDGE_COLOR[piece][1]] = (uint8_t)piece;
+            edges[EDGE_COLOR[piece][1] * 6 + EDGE_COLOR[piece][0]] = (uint8_t)(piece | (1 << 4));
+        }
+    }
+};
+
+const char* faceletErrorName(faceletError error)
+{
+    switch (error)
+    {
+    case faceletError::none: return "ok";
+    case faceletError::length: return "not 54 facelets";
+    case faceletError::centers: return "two centers have the same color";
+    case faceletError::unknownColor: return "color that no center has";
+    case faceletError::colorCount: return "a color does not appear 9 times";
+    case faceletError::invalidCorner: return "impossible corner colors";
+    case faceletError::invalidEdge: return "impossible edge colors";
+    case faceletError::duplicateCorner: return "corner appears twice";
+    case faceletError::duplicateEdge: return "edge appears twice";
+    case faceletError::twist: return "twisted corner";
+    case faceletError::flip: return "flipped edge";
+    case faceletError::parity: return "two pieces swapped";
+    }
+    return "unknown";
+}
+
+faceletError cubieCube::checkFacelets(const std::string& facelets, cubieCube& cube)
+{
+    static const faceletLookup lookup;
+    if (facelets.size() != 54)
+        return faceletError::length;
+
+    //Centers define the colors, so any six distinct letters work (URFDLB or the sticker colors)
+    int8_t colorOf[256];
+    memset(colorOf, -1, sizeof(colorOf));
+    for (int face = 0; face < 6; face++)
+    {
+        uint8_t center = (uint8_t)facelets[face * 9 + 4];
+        if (colorOf[center] != -1)
+            return faceletError::centers;
+        colorOf[center] = (int8_t)face;
+    }
+
+    uint8_t colors[54];
+    int counts[6] = {};
+    for (int i = 0; i < 54; i++)
+    {
+        int color = colorOf[(uint8_t)facelets[i]];
+        if (color < 0)
+            return faceletError::unknownColor;
+        colors[i] = (uint8_t)color;
+        counts[color]++;
+    }
+    for (int face = 0; face < 6; face++)
+        if (counts[face] != 9)
+            return faceletError::colorCount;
+
+    cube = solved();
+    for (int i = 0; i < CORNER_COUNT; i++)
+    {
+        uint8_t piece = lookup.corners[colors[CORNER_FACELET[i][0]] * 36 + colors[CORNER_FACELET[i][1]] * 6 + colors[CORNER_FACELET[i][2]]];
+        if (piece == 0xFF)
+            return faceletError::invalidCorner;
+        cube.corners[i] = piece;
+    }
+    for (int i = 0; i < EDGE_COUNT; i++)
+    {
+        uint8_t piece = lookup.edges[colors[EDGE_FACELET[i][0]] * 6 + colors[EDGE_FACELET[i][1]]];
+        if (piece == 0xFF)
+            return faceletError::invalidEdge;
+        cube.edges[i] = piece;
+    }
+
+    uint32_t seenCorners = 0;
+    uint32_t seenEdges = 0;
+    int twistSum = 0;
+    int flipSum = 0;
+    for (int i = 0; i < CORNER_COUNT; i++)
+    {
+        seenCorners |= 1u << cube.cornerPerm(i);
+        twistSum += cube.cornerOri(i);
+    }
+    for (int i = 0; i < EDGE_COUNT; i++)
+    {
+        seenEdges |= 1u << cube.edgePerm(i);
+        flipSum += cube.edgeOri(i);
+    }
+    if (seenCorners != 0xFF)
+        return faceletError::duplicateCorner;
+    if (seenEdges != 0xFFF)
+        return faceletError::duplicateEdge;
+    if (twistSum % 3 != 0)
+        return faceletError::twist;
+    if (flipSum % 2 != 0)
+        return faceletError::flip;
+    if (cube.cornerParity() != cube.edgeParity())
+        return faceletError::parity;
+    return faceletError::none;
+}
+
+bool cubieCube::fromFacelets(const std::string& facelets, cubieCube& cube)
+{
+    //Everything from duplicate pieces on is left to verify()
+    faceletError error = checkFacelets(facelets, cube);
+    return error == faceletError::none || error >= faceletError::duplicateCorner;
+}
+
+std::string moveName(int move)
+{
+    static const char* suffix[3] = { "", "2", "'" };
+    return std::string(1, FACE_NAMES[move / 3]) + suffix[move % 3];
+}
+
+std::vector<uint8_t> parseMoves(const std::string& text)
+{
+    std::vector<uint8_t> moves;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        char c = text[i];
+        if (c == ' ' || c == '\t' || c == ',')
+        {
+            i++;
+            continue;
+        }
+
+        const char* face = strchr(FACE_NAMES, c);
+        if (face == nullptr || c == '\0')
+            throw std::runtime_error(std::string("Invalid move in sequence: ") + c);
+        int move = (int)(face - FACE_NAMES) * 3;
+        i++;
+
+        //Accept U, U2, U', U2' and U3
+        if (i < text.size() && (text[i] == '2' || text[i] == '3'))
+            move += text[i++] - '1';
+        if (i < text.size() && text[i] == '\'')
+        {
+            move = inverseMove(move);
+            i++;
+        }
+        moves.push_back((uint8_t)move);
+    }
+    return moves;
+}
+
+std::string formatMoves(const std::vector<uint8_t>& moves)
+{
+    std::ostringstream out;
+    for (size_t i = 0; i < moves.size(); i++)
+        out << (i ? " " : "") << moveName(moves[i]);
+    return out.str();
+}
+
+//Batch kernels, one copy per instruction set. The inline multiply is fixed at compile time, these pick at run time
+static void applyMovesScalar(cubieCube& cube, const uint8_t* moves, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const cubieCube& m = cubieCube::moveCube(moves[i]);
+        cubieCube r;
+        for (int j = 0; j < 16; j++)
+        {
+            uint8_t corner = (uint8_t)(cube.corners[m.corners[j] & 0x0F] + (m.corners[j] & 0xF0));
+            uint8_t edge = (uint8_t)(cube.edges[m.edges[j] & 0x0F] + (m.edges[j] & 0xF0));
+            r.corners[j] = corner >= 48 ? corner - 48 : corner;
+            r.edges[j] = edge >= 32 ? edge - 32 : edge;
+        }
+        cube = r;
+    }
+}
+
+static void applyMoveToBatchScalar(cubieCube* cubes, size_t count, int move)
+{
+    const uint8_t m = (uint8_t)move;
+    for (size_t i = 0; i < count; i++)
+        applyMovesScalar(cubes[i], &m, 1);
+}
+
+#if RUBIK_X86
+RUBIK_TARGET_SSSE3 static void applyMovesSsse3(cubieCube& cube, const uint8_t* moves, size_t count)
+{
+    const __m128i permMask = _mm_set1_epi8(0x0F);
+    const __m128i cornerModulus = _mm_set1_epi8(48);
+    const __m128i edgeModulus = _mm_set1_epi8(32);
+    __m128i c = _mm_load_si128(reinterpret_cast<const __m128i*>(cube.corners));
+    __m128i e = _mm_load_si128(reinterpret_cast<const __m128i*>(cube.edges));
+    for (size_t i = 0; i < count; i++)
+    {
+        const cubieCube& m = cubieCube::moveCube(moves[i]);
+        __m128i mc = _mm_load_si128(reinterpret_cast<const __m128i*>(m.corners));
+        __m128i me = _mm_load_si128(reinterpret_cast<const __m128i*>(m.edges));
+        c = _mm_add_epi8(_mm_shuffle_epi8(c, _mm_and_si128(mc, permMask)), _mm_andnot_si128(permMask, mc));
+        e = _mm_add_epi8(_mm_shuffle_epi8(e, _mm_and_si128(me, permMask)), _mm_andnot_si128(permMask, me));
+        c = _mm_min_epu8(c, _mm_sub_epi8(c, cornerModulus));
+        e = _mm_min_epu8(e, _mm_sub_epi8(e, edgeModulus));
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(cube.corners), c);
+    _mm_store_si128(reinterpret_cast<__m128i*>(cube.edges), e);
+}
+
+RUBIK_TARGET_SSSE3 static void applyMoveToBatchSsse3(cubieCube* cubes, size_t count, int move)
+{
+    const uint8_t m = (uint8_t)move;
+    for (size_t i = 0; i < count; i++)
+        applyMovesSsse3(cubes[i], &m, 1);
+}
+
+RUBIK_TARGET_AVX2 static void applyMovesAvx2(cubieCube& cube, const uint8_t* moves, size_t count)
+{
+    const __m256i permMask = _mm256_set1_epi8(0x0F);
+    const __m256i modulus = _mm256_setr_epi8(48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+                                             32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32);
+    __m256i state = _mm256_load_si256(reinterpret_cast<const __m256i*>(&cube));
+    for (size_t i = 0; i < count; i++)
+    {
+        __m256i m = _mm256_load_si256(reinterpret_cast<const __m256i*>(&cubieCube::moveCube(moves[i])));
+        state = _mm256_add_epi8(_mm256_shuffle_epi8(state, _mm256_and_si256(m, permMask)), _mm256_andnot_si256(permMask, m));
+        state = _mm256_min_epu8(state, _mm256_sub_epi8(state, modulus));
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&cube), state);
+}
+
+RUBIK_TARGET_AVX2 static void applyMoveToBatchAvx2(cubieCube* cubes, size_t count, int move)
+{
+    const __m256i permMask = _mm256_set1_epi8(0x0F);
+    const __m256i modulus = _mm256_setr_epi8(48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+                                             32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32);
+    __m256i m = _mm256_load_si256(reinterpret_cast<const __m256i*>(&cubieCube::moveCube(move)));
+    __m256i index = _mm256_and_si256(m, permMask);
+    __m256i ori = _mm256_andnot_si256(permMask, m);
+    for (size_t i = 0; i < count; i++)
+    {
+        __m256i state = _mm256_load_si256(reinterpret_cast<const __m256i*>(&cubes[i]));
+        state = _mm256_add_epi8(_mm256_shuffle_epi8(state, index), ori);
+        state = _mm256_min_epu8(state, _mm256_sub_epi8(state, modulus));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(&cubes[i]), state);
+    }
+}
+#endif
+
+typedef void (*applyMovesKernel)(cubieCube&, const uint8_t*, size_t);
+typedef void (*applyMoveToBatchKernel)(cubieCube*, size_t, int);
+
+static applyMovesKernel selectApplyMoves()
+{
+#if RUBIK_X86
+    if (dispatchLevel() >= cpuLevel::avx2)
+        return applyMovesAvx2;
+    if (dispatchLevel() >= cpuLevel::ssse3)
+        return applyMovesSsse3;
+#endif
+    return applyMovesScalar;
+}
+
+static applyMoveToBatchKernel selectApplyMoveToBatch()
+{
+#if RUBIK_X86
+    if (dispatchLevel() >= cpuLevel::avx2)
+        return applyMoveToBatchAvx2;
+    if (dispatchLevel() >= cpuLevel::ssse3)
+        return applyMoveToBatchSsse3;
+#endif
+    return applyMoveToBatchScalar;
+}
+
+void applyMoves(cubieCube& cube, const uint8_t* moves, size_t count)
+{
+    static const applyMovesKernel kernel = selectApplyMoves();
+    kernel(cube, moves, count);
+}
+
+void applyMoveToBatch(cubieCube* cubes, size_t count, int move)
+{
+    static const applyMoveToBatchKernel kernel = selectApplyMoveToBatch();
+    kernel(cubes, count, move);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../cpuFeatures.h"
+
+#if RUBIK_X86
+    #include <immintrin.h>
+#endif
+
+//Corner and edge positions, in the order used by Kociemba's cubie model
+enum cornerSlot : uint8_t { URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB };
+enum edgeSlot : uint8_t { UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR };
+
+//Faces in move order. Move m turns face m / 3 by (m % 3 + 1) quarter turns clockwise
+enum cubeFace : uint8_t { FACE_U, FACE_R, FACE_F, FACE_D, FACE_L, FACE_B };
+
+const int CORNER_COUNT = 8;
+const int EDGE_COUNT = 12;
+const int MOVE_COUNT = 18;
+
+//Why a facelet string is not a reachable cube, in the order checkFacelets tests for them
+enum class faceletError : uint8_t
+{
+    none = 0,
+    length,             //Not 54 characters
+    centers,            //Two centers share a letter
+    unknownColor,       //A letter none of the centers has
+    colorCount,         //A color that does not appear exactly 9 times
+    invalidCorner,      //Three stickers no corner has, e.g. two opposite colors
+    invalidEdge,
+    duplicateCorner,
+    duplicateEdge,
+    twist,              //A corner twisted in place
+    flip,               //An edge flipped in place
+    parity              //Two pieces swapped
+};
+
+const char* faceletErrorName(faceletError error);
+
+//Cube state at the cubie level, laid out so a whole state fits one 256-bit (or two 128-bit) registers
+//Byte i of corners/edges describes the piece sitting in slot i: low nibble is the piece, high nibble its orientation
+//(corners twist 0..2, edges flip 0..1). Bytes past the last slot hold their own index so the shuffle stays a plain permutation
+struct alignas(32) cubieCube
+{
+    uint8_t corners[16];
+    uint8_t edges[16];
+
+    static const cubieCube& solved();
+    static const cubieCube& moveCube(int move);
+
+    uint8_t cornerPerm(int slot) const { return corners[slot] & 0x0F; }
+    uint8_t cornerOri(int slot) const { return corners[slot] >> 4; }
+    uint8_t edgePerm(int slot) const { return edges[slot] & 0x0F; }
+    uint8_t edgeOri(int slot) const { return edges[slot] >> 4; }
+    void setCorner(int slot, int piece, int ori) { corners[slot] = (uint8_t)(piece | (ori << 4)); }
+    void setEdge(int slot, int piece, int ori) { edges[slot] = (uint8_t)(piece | (ori << 4)); }
+
+    //Apply a face turn, this = this * moveCube(move)
+    inline void move(int m);
+    void apply(const std::vector<uint8_t>& moves);
+
+    cubieCube inverse() const;
+
+    int cornerParity() const;
+    int edgeParity() const;
+
+    //0 if the state is reachable by face turns, otherwise a negative code (see verify in cubieCube.cpp)
+    int verify() const;
+
+    //Facelet strings use Kociemba's order: U1..U9 R1..R9 F1..F9 D1..D9 L1..L9 B1..B9, one letter per face
+    std::string toFacelets() const;
+    //Parses only, a state that parses can still fail verify()
+    static bool fromFacelets(const std::string& facelets, cubieCube& cube);
+    //Parses and checks solvability with table lookups, for strings from color detection. cube holds the state if it returns none
+    static faceletError checkFacelets(const std::string& facelets, cubieCube& cube);
+
+    bool operator==(const cubieCube& other) const { return memcmp(this, &other, sizeof(cubieCube)) == 0; }
+    bool operator!=(const cubieCube& other) const { return !(*this == other); }
+};
+
+//Move notation helpers ("R", "U2", "F'")
+std::string moveName(int move);
+std::vector<uint8_t> parseMoves(const std::string& text);
+std::string formatMoves(const std::vector<uint8_t>& moves);
+inline int inverseMove(int move) { return move - move % 3 + 2 - move % 3; }
+
+//Apply a move sequence / one move to a batch of cubes using the best instruction set of the running CPU
+void applyMoves(cubieCube& cube, const uint8_t* moves, size_t count);
+void applyMoveToBatch(cubieCube* cubes, size_t count, int move);
+
+//c = a * b: c[i] takes the piece of a in slot b.perm[i] and adds b's orientation to it
+//Orientations are stored pre-scaled by 16, so the twist sum is one byte add followed by a conditional subtract of 48 (corners) or 32 (edges)
+inline void multiply(const cubieCube& a, const cubieCube& b, cubieCube& c)
+{
+#if defined(__AVX2__)
+    const __m256i permMask = _mm256_set1_epi8(0x0F);
+    const __m256i modulus = _mm256_setr_epi8(48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+                                             32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32);
+    __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(&a));
+    __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(&b));
+    __m256i r = _mm256_shuffle_epi8(va, _mm256_and_si256(vb, permMask));
+    r = _mm256_add_epi8(r, _mm256_andnot_si256(permMask, vb));
+    r = _mm256_min_epu8(r, _mm256_sub_epi8(r, modulus));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&c), r);
+#elif defined(__SSSE3__) || defined(_MSC_VER) && RUBIK_X86
+    const __m128i permMask = _mm_set1_epi8(0x0F);
+    __m128i ca = _mm_load_si128(reinterpret_cast<const __m128i*>(a.corners));
+    __m128i cb = _mm_load_si128(reinterpret_cast<const __m128i*>(b.corners));
+    __m128i ea = _mm_load_si128(reinterpret_cast<const __m128i*>(a.edges));
+    __m128i eb = _mm_load_si128(reinterpret_cast<const __m128i*>(b.edges));
+    __m128i rc = _mm_add_epi8(_mm_shuffle_epi8(ca, _mm_and_si128(cb, permMask)), _mm_andnot_si128(permMask, cb));
+    __m128i re = _mm_add_epi8(_mm_shuffle_epi8(ea, _mm_and_si128(eb, permMask)), _mm_andnot_si128(permMask, eb));
+    rc = _mm_min_epu8(rc, _mm_sub_epi8(rc, _mm_set1_epi8(48)));
+    re = _mm_min_epu8(re, _mm_sub_epi8(re, _mm_set1_epi8(32)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(c.corners), rc);
+    _mm_store_si128(reinterpret_cast<__m128i*>(c.edges), re);
+#else
+    cubieCube r;
+    for (int i = 0; i < 16; i++)
+    {
+        uint8_t corner = (uint8_t)(a.corners[b.corners[i] & 0x0F] + (b.corners[i] & 0xF0));
+        uint8_t edge = (uint8_t)(a.edges[b.edges[i] & 0x0F] + (b.edges[i] & 0xF0));
+        r.corners[i] = corner >= 48 ? corner - 48 : corner;
+        r.edges[i] = edge >= 32 ? edge - 32 : edge;
+    }
+    c = r;
+#endif
+}
+
+inline void cubieCube::move(int m)
+{
+    multiply(*this, moveCube(m), *this);
+}
@@ -0,0 +1,89 @@
+#include "mappedFile.h"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define RUBIK_HAS_MMAP 1
+#else
+    #define RUBIK_HAS_MMAP 0
+#endif
+
+mappedFile::~mappedFile()
+{
+    close();
+}
+
+bool mappedFile::open(const std::string& path, const mapOptions& options)
+{
+    close();
+#if RUBIK_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (options.populate)
+        flags |= MAP_POPULATE;
+#endif
+    void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, flags, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return false;
+
+    if (options.randomAccess)
+        madvise(address, (size_t)info.st_size, MADV_RANDOM);
+    else if (options.populate)
+        madvise(address, (size_t)info.st_size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    //Only takes effect where the kernel supports huge pages for file mappings, otherwise silently ignored
+    if (options.hugePages)
+        madvise(address, (size_t)info.st_size, MADV_HUGEPAGE);
+#endif
+
+    mData = static_cast<const uint8_t*>(address);
+    mSize = (size_t)info.st_size;
+    mMapped = true;
+    return true;
+#else
+    (void)options;
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    mFallback.resize((size_t)file.tellg());
+    file.seekg(0);
+    if (mFallback.empty() || !file.read(reinterpret_cast<char*>(mFallback.data()), mFallback.size()))
+    {
+        mFallback.clear();
+        return false;
+    }
+
+    mData = mFallback.data();
+    mSize = mFallback.size();
+    return true;
+#endif
+}
+
+void mappedFile::close()
+{
+#if RUBIK_HAS_MMAP
+    if (mMapped)
+        munmap(const_cast<uint8_t*>(mData), mSize);
+#endif
+    mFallback.clear();
+    mFallback.shrink_to_fit();
+    mData = nullptr;
+    mSize = 0;
+    mMapped = false;
+}
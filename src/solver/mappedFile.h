@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Kernel hints for a mapping, all of them are best effort
+struct mapOptions
+{
+    bool populate = false;      //Fault every page in up front (MAP_POPULATE) instead of on first touch
+    bool randomAccess = true;   //Pruning lookups jump around, so read-ahead only wastes page cache
+    bool hugePages = false;     //Ask for transparent huge pages (MADV_HUGEPAGE), fewer TLB misses on large tables
+};
+
+//Read-only view of a whole file. On POSIX systems the file is mapped shared, so processes loading the same table share its pages
+//Elsewhere the file is read into memory
+class mappedFile
+{
+public:
+    mappedFile() = default;
+    ~mappedFile();
+    mappedFile(const mappedFile&) = delete;
+    mappedFile& operator=(const mappedFile&) = delete;
+
+    bool open(const std::string& path, const mapOptions& options = mapOptions());
+    void close();
+
+    const uint8_t* data() const { return mData; }
+    size_t size() const { return mSize; }
+    bool isOpen() const { return mData != nullptr; }
+
+private:
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+    bool mMapped = false;
+    std::vector<uint8_t> mFallback;
+};
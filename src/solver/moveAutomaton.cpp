@@ -0,0 +1,228 @@
+#include "moveAutomaton.h"
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "moveTables.h"
+#include "tableFile.h"
+
+//Longest redundant patterns searched for. Past these lengths the enumeration grows by 13x (18 moves) or 7x (phase 2) per move
+//and finds few new patterns
+static const int FULL_PATTERN_LENGTH = 5;
+static const int PHASE2_PATTERN_LENGTH = 6;
+
+struct cubeHash
+{
+    size_t operator()(const cubieCube& cube) const
+    {
+        uint64_t words[4];
+        memcpy(words, &cube, sizeof(words));
+        uint64_t hash = words[0] * 0x9E3779B97F4A7C15ull ^ words[1];
+        hash = hash * 0xBF58476D1CE4E5B9ull ^ words[2];
+        hash = hash * 0x94D049BB133111EBull ^ words[3];
+        return (size_t)(hash ^ (hash >> 29));
+    }
+};
+
+//Aho-Corasick over the redundant patterns: a state is the longest suffix of the sequence that is a prefix of some pattern,
+//and a move is forbidden when the new suffix ends in a pattern
+static void buildTransitions(const std::vector<std::vector<uint8_t>>& patterns, const bool* allowed, std::vector<uint16_t>& next)
+{
+    std::vector<int> children(MOVE_COUNT, -1);
+    std::vector<uint8_t> terminal(1, 0);
+    for (const std::vector<uint8_t>& pattern : patterns)
+    {
+        int node = 0;
+        for (uint8_t m : pattern)
+        {
+            if (children[node * MOVE_COUNT + m] < 0)
+            {
+                children[node * MOVE_COUNT + m] = (int)terminal.size();
+                terminal.push_back(0);
+                children.resize(terminal.size() * MOVE_COUNT, -1);
+            }
+            node = children[node * MOVE_COUNT + m];
+        }
+        terminal[node] = 1;
+    }
+
+    size_t nodeCount = terminal.size();
+    if (nodeCount >= moveAutomaton::FORBIDDEN)
+        throw std::runtime_error("Move automaton has too many states!");
+
+    //Breadth first, so a node's failure link is complete before its children need it
+    std::vector<int> fail(nodeCount, 0);
+    std::vector<int> order(1, 0);
+    std::vector<int> go(nodeCount * MOVE_COUNT, 0);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        int node = order[i];
+        for (int m = 0; m < MOVE_COUNT; m++)
+        {
+            int child = children[node * MOVE_COUNT + m];
+            int fallback = node == 0 ? 0 : go[fail[node] * MOVE_COUNT + m];
+            if (child < 0)
+            {
+                go[node * MOVE_COUNT + m] = fallback;
+                continue;
+            }
+            go[node * MOVE_COUNT + m] = child;
+            fail[child] = fallback;
+            terminal[child] |= terminal[fallback];
+            order.push_back(child);
+        }
+    }
+
+    next.assign(nodeCount * MOVE_COUNT, moveAutomaton::FORBIDDEN);
+    for (size_t node = 0; node < nodeCount; node++)
+    {
+        for (int m = 0; m < MOVE_COUNT; m++)
+        {
+            int target = go[node * MOVE_COUNT + m];
+            if (allowed[m] && !terminal[node] && !terminal[target])
+                next[node * MOVE_COUNT + m] = (uint16_t)target;
+        }
+    }
+}
+
+void moveAutomaton::generate(const uint8_t* moves, int moveCount, int maxLength)
+{
+    bool allowed[MOVE_COUNT] = {};
+    for (int i = 0; i < moveCount; i++)
+        allowed[moves[i]] = true;
+
+    struct sequence
+    {
+        cubieCube cube;
+        uint8_t moves[8];
+    };
+
+    //Each level is expanded in the order it was built, so within a length sequences come in increasing move order
+    std::vector<std::vector<uint8_t>> patterns;
+    std::unordered_set<cubieCube, cubeHash> seen;
+    seen.insert(cubieCube::solved());
+    std::vector<sequence> level(1, sequence{ cubieCube::solved(), {} });
+    for (int length = 0; length < maxLength; length++)
+    {
+        buildTransitions(patterns, allowed, mNext);
+        std::vector<sequence> nextLevel;
+        for (const sequence& current : level)
+        {
+            uint16_t state = START;
+            for (int i = 0; i < length; i++)
+                state = next(state, current.moves[i]);
+
+            for (int i = 0; i < moveCount; i++)
+            {
+                int m = moves[i];
+                if (next(state, m) == FORBIDDEN)
+                    continue;
+                sequence extended = current;
+                extended.moves[length] = (uint8_t)m;
+                multiply(current.cube, cubieCube::moveCube(m), extended.cube);
+                if (seen.insert(extended.cube).second)
+                    nextLevel.push_back(extended);
+                else
+                    patterns.emplace_back(extended.moves, extended.moves + length + 1);
+            }
+        }
+        level.swap(nextLevel);
+    }
+
+    buildTransitions(patterns, allowed, mNext);
+    mPatternCount = (int)patterns.size();
+}
+
+double moveAutomaton::branchingFactor(int length) const
+{
+    std::vector<double> count(stateCount(), 0.0);
+    count[START] = 1.0;
+    double previous = 1.0;
+    double total = 1.0;
+    for (int i = 0; i < length; i++)
+    {
+        std::vector<double> extended(stateCount(), 0.0);
+        for (int state = 0; state < stateCount(); state++)
+            for (int m = 0; m < MOVE_COUNT; m++)
+                if (count[state] > 0.0 && next((uint16_t)state, m) != FORBIDDEN)
+                    extended[next((uint16_t)state, m)] += count[state];
+        count.swap(extended);
+        previous = total;
+        total = 0.0;
+        for (double c : count)
+            total += c;
+    }
+    return total / previous;
+}
+
+bool moveAutomaton::load(const std::string& path, uint64_t parameter)
+{
+    tableFile file;
+    if (!file.open(path, tableScheme::moveAutomaton, parameter, 1))
+        return false;
+
+    const uint8_t* counts = file.section("counts", 2 * sizeof(uint32_t));
+    if (counts == nullptr)
+        return false;
+    uint32_t header[2];
+    memcpy(header, counts, sizeof(header));
+
+    const uint8_t* data = file.section("next", (uint64_t)header[0] * MOVE_COUNT * sizeof(uint16_t));
+    if (data == nullptr || !file.verifyAll())
+        return false;
+    mNext.resize((size_t)header[0] * MOVE_COUNT);
+    memcpy(mNext.data(), data, mNext.size() * sizeof(uint16_t));
+    mPatternCount = (int)header[1];
+    return true;
+}
+
+void moveAutomaton::save(const std::string& path, uint64_t parameter) const
+{
+    uint32_t header[2] = { (uint32_t)stateCount(), (uint32_t)mPatternCount };
+    tableWriter writer(tableScheme::moveAutomaton, parameter, 1);
+    writer.addSection("counts", header, sizeof(header));
+    writer.addSection("next", mNext.data(), mNext.size() * sizeof(uint16_t));
+    writer.write(path);
+}
+
+//A few hundred KB, copied out of the file rather than kept mapped
+static moveAutomaton loadOrGenerate(const char* name, const uint8_t* moves, int moveCount, int maxLength)
+{
+    uint64_t parameter = (uint64_t)maxLength << 32;
+    for (int i = 0; i < moveCount; i++)
+        parameter |= 1ull << moves[i];
+
+    moveAutomaton automaton;
+    std::string path = tableDirectory() + "/" + name;
+    if (automaton.load(path, parameter))
+        return automaton;
+
+    automaton.generate(moves, moveCount, maxLength);
+    try
+    {
+        automaton.save(path, parameter);
+    }
+    catch (const std::exception&)
+    {
+        //A read-only table directory only costs regenerating next launch
+    }
+    return automaton;
+}
+
+const moveAutomaton& moveAutomaton::full()
+{
+    static const moveAutomaton automaton = []
+    {
+        uint8_t moves[MOVE_COUNT];
+        for (int m = 0; m < MOVE_COUNT; m++)
+            moves[m] = (uint8_t)m;
+        return loadOrGenerate("automaton_full.tbl", moves, MOVE_COUNT, FULL_PATTERN_LENGTH);
+    }();
+    return automaton;
+}
+
+const moveAutomaton& moveAutomaton::phase2()
+{
+    static const moveAutomaton automaton = loadOrGenerate("automaton_phase2.tbl", PHASE2_MOVES, PHASE2_MOVE_COUNT, PHASE2_PATTERN_LENGTH);
+    return automaton;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cubieCube.h"
+
+//Finite state machine over move sequences that only accepts canonical ones, so a search never expands two sequences
+//that reach the same state with the same number of moves
+//Built by enumerating every sequence up to a length over a move set: a sequence reaching a state an earlier sequence (shorter,
+//or as long and smaller move by move) already reached is redundant, and no sequence containing it is accepted. The shortest,
+//smallest sequence for any state contains no redundant part, so a search over the accepted sequences still finds every state at
+//its distance. Up to length 2 this is the old rule (no face twice in a row, opposite faces in one order only); longer patterns
+//such as R2 L2 U2 D2-style commutations follow from the enumeration
+//Witnesses only use moves of the automaton's own move set, so a restricted search (phase 2) keeps a representative in its subgroup
+class moveAutomaton
+{
+public:
+    static const uint16_t START = 0;
+    static const uint16_t FORBIDDEN = 0xFFFF;
+
+    //Over all 18 moves, and over the phase 2 moves. Mapped from the table directory on first use, thread safe.
+    //Generated (about a second for the full one) and saved there if missing
+    static const moveAutomaton& full();
+    static const moveAutomaton& phase2();
+
+    void generate(const uint8_t* moves, int moveCount, int maxLength);
+    bool load(const std::string& path, uint64_t parameter);
+    void save(const std::string& path, uint64_t parameter) const;
+
+    //State after appending move to a sequence in state, FORBIDDEN if the result is not canonical
+    uint16_t next(uint16_t state, int move) const { return mNext[state * MOVE_COUNT + move]; }
+
+    int stateCount() const { return (int)(mNext.size() / MOVE_COUNT); }
+    int patternCount() const { return mPatternCount; }
+
+    //Accepted sequences of length + 1 over those of length, for long sequences (what a search without pruning would branch)
+    double branchingFactor(int length = 20) const;
+
+private:
+    std::vector<uint16_t> mNext;
+    int mPatternCount = 0;
+};
@@ -0,0 +1,78 @@
+#include "moveTables.h"
+#include <memory>
+
+#include "tableFile.h"
+
+const uint8_t PHASE2_MOVES[PHASE2_MOVE_COUNT] = { 0, 1, 2, 4, 7, 9, 10, 11, 13, 16 };
+
+//Build one table by setting every coordinate value on a solved cube, turning it and reading the coordinate back
+static void fillTable(uint16_t (*table)[MOVE_COUNT], int count, void (*setter)(cubieCube&, int), int (*getter)(const cubieCube&), bool phase2Only)
+{
+    for (int coord = 0; coord < count; coord++)
+    {
+        cubieCube base = cubieCube::solved();
+        setter(base, coord);
+        for (int m = 0; m < MOVE_COUNT; m++)
+        {
+            if (phase2Only && !isPhase2Move(m))
+            {
+                table[coord][m] = 0xFFFF;
+                continue;
+            }
+            cubieCube turned;
+            multiply(base, cubieCube::moveCube(m), turned);
+            table[coord][m] = (uint16_t)getter(turned);
+        }
+    }
+}
+
+void moveTables::generate()
+{
+    fillTable(twist, TWIST_COUNT, setTwist, getTwist, false);
+    fillTable(flip, FLIP_COUNT, setFlip, getFlip, false);
+    fillTable(slice, SLICE_COUNT, setSlice, getSlice, false);
+    fillTable(sliceSorted, SLICE_SORTED_COUNT, setSliceSorted, getSliceSorted, false);
+    fillTable(cornerPerm, CORNER_PERM_COUNT, setCornerPerm, getCornerPerm, false);
+    fillTable(udEdgePerm, UD_EDGE_PERM_COUNT, setUdEdgePerm, getUdEdgePerm, true);
+}
+
+//Either a view into the mapped table file or a freshly generated copy on the heap (about 3.7 MB)
+struct moveTableStore
+{
+    tableFile file;
+    std::unique_ptr<moveTables> generated;
+    const moveTables* tables = nullptr;
+
+    moveTableStore()
+    {
+        //The struct size doubles as a layout check, a file from a build with other table shapes is rebuilt
+        std::string path = tableDirectory() + "/twophase_moves.tbl";
+        if (file.open(path, tableScheme::twoPhaseMoves, sizeof(moveTables), 1))
+            tables = reinterpret_cast<const moveTables*>(file.section("moves", sizeof(moveTables)));
+        if (tables != nullptr)
+        {
+            file.verifyInBackground();
+            return;
+        }
+
+        generated.reset(new moveTables());
+        generated->generate();
+        tables = generated.get();
+        try
+        {
+            tableWriter writer(tableScheme::twoPhaseMoves, sizeof(moveTables), 1);
+            writer.addSection("moves", tables, sizeof(moveTables));
+            writer.write(path);
+        }
+        catch (const std::exception&)
+        {
+            //A read-only table directory only costs regenerating next launch
+        }
+    }
+};
+
+const moveTables& moveTables::get()
+{
+    static const moveTableStore store;
+    return *store.tables;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+#include "coordinates.h"
+
+//Phase 2 only turns U and D freely and the other faces by half turns
+const int PHASE2_MOVE_COUNT = 10;
+extern const uint8_t PHASE2_MOVES[PHASE2_MOVE_COUNT];
+inline bool isPhase2Move(int move) { return move / 3 == FACE_U || move / 3 == FACE_D || move % 3 == 1; }
+
+//Skip turning the same face twice in a row, and turning opposite faces in both orders (U D and D U reach the same state)
+//The searches use moveAutomaton, which also removes longer redundant sequences; this is left for joining two searches
+inline bool canFollow(int move, int lastMove)
+{
+    if (lastMove < 0)
+        return true;
+    int face = move / 3;
+    int lastFace = lastMove / 3;
+    return face != lastFace && face + 3 != lastFace;
+}
+
+//Dense coordinate transition tables, table[coordinate][move] is the coordinate after applying move
+//Rows are MOVE_COUNT entries wide so expanding a search node reads one or two cache lines per coordinate
+//The phase 1 tables (twist, flip, slice) total about 170 KB and the slice row of a node is 36 bytes
+struct moveTables
+{
+    uint16_t twist[TWIST_COUNT][MOVE_COUNT];
+    uint16_t flip[FLIP_COUNT][MOVE_COUNT];
+    uint16_t slice[SLICE_COUNT][MOVE_COUNT];
+    uint16_t sliceSorted[SLICE_SORTED_COUNT][MOVE_COUNT];
+    uint16_t cornerPerm[CORNER_PERM_COUNT][MOVE_COUNT];
+
+    //Only phase 2 moves are filled in, other entries are 0xFFFF since they take U/D edges into the slice
+    uint16_t udEdgePerm[UD_EDGE_PERM_COUNT][MOVE_COUNT];
+
+    //Mapped from the table directory on first use, thread safe. Generated (under 100 ms) and saved there if missing
+    static const moveTables& get();
+
+    void generate();
+};
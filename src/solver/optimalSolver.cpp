@@ -0,0 +1,180 @@
+#include "optimalSolver.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+//How many nodes a worker expands between clock reads
+static const uint64_t TIME_CHECK_MASK = 0xFFF;
+
+optimalSolver::optimalSolver(const patternDatabase& database) : mDatabase(database), mMoves(moveTables::get()), mAutomaton(moveAutomaton::full())
+{
+}
+
+solverResult optimalSolver::solve(const cubieCube& cube, const optimalOptions& options)
+{
+    if (cube.verify() != 0)
+        throw std::runtime_error("Cube state is not solvable!");
+    requireIntactTables();
+
+    auto startTime = std::chrono::steady_clock::now();
+    mStart = cube;
+    mResult = solverResult();
+    mNodes = 0;
+    mStop = false;
+    mHasDeadline = options.timeLimitSeconds > 0.0;
+    mDeadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeLimitSeconds));
+
+    int threadCount = options.threads > 0 ? options.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    int maxLength = std::min(options.maxLength, MAX_DEPTH);
+
+    if (cube == cubieCube::solved())
+    {
+        mResult.found = true;
+        return mResult;
+    }
+
+    mStartDistances = mDatabase.distances(cube, getCornerPerm(cube), getTwist(cube));
+    int bound = std::max(1, mDatabase.distance(cube, getCornerPerm(cube), getTwist(cube), mStartDistances));
+    for (; bound <= maxLength && !mStop; bound++)
+    {
+        //Every canonical move sequence of the prefix length is one unit of work for this iteration
+        std::vector<prefix> prefixes;
+        int length = std::min(bound, PREFIX_LENGTH);
+        for (int first = 0; first < MOVE_COUNT; first++)
+        {
+            uint16_t state = mAutomaton.next(moveAutomaton::START, first);
+            if (length == 1)
+            {
+                prefixes.push_back({ { (uint8_t)first, 0 }, 1, state });
+                continue;
+            }
+            for (int second = 0; second < MOVE_COUNT; second++)
+                if (mAutomaton.next(state, second) != moveAutomaton::FORBIDDEN)
+                    prefixes.push_back({ { (uint8_t)first, (uint8_t)second }, 2, mAutomaton.next(state, second) });
+        }
+
+        mNextPrefix = 0;
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threadCount; i++)
+            workers.emplace_back(&optimalSolver::runWorker, this, std::cref(prefixes), bound);
+        runWorker(prefixes, bound);
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    mResult.nodes = mNodes;
+    mResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return mResult;
+}
+
+void optimalSolver::runWorker(const std::vector<prefix>& prefixes, int bound)
+{
+    uint8_t path[MAX_DEPTH];
+    uint64_t nodes = 0;
+    uint64_t hits[PRUNE_HIT_VALUES] = {};
+    while (!mStop)
+    {
+        size_t index = mNextPrefix++;
+        if (index >= prefixes.size())
+            break;
+
+        //Every prefix node is checked, the mod 3 tables need the distances of each one for the next
+        const prefix& work = prefixes[index];
+        cubieCube cube = mStart;
+        int cornerPerm = getCornerPerm(cube);
+        int twist = getTwist(cube);
+        patternDatabase::nodeDistances distances = mStartDistances;
+        bool pruned = false;
+        for (int i = 0; i < work.length && !pruned; i++)
+        {
+            cube.move(work.moves[i]);
+            cornerPerm = mMoves.cornerPerm[cornerPerm][work.moves[i]];
+            twist = mMoves.twist[twist][work.moves[i]];
+            path[i] = work.moves[i];
+            pruned = mDatabase.exceeds(cube, mDatabase.keys(cube, cornerPerm, twist), bound - i - 1, distances, distances);
+        }
+        nodes += work.length;
+
+        bool found;
+        if (pruned)
+            found = false;
+        else if (work.length == bound)
+            found = cube == cubieCube::solved();
+        else
+            found = search(cube, cornerPerm, twist, distances, work.length, bound - work.length, work.state, path, nodes, hits);
+
+        if (found)
+        {
+            std::lock_guard<std::mutex> lock(mResultMutex);
+            if (!mResult.found)
+            {
+                mResult.moves.assign(path, path + bound);
+                mResult.found = true;
+            }
+            mStop = true;
+        }
+    }
+    mNodes += nodes;
+    if (RUBIK_SOLVER_STATS)
+    {
+        std::lock_guard<std::mutex> lock(mResultMutex);
+        for (int value = 0; value < PRUNE_HIT_VALUES; value++)
+            mResult.pruneHits[0][value] += hits[value];
+    }
+}
+
+bool optimalSolver::search(const cubieCube& cube, int cornerPerm, int twist, const patternDatabase::nodeDistances& distances, int depth, int togo,
+                           uint16_t state, uint8_t* path, uint64_t& nodes, uint64_t* hits)
+{
+    //All children and their first pattern lookups up front: the prefetched entries load while earlier subtrees are searched
+    cubieCube children[MOVE_COUNT];
+    patternDatabase::lookupKeys keys[MOVE_COUNT];
+    uint8_t moves[MOVE_COUNT];
+    uint16_t states[MOVE_COUNT];
+    int count = 0;
+    for (int m = 0; m < MOVE_COUNT; m++)
+    {
+        uint16_t nextState = mAutomaton.next(state, m);
+        if (nextState == moveAutomaton::FORBIDDEN)
+            continue;
+        multiply(cube, cubieCube::moveCube(m), children[count]);
+        if (togo > 1)
+        {
+            keys[count] = mDatabase.keys(children[count], mMoves.cornerPerm[cornerPerm][m], mMoves.twist[twist][m]);
+            mDatabase.prefetch(keys[count]);
+        }
+        moves[count] = (uint8_t)m;
+        states[count++] = nextState;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int m = moves[i];
+        if ((++nodes & TIME_CHECK_MASK) == 0 && mHasDeadline && std::chrono::steady_clock::now() >= mDeadline)
+            mStop = true;
+        if (mStop)
+            return false;
+
+        const cubieCube& child = children[i];
+        if (togo == 1)
+        {
+            if (child != cubieCube::solved())
+                continue;
+            path[depth] = (uint8_t)m;
+            return true;
+        }
+
+        int nextCornerPerm = mMoves.cornerPerm[cornerPerm][m];
+        int nextTwist = mMoves.twist[twist][m];
+        if (RUBIK_SOLVER_STATS)
+            hits[mDatabase.distance(child, nextCornerPerm, nextTwist, distances)]++;
+        patternDatabase::nodeDistances childDistances;
+        if (mDatabase.exceeds(child, keys[i], togo - 1, distances, childDistances))
+            continue;
+
+        path[depth] = (uint8_t)m;
+        if (search(child, nextCornerPerm, nextTwist, childDistances, depth + 1, togo - 1, states[i], path, nodes, hits))
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "moveAutomaton.h"
+#include "patternDatabase.h"
+#include "solverResult.h"
+
+struct optimalOptions
+{
+    int maxLength = 20;             //God's number in the half-turn metric
+    int threads = 0;                //0 uses every hardware thread
+    double timeLimitSeconds = 0.0;  //0 means no limit, otherwise the search gives up without a solution
+};
+
+//Korf's IDA* with pattern database heuristics, returning a shortest solution in the half-turn metric
+//Each iteration is split into two-move prefixes that worker threads take from a shared counter
+class optimalSolver
+{
+public:
+    explicit optimalSolver(const patternDatabase& database);
+
+    //Throws if the cube is not a legal state
+    solverResult solve(const cubieCube& cube, const optimalOptions& options = optimalOptions());
+
+private:
+    static constexpr int MAX_DEPTH = 32;
+    static constexpr int PREFIX_LENGTH = 2;
+
+    struct prefix
+    {
+        uint8_t moves[PREFIX_LENGTH];
+        int length;
+        uint16_t state;     //Move automaton state after the prefix
+    };
+
+    void runWorker(const std::vector<prefix>& prefixes, int bound);
+    bool search(const cubieCube& cube, int cornerPerm, int twist, const patternDatabase::nodeDistances& distances, int depth, int togo,
+                uint16_t state, uint8_t* path, uint64_t& nodes, uint64_t* hits);
+
+    const patternDatabase& mDatabase;
+    const moveTables& mMoves;
+    const moveAutomaton& mAutomaton;
+
+    cubieCube mStart;
+    patternDatabase::nodeDistances mStartDistances = {};
+    std::chrono::steady_clock::time_point mDeadline;
+    bool mHasDeadline = false;
+
+    std::atomic<size_t> mNextPrefix{0};
+    std::atomic<bool> mStop{false};
+    std::atomic<uint64_t> mNodes{0};
+    std::mutex mResultMutex;
+    solverResult mResult;
+};
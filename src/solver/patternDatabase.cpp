@@ -0,0 +1,600 @@
+#include "patternDatabase.h"
+#include <iostream>
+#include <stdexcept>
+
+//Conjugates looked up besides the state itself. x2 = f2 * u4^2 carries Korf's set onto the other six edges, the 120 degree
+//rotations around the URF-DBL diagonal carry the U and D layers onto the F and B or the R and L layers
+static const uint8_t KORF_LOOKUP_SYMMETRIES[2] = { 0, 12 };
+static const uint8_t UD_LOOKUP_SYMMETRIES[3] = { 0, 16, 32 };
+
+//Elements of the corner symmetry group, UD symmetries followed by the same ones applied to the inverse
+static const int CORNER_GROUP_SIZE = 2 * UD_SYMMETRY_COUNT;
+
+static inline int popcount(uint32_t bits)
+{
+#if defined(_MSC_VER)
+    return (int)__popcnt(bits);
+#else
+    return __builtin_popcount(bits);
+#endif
+}
+
+static inline int countTrailingZeros(uint32_t bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return (int)index;
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+//Twist of the inverse state, whose corner in slot p is the one that sits in slot i with p its piece
+static int inverseTwist(const cubieCube& cube)
+{
+    uint8_t inverseOri[CORNER_COUNT];
+    for (int i = 0; i < CORNER_COUNT; i++)
+        inverseOri[cube.cornerPerm(i)] = (uint8_t)((3 - cube.cornerOri(i)) % 3);
+    int twist = 0;
+    for (int i = URF; i < DRB; i++)
+        twist = 3 * twist + inverseOri[i];
+    return twist;
+}
+
+//Walks the permutations in increasing order, so every representative is the smallest member of its class
+void patternDatabase::buildCornerClasses()
+{
+    const uint16_t UNASSIGNED = 0xFFFF;
+    mCornerClass.assign(CORNER_PERM_COUNT, UNASSIGNED);
+    mCornerSym.assign(CORNER_PERM_COUNT, 0);
+    mCornerRep.clear();
+    mCornerSelf.clear();
+
+    for (int perm = 0; perm < CORNER_PERM_COUNT; perm++)
+    {
+        if (mCornerClass[perm] != UNASSIGNED)
+            continue;
+        uint16_t cls = (uint16_t)mCornerRep.size();
+        mCornerRep.push_back((uint16_t)perm);
+        mCornerSelf.push_back(0);
+
+        cubieCube cube = cubieCube::solved();
+        setCornerPerm(cube, perm);
+        cubieCube inverse = cube.inverse();
+        for (int g = 0; g < CORNER_GROUP_SIZE; g++)
+        {
+            //S^-1 C S or S^-1 C^-1 S, which g carries back onto the representative
+            int s = g % UD_SYMMETRY_COUNT;
+            int other = getCornerPerm(symmetryConjugate(mSymmetry, mSymmetry.inverse[s], g < UD_SYMMETRY_COUNT ? cube : inverse));
+            if (other == perm)
+                mCornerSelf[cls] |= 1u << g;
+            if (mCornerClass[other] == UNASSIGNED)
+            {
+                mCornerClass[other] = cls;
+                mCornerSym[other] = (uint8_t)g;
+            }
+        }
+    }
+    mCornerCount = (uint64_t)mCornerRep.size() * TWIST_COUNT;
+}
+
+//Index of the state's (class, twist) entry. The twist is that of the state g carries onto the representative
+uint64_t patternDatabase::cornerKey(const cubieCube& cube, int cornerPerm, int twist) const
+{
+    int g = mCornerSym[cornerPerm];
+    if (g >= UD_SYMMETRY_COUNT)
+        twist = inverseTwist(cube);
+    return (uint64_t)mCornerClass[cornerPerm] * TWIST_COUNT + mSymmetry.twistConj[twist][g % UD_SYMMETRY_COUNT];
+}
+
+//The tracked pieces of a state are kept as one slot and flip per piece of mTracked. S C S^-1 has the piece c of slot u as piece
+//S(c) in slot S(u), flipped by the flip S gives c and the one S^-1 gives S(u)
+//The layout of S C S^-1 only follows from C's layout when S keeps the piece set and flips none of its pieces, so the edge
+//classes are taken under the UD symmetries that do both. That is all 16 for the U and D layer edges
+void patternDatabase::buildEdgeClasses(int edgePieces)
+{
+    mEdgePieces = edgePieces;
+    mTracked = edgePieces == 6 ? KORF_EDGE_PIECES : UD_EDGE_PIECES;
+    for (int i = 0; i < EDGE_COUNT; i++)
+        mTrackedIndex[i] = -1;
+    for (int j = 0; j < edgePieces; j++)
+        mTrackedIndex[mTracked[j]] = (int8_t)j;
+
+    mComboMask.clear();
+    for (uint32_t mask = 0; mask < (1u << EDGE_COUNT); mask++)
+    {
+        if (popcount(mask) != edgePieces)
+            continue;
+        mComboRank[mask] = (uint16_t)mComboMask.size();
+        mComboMask.push_back((uint16_t)mask);
+    }
+
+    mOrderCount = 1;
+    for (int j = edgePieces - 1; j >= 0; j--)
+    {
+        mOrderWeight[j] = (int)mOrderCount;
+        mOrderCount *= edgePieces - j;
+    }
+
+    mEdgeGroup = 0;
+    for (int t = 0; t < SYMMETRY_COUNT; t++)
+    {
+        const cubieCube& cube = mSymmetry.cubes[t];
+        const cubieCube& inverse = mSymmetry.cubes[mSymmetry.inverse[t]];
+        bool keeps = t < UD_SYMMETRY_COUNT;
+        for (int i = 0; i < EDGE_COUNT; i++)
+        {
+            mEdgeConj[t].slot[i] = cube.edgePerm(i);
+            mEdgeConj[t].slotFlip[i] = inverse.edgeOri(cube.edgePerm(i));
+            mEdgeConj[t].pieceFlip[i] = cube.edgeOri(i);
+            if (mTrackedIndex[i] >= 0)
+                keeps = keeps && mTrackedIndex[cube.edgePerm(i)] >= 0 && cube.edgeOri(i) == 0;
+        }
+        if (keeps)
+            mEdgeGroup |= 1u << t;
+    }
+
+    //Walks the layouts in increasing order, so every representative is the smallest member of its class
+    const uint32_t UNASSIGNED = ~0u;
+    uint32_t layouts = (uint32_t)mComboMask.size() << edgePieces;
+    std::vector<uint32_t> classOf(layouts, UNASSIGNED);
+    mLayoutSym.assign(layouts, 0);
+    mLayoutRep.clear();
+    mLayoutSelf.clear();
+
+    uint8_t positions[MAX_EDGE_PATTERN_PIECES];
+    for (int j = 0; j < edgePieces; j++)
+        positions[j] = (uint8_t)j;
+    for (uint32_t layout = 0; layout < layouts; layout++)
+    {
+        if (classOf[layout] != UNASSIGNED)
+            continue;
+        uint32_t cls = (uint32_t)mLayoutRep.size();
+        mLayoutRep.push_back(layout);
+        mLayoutSelf.push_back(0);
+
+        uint8_t slots[MAX_EDGE_PATTERN_PIECES];
+        uint8_t flips[MAX_EDGE_PATTERN_PIECES];
+        layoutPieces(layout, positions, slots, flips);
+        for (int s = 0; s < UD_SYMMETRY_COUNT; s++)
+        {
+            if (!((mEdgeGroup >> s) & 1))
+                continue;
+            uint8_t otherSlots[MAX_EDGE_PATTERN_PIECES];
+            uint8_t otherFlips[MAX_EDGE_PATTERN_PIECES];
+            conjugateTracked(mSymmetry.inverse[s], slots, flips, otherSlots, otherFlips);
+            uint32_t other = edgeLayout(otherSlots, otherFlips);
+            if (other == layout)
+                mLayoutSelf[cls] |= (uint16_t)(1 << s);
+            if (classOf[other] == UNASSIGNED)
+            {
+                classOf[other] = cls;
+                mLayoutSym[other] = (uint8_t)s;
+            }
+        }
+    }
+    mLayoutClass.assign(classOf.begin(), classOf.end());
+    mEdgeCount = (uint64_t)mLayoutRep.size() * mOrderCount;
+
+    //Lookup k reads the pieces of the state that its symmetry carries onto the tracked ones
+    const uint8_t* lookups = edgePieces == 6 ? KORF_LOOKUP_SYMMETRIES : UD_LOOKUP_SYMMETRIES;
+    mEdgeLookups = edgePieces == 6 ? 2 : 3;
+    for (int k = 0; k < mEdgeLookups; k++)
+    {
+        mEdgeLookupSym[k] = lookups[k];
+        for (int j = 0; j < edgePieces; j++)
+            mEdgeLookupSource[k][j] = mSymmetry.cubes[mSymmetry.inverse[lookups[k]]].edgePerm(mTracked[j]);
+    }
+}
+
+//Only for symmetries in mEdgeGroup, which map the tracked pieces onto each other without flipping them
+void patternDatabase::conjugateTracked(int symmetry, const uint8_t* slots, const uint8_t* flips, uint8_t* toSlots, uint8_t* toFlips) const
+{
+    const edgeConjugation& conj = mEdgeConj[symmetry];
+    for (int j = 0; j < mEdgePieces; j++)
+    {
+        int to = mTrackedIndex[conj.slot[mTracked[j]]];
+        toSlots[to] = conj.slot[slots[j]];
+        toFlips[to] = flips[j] ^ conj.slotFlip[slots[j]];
+    }
+}
+
+uint32_t patternDatabase::edgeLayout(const uint8_t* slots, const uint8_t* flips) const
+{
+    uint32_t mask = 0;
+    for (int j = 0; j < mEdgePieces; j++)
+        mask |= 1u << slots[j];
+    uint32_t flipBits = 0;
+    for (int j = 0; j < mEdgePieces; j++)
+        flipBits |= (uint32_t)flips[j] << popcount(mask & ((1u << slots[j]) - 1));
+    return (uint32_t)mComboRank[mask] << mEdgePieces | flipBits;
+}
+
+//Piece j goes to the positions[j]-th slot of the layout
+void patternDatabase::layoutPieces(uint32_t layout, const uint8_t* positions, uint8_t* slots, uint8_t* flips) const
+{
+    uint8_t slotAt[MAX_EDGE_PATTERN_PIECES];
+    uint32_t mask = mComboMask[layout >> mEdgePieces];
+    for (int k = 0; mask != 0; k++, mask &= mask - 1)
+        slotAt[k] = (uint8_t)countTrailingZeros(mask);
+    for (int j = 0; j < mEdgePieces; j++)
+    {
+        slots[j] = slotAt[positions[j]];
+        flips[j] = (uint8_t)((layout >> positions[j]) & 1);
+    }
+}
+
+//Rank of the pieces' positions among the occupied slots, like permutationRank: every piece counts the smaller positions after
+//it, which are the smaller ones not used yet
+int patternDatabase::edgeOrderRank(const uint8_t* slots) const
+{
+    uint32_t mask = 0;
+    for (int j = 0; j < mEdgePieces; j++)
+        mask |= 1u << slots[j];
+    int rank = 0;
+    uint32_t used = 0;
+    for (int j = 0; j < mEdgePieces; j++)
+    {
+        int position = popcount(mask & ((1u << slots[j]) - 1));
+        rank += (position - popcount(used & ((1u << position) - 1))) * mOrderWeight[j];
+        used |= 1u << position;
+    }
+    return rank;
+}
+
+//Index of the (layout class, order) entry. The canonical arrays get the pieces conjugated onto the class representative
+uint64_t patternDatabase::edgeKey(const uint8_t* slots, const uint8_t* flips, uint8_t* canonicalSlots, uint8_t* canonicalFlips) const
+{
+    uint32_t layout = edgeLayout(slots, flips);
+    conjugateTracked(mLayoutSym[layout], slots, flips, canonicalSlots, canonicalFlips);
+    return mLayoutClass[layout] * mOrderCount + edgeOrderRank(canonicalSlots);
+}
+
+std::string patternDatabase::fileName(int edgePieces, const patternEncodings& encodings)
+{
+    std::string name = "korf" + std::to_string(edgePieces);
+    if (encodings.corners != encodings.edges)
+        name += std::string("-") + pruneEncodingName(encodings.corners) + "-" + pruneEncodingName(encodings.edges);
+    else if (encodings.corners != pruneEncoding::nibble)
+        name += std::string("-") + pruneEncodingName(encodings.corners);
+    return name + ".tbl";
+}
+
+//Reduction factors of both tables, the corners' in the low byte and the edges' above it
+static uint32_t patternSymmetry(uint32_t edgeGroup)
+{
+    return (uint32_t)CORNER_GROUP_SIZE | (uint32_t)popcount(edgeGroup) << 8;
+}
+
+//Edge count and both encodings, nibble tables keep the plain edge count
+static uint64_t fileParameter(int edgePieces, const patternEncodings& encodings)
+{
+    return (uint64_t)edgePieces | (uint64_t)encodings.corners << 8 | (uint64_t)encodings.edges << 16;
+}
+
+std::vector<bfsStats> patternDatabase::generate(int edgePieces, const patternEncodings& encodings, int threads)
+{
+    if (edgePieces < MIN_EDGE_PATTERN_PIECES || edgePieces > MAX_EDGE_PATTERN_PIECES)
+        throw std::runtime_error("Unsupported edge pattern size!");
+    mFile.close();
+    buildCornerClasses();
+    buildEdgeClasses(edgePieces);
+    std::vector<bfsStats> stats;
+
+    //Corners: breadth first search over (corner perm class, twist). An entry stands for the inverse states too, and inversion
+    //turns C m into m^-1 C^-1, so the representative is moved from both sides. Its coordinates then come from the cube itself
+    packedTable corners(generatorBits(encodings.corners), mCornerCount);
+    stats.push_back(breadthFirstFill(corners, 0, [&](uint64_t index, auto&& visit)
+    {
+        cubieCube cube = cubieCube::solved();
+        setCornerPerm(cube, mCornerRep[index / TWIST_COUNT]);
+        setTwist(cube, (int)(index % TWIST_COUNT));
+        for (int m = 0; m < 2 * MOVE_COUNT; m++)
+        {
+            cubieCube next;
+            if (m < MOVE_COUNT)
+                multiply(cube, cubieCube::moveCube(m), next);
+            else
+                multiply(cubieCube::moveCube(m - MOVE_COUNT), cube, next);
+            uint64_t key = cornerKey(next, getCornerPerm(next), getTwist(next));
+            if (visit(key))
+                return;
+
+            //Representatives fixed by an element of the group stand for several twists with one distance
+            uint32_t self = mCornerSelf[key / TWIST_COUNT];
+            if (self == 1)
+                continue;
+            cubieCube rep = cubieCube::solved();
+            setCornerPerm(rep, mCornerRep[key / TWIST_COUNT]);
+            setTwist(rep, (int)(key % TWIST_COUNT));
+            int repTwists[2] = { (int)(key % TWIST_COUNT), inverseTwist(rep) };
+            uint64_t base = key - key % TWIST_COUNT;
+            for (int g = 1; g < CORNER_GROUP_SIZE; g++)
+            {
+                if ((self >> g) & 1)
+                    visit(base + mSymmetry.twistConj[repTwists[g / UD_SYMMETRY_COUNT]][g % UD_SYMMETRY_COUNT]);
+            }
+        }
+    }, threads));
+    mCorners.adopt(std::move(corners), encodings.corners);
+
+    //Edges: each tracked piece moves on its own, so a move is a lookup per piece followed by a re-rank
+    uint8_t slotAfter[EDGE_COUNT][MOVE_COUNT];
+    uint8_t flipAfter[EDGE_COUNT][MOVE_COUNT];
+    for (int m = 0; m < MOVE_COUNT; m++)
+    {
+        const cubieCube& moveCube = cubieCube::moveCube(m);
+        for (int i = 0; i < EDGE_COUNT; i++)
+        {
+            slotAfter[moveCube.edgePerm(i)][m] = (uint8_t)i;
+            flipAfter[moveCube.edgePerm(i)][m] = moveCube.edgeOri(i);
+        }
+    }
+
+    uint8_t slots[MAX_EDGE_PATTERN_PIECES] = {};
+    uint8_t flips[MAX_EDGE_PATTERN_PIECES] = {};
+    uint8_t canonicalSlots[MAX_EDGE_PATTERN_PIECES];
+    uint8_t canonicalFlips[MAX_EDGE_PATTERN_PIECES];
+    for (int j = 0; j < edgePieces; j++)
+        slots[j] = mTracked[j];
+
+    packedTable edges(generatorBits(encodings.edges), mEdgeCount);
+    stats.push_back(breadthFirstFill(edges, edgeKey(slots, flips, canonicalSlots, canonicalFlips), [&](uint64_t index, auto&& visit)
+    {
+        uint8_t positions[MAX_EDGE_PATTERN_PIECES];
+        uint8_t from[MAX_EDGE_PATTERN_PIECES];
+        uint8_t fromFlips[MAX_EDGE_PATTERN_PIECES];
+        permutationUnrank((int)(index % mOrderCount), positions, edgePieces);
+        layoutPieces(mLayoutRep[index / mOrderCount], positions, from, fromFlips);
+        for (int m = 0; m < MOVE_COUNT; m++)
+        {
+            uint8_t nextSlots[MAX_EDGE_PATTERN_PIECES];
+            uint8_t nextFlips[MAX_EDGE_PATTERN_PIECES];
+            for (int j = 0; j < edgePieces; j++)
+            {
+                nextSlots[j] = slotAfter[from[j]][m];
+                nextFlips[j] = fromFlips[j] ^ flipAfter[from[j]][m];
+            }
+            uint8_t repSlots[MAX_EDGE_PATTERN_PIECES];
+            uint8_t repFlips[MAX_EDGE_PATTERN_PIECES];
+            uint64_t key = edgeKey(nextSlots, nextFlips, repSlots, repFlips);
+            if (visit(key))
+                return;
+
+            //Representative layouts fixed by a symmetry stand for several orders with one distance
+            uint16_t self = mLayoutSelf[key / mOrderCount];
+            uint64_t base = key - key % mOrderCount;
+            for (int s = 1; self >> s; s++)
+            {
+                if ((self >> s) & 1)
+                {
+                    conjugateTracked(s, repSlots, repFlips, nextSlots, nextFlips);
+                    visit(base + edgeOrderRank(nextSlots));
+                }
+            }
+        }
+    }, threads));
+    mEdges.adopt(std::move(edges), encodings.edges);
+    return stats;
+}
+
+bool patternDatabase::load(const std::string& path, int edgePieces, const patternEncodings& encodings)
+{
+    if (edgePieces < MIN_EDGE_PATTERN_PIECES || edgePieces > MAX_EDGE_PATTERN_PIECES)
+        return false;
+    buildCornerClasses();
+    buildEdgeClasses(edgePieces);
+    if (!mFile.open(path, tableScheme::korfPattern, fileParameter(edgePieces, encodings), patternSymmetry(mEdgeGroup)))
+        return false;
+
+    const uint8_t* corners = mFile.section("corners", distanceTable::dataBytes(encodings.corners, mCornerCount));
+    const uint8_t* edges = mFile.section("edges", distanceTable::dataBytes(encodings.edges, mEdgeCount));
+    const uint8_t* cornersCache = nullptr;
+    const uint8_t* edgesCache = nullptr;
+    if (encodings.corners == pruneEncoding::cachedNibble)
+        cornersCache = mFile.section("cornersCache", distanceTable::cacheBytes(encodings.corners, mCornerCount));
+    if (encodings.edges == pruneEncoding::cachedNibble)
+        edgesCache = mFile.section("edgesCache", distanceTable::cacheBytes(encodings.edges, mEdgeCount));
+    if (corners == nullptr || edges == nullptr || (encodings.corners == pruneEncoding::cachedNibble && cornersCache == nullptr)
+        || (encodings.edges == pruneEncoding::cachedNibble && edgesCache == nullptr))
+    {
+        mFile.close();
+        return false;
+    }
+
+    mCorners.attach(encodings.corners, corners, cornersCache, mCornerCount);
+    mEdges.attach(encodings.edges, edges, edgesCache, mEdgeCount);
+    mFile.verifyInBackground();
+    return true;
+}
+
+void patternDatabase::save(const std::string& path) const
+{
+    tableWriter writer(tableScheme::korfPattern, fileParameter(mEdgePieces, encodings()), patternSymmetry(mEdgeGroup));
+    writer.addSection("corners", mCorners.data(), mCorners.bytes());
+    writer.addSection("edges", mEdges.data(), mEdges.bytes());
+    if (mCorners.cache() != nullptr)
+        writer.addSection("cornersCache", mCorners.cache(), mCorners.cacheBytes());
+    if (mEdges.cache() != nullptr)
+        writer.addSection("edgesCache", mEdges.cache(), mEdges.cacheBytes());
+    writer.write(path);
+}
+
+void patternDatabase::loadOrGenerate(const std::string& path, int edgePieces, const patternEncodings& encodings)
+{
+    if (load(path, edgePieces, encodings))
+        return;
+    std::vector<bfsStats> stats = generate(edgePieces, encodings);
+    stats[0].report(std::cerr, "corner pattern");
+    stats[1].report(std::cerr, "edge pattern");
+    save(path);
+}
+
+//Lookup k of the state whose piece p sits in slotOf[p] with flipOf[p]: the tracked pieces of its conjugate T C T^-1
+void patternDatabase::conjugateEdgeKeys(const uint8_t* slotOf, const uint8_t* flipOf, uint64_t* edges) const
+{
+    for (int k = 0; k < mEdgeLookups; k++)
+    {
+        const edgeConjugation& conj = mEdgeConj[mEdgeLookupSym[k]];
+        uint8_t slots[MAX_EDGE_PATTERN_PIECES];
+        uint8_t flips[MAX_EDGE_PATTERN_PIECES];
+        for (int j = 0; j < mEdgePieces; j++)
+        {
+            int piece = mEdgeLookupSource[k][j];
+            int slot = slotOf[piece];
+            slots[j] = conj.slot[slot];
+            flips[j] = flipOf[piece] ^ conj.pieceFlip[piece] ^ conj.slotFlip[slot];
+        }
+        uint8_t canonicalSlots[MAX_EDGE_PATTERN_PIECES];
+        uint8_t canonicalFlips[MAX_EDGE_PATTERN_PIECES];
+        edges[k] = edgeKey(slots, flips, canonicalSlots, canonicalFlips);
+    }
+}
+
+void patternDatabase::directEdgeKeys(const cubieCube& cube, uint64_t* edges) const
+{
+    uint8_t slotOf[EDGE_COUNT];
+    uint8_t flipOf[EDGE_COUNT];
+    for (int i = 0; i < EDGE_COUNT; i++)
+    {
+        slotOf[cube.edgePerm(i)] = (uint8_t)i;
+        flipOf[cube.edgePerm(i)] = cube.edgeOri(i);
+    }
+    conjugateEdgeKeys(slotOf, flipOf, edges);
+}
+
+//The inverse state needs no inversion for edges: the piece in slot p of the cube is where piece p sits in the inverse
+void patternDatabase::inverseEdgeKeys(const cubieCube& cube, uint64_t* edges) const
+{
+    uint8_t slotOf[EDGE_COUNT];
+    uint8_t flipOf[EDGE_COUNT];
+    for (int i = 0; i < EDGE_COUNT; i++)
+    {
+        slotOf[i] = cube.edgePerm(i);
+        flipOf[i] = cube.edgeOri(i);
+    }
+    conjugateEdgeKeys(slotOf, flipOf, edges);
+}
+
+patternDatabase::lookupKeys patternDatabase::keys(const cubieCube& cube, int cornerPerm, int twist) const
+{
+    lookupKeys keys;
+    keys.corners = cornerKey(cube, cornerPerm, twist);
+    if (mEdges.exact())
+        inverseEdgeKeys(cube, keys.edges);
+    else
+        directEdgeKeys(cube, keys.edges);
+    return keys;
+}
+
+void patternDatabase::prefetch(const lookupKeys& keys) const
+{
+    mCorners.prefetch(keys.corners);
+    for (int k = 0; k < mEdgeLookups; k++)
+        mEdges.prefetch(keys.edges[k]);
+}
+
+//Steps to a neighbor one closer (the one residue below) until the goal entry, 0 = corners, 1 + k = edge lookup k of keys.
+//No pattern is further away than God's number
+int patternDatabase::walkDistance(const distanceTable& table, const cubieCube& cube, int lookup) const
+{
+    auto keyOf = [&](const cubieCube& state)
+    {
+        lookupKeys stateKeys = keys(state, getCornerPerm(state), getTwist(state));
+        return lookup == 0 ? stateKeys.corners : stateKeys.edges[lookup - 1];
+    };
+
+    uint64_t goal = keyOf(cubieCube::solved());
+    cubieCube current = cube;
+    uint64_t key = keyOf(current);
+    int residue = table.residue(key);
+    int steps = 0;
+    while (key != goal)
+    {
+        bool stepped = false;
+        for (int m = 0; m < MOVE_COUNT && !stepped; m++)
+        {
+            cubieCube next;
+            multiply(current, cubieCube::moveCube(m), next);
+            uint64_t nextKey = keyOf(next);
+            if (table.residue(nextKey) == (residue + 2) % 3)
+            {
+                current = next;
+                key = nextKey;
+                residue = (residue + 2) % 3;
+                stepped = true;
+            }
+        }
+        if (!stepped || ++steps > 20)
+            throw std::runtime_error("Pattern database is damaged!");
+    }
+    return steps;
+}
+
+patternDatabase::nodeDistances patternDatabase::distances(const cubieCube& cube, int cornerPerm, int twist) const
+{
+    lookupKeys cubeKeys = keys(cube, cornerPerm, twist);
+    nodeDistances result = {};
+    result.corners = (uint8_t)(mCorners.exact() ? mCorners.distance(cubeKeys.corners, 0) : walkDistance(mCorners, cube, 0));
+    for (int k = 0; k < mEdgeLookups; k++)
+        result.edges[k] = (uint8_t)(mEdges.exact() ? mEdges.distance(cubeKeys.edges[k], 0) : walkDistance(mEdges, cube, 1 + k));
+    return result;
+}
+
+int patternDatabase::distance(const cubieCube& cube, int cornerPerm, int twist) const
+{
+    //A node is its own neighbor at distance 0 moves
+    return distance(cube, cornerPerm, twist, distances(cube, cornerPerm, twist));
+}
+
+int patternDatabase::distance(const cubieCube& cube, int cornerPerm, int twist, const nodeDistances& neighbor) const
+{
+    uint64_t edges[MAX_EDGE_LOOKUPS];
+    directEdgeKeys(cube, edges);
+    int best = mCorners.distance(cornerKey(cube, cornerPerm, twist), neighbor.corners);
+    for (int k = 0; k < mEdgeLookups; k++)
+    {
+        int edge = mEdges.distance(edges[k], neighbor.edges[k]);
+        best = best > edge ? best : edge;
+    }
+    return best;
+}
+
+bool patternDatabase::exceeds(const cubieCube& cube, const lookupKeys& keys, int bound, const nodeDistances& parent,
+                              nodeDistances& child) const
+{
+    //Cached bounds first, they stay in the cache while the full tables do not
+    if (mCorners.cachedBound(keys.corners) > bound)
+        return true;
+    for (int k = 0; k < mEdgeLookups; k++)
+    {
+        if (mEdges.cachedBound(keys.edges[k]) > bound)
+            return true;
+    }
+
+    int corners = mCorners.distance(keys.corners, parent.corners);
+    child.corners = (uint8_t)corners;
+    if (corners > bound)
+        return true;
+    for (int k = 0; k < mEdgeLookups; k++)
+    {
+        int edges = mEdges.distance(keys.edges[k], parent.edges[k]);
+        child.edges[k] = (uint8_t)edges;
+        if (edges > bound)
+            return true;
+    }
+    if (!mEdges.exact())
+        return false;
+
+    //An exact edge table also has the direct lookups, the first ones were of the inverse state. The corner table needs no
+    //inverse lookup, a state and its inverse share a class
+    uint64_t direct[MAX_EDGE_LOOKUPS];
+    directEdgeKeys(cube, direct);
+    for (int k = 0; k < mEdgeLookups; k++)
+    {
+        if (mEdges.cachedBound(direct[k]) > bound || mEdges.distance(direct[k], 0) > bound)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "moveTables.h"
+#include "symmetry.h"
+#include "tableFile.h"
+#include "tableGenerator.h"
+
+//Edge pieces tracked by the edge pattern. Six pieces use Korf's set, whose x2 conjugate covers the other six edges. Seven and
+//eight use the edges of the U and D layers: every UD symmetry keeps all eight in their layers, and the 120 degree rotations
+//around the URF-DBL diagonal carry them onto the R and L or the F and B layers for two more lookups
+const uint8_t KORF_EDGE_PIECES[6] = { UR, UF, UL, UB, FR, FL };
+const uint8_t UD_EDGE_PIECES[8] = { UR, UF, UL, UB, DR, DF, DL, DB };
+const int MIN_EDGE_PATTERN_PIECES = 6;
+const int MAX_EDGE_PATTERN_PIECES = 8;
+const int MAX_EDGE_LOOKUPS = 3;
+
+//Encoding of each of the two tables, see pruneEncoding
+struct patternEncodings
+{
+    pruneEncoding corners = pruneEncoding::nibble;
+    pruneEncoding edges = pruneEncoding::nibble;
+};
+
+//Korf's pattern databases: exact distances for all corners and for a subset of the edges with their orientations
+//Both tables are stored per symmetry class, every state of a class has the same distance:
+//  corners per (class of the permutation under the 16 UD symmetries and inversion, twist), 1672 * 2187 entries
+//  edges per (class of the tracked pieces' slots and flips under the symmetries that keep the piece set, order of the pieces
+//  over those slots), 16 symmetries for the U and D layer edges and 2 for the smaller sets
+//The inverse state has the same distance as the state, so the corner table already covers it and the edges are looked up
+//for both. Sizes as nibbles: corners 1.8 MB, edges 11 MB (6 pieces), 129 MB (7 pieces) or 166 MB (8 pieces)
+//The mod 3 encodings need less, but a search only knows a neighbor's distance for lookups that follow its moves, so a mod 3
+//edge table loses the inverse state lookups and prunes less
+class patternDatabase
+{
+public:
+    //"korf6.tbl" for nibble tables, "korf6-mod3.tbl" or "korf6-nibble-base3.tbl" for others
+    static std::string fileName(int edgePieces, const patternEncodings& encodings = patternEncodings());
+
+    //Returns the breadth first search statistics of the corner and the edge table. 0 threads uses every hardware thread
+    std::vector<bfsStats> generate(int edgePieces, const patternEncodings& encodings = patternEncodings(), int threads = 0);
+
+    //The file is mapped, not read, so several solver processes share one copy. Returns false if it is missing or does not match
+    bool load(const std::string& path, int edgePieces, const patternEncodings& encodings = patternEncodings());
+    void save(const std::string& path) const;
+    void loadOrGenerate(const std::string& path, int edgePieces, const patternEncodings& encodings = patternEncodings());
+
+    int edgePieces() const { return mEdgePieces; }
+    patternEncodings encodings() const { return { mCorners.encoding(), mEdges.encoding() }; }
+    uint64_t bytes() const { return mCorners.bytes() + mEdges.bytes() + mCorners.cacheBytes() + mEdges.cacheBytes(); }
+    uint64_t cacheBytes() const { return mCorners.cacheBytes() + mEdges.cacheBytes(); }
+
+    //Exact distances of the lookups exceeds makes first, which the mod 3 encodings decode a child's from
+    struct nodeDistances
+    {
+        uint8_t corners;
+        uint8_t edges[MAX_EDGE_LOOKUPS];
+    };
+
+    //For the search root: mod 3 tables find each distance by walking down to the goal
+    nodeDistances distances(const cubieCube& cube, int cornerPerm, int twist) const;
+
+    //Largest lower bound from the direct lookups, from a neighbor's distances for mod 3 tables or by walking without them
+    int distance(const cubieCube& cube, int cornerPerm, int twist) const;
+    int distance(const cubieCube& cube, int cornerPerm, int twist, const nodeDistances& neighbor) const;
+
+    //The entries exceeds reads first: corners, then the edges of the inverse state and its conjugates (the direct ones for a
+    //mod 3 edge table). A search computes them for all children and prefetches them together, so the cache misses overlap
+    struct lookupKeys
+    {
+        uint64_t corners;
+        uint64_t edges[MAX_EDGE_LOOKUPS];
+    };
+
+    lookupKeys keys(const cubieCube& cube, int cornerPerm, int twist) const;
+    void prefetch(const lookupKeys& keys) const;
+
+    //True when some lower bound proves the cube needs more than bound moves. Cheap lookups go first
+    //parent holds the distances of a neighbor, child gets the cube's own, complete whenever the result is false.
+    //They may be the same object
+    bool exceeds(const cubieCube& cube, const lookupKeys& keys, int bound, const nodeDistances& parent, nodeDistances& child) const;
+
+private:
+    //Symmetry classes of both tables, built in a few milliseconds before a table is generated or mapped
+    void buildCornerClasses();
+    void buildEdgeClasses(int edgePieces);
+
+    uint64_t cornerKey(const cubieCube& cube, int cornerPerm, int twist) const;
+    void conjugateTracked(int symmetry, const uint8_t* slots, const uint8_t* flips, uint8_t* toSlots, uint8_t* toFlips) const;
+    uint32_t edgeLayout(const uint8_t* slots, const uint8_t* flips) const;
+    void layoutPieces(uint32_t layout, const uint8_t* positions, uint8_t* slots, uint8_t* flips) const;
+    int edgeOrderRank(const uint8_t* slots) const;
+    uint64_t edgeKey(const uint8_t* slots, const uint8_t* flips, uint8_t* canonicalSlots, uint8_t* canonicalFlips) const;
+    void conjugateEdgeKeys(const uint8_t* slotOf, const uint8_t* flipOf, uint64_t* edges) const;
+    void directEdgeKeys(const cubieCube& cube, uint64_t* edges) const;
+    void inverseEdgeKeys(const cubieCube& cube, uint64_t* edges) const;
+    int walkDistance(const distanceTable& table, const cubieCube& cube, int lookup) const;
+
+    int mEdgePieces = 0;
+    const symmetryTables& mSymmetry = symmetryTables::get();
+    distanceTable mCorners;
+    distanceTable mEdges;
+    tableFile mFile;
+
+    //Corner permutation classes under G = UD symmetries x inversion. Element g < 16 is S C S^-1, g >= 16 is S C^-1 S^-1 with
+    //S symmetry g - 16. Self symmetries are a bit mask over g
+    std::vector<uint16_t> mCornerClass;
+    std::vector<uint8_t> mCornerSym;
+    std::vector<uint16_t> mCornerRep;
+    std::vector<uint32_t> mCornerSelf;
+    uint64_t mCornerCount = 0;
+
+    //Layout of the tracked edges: which slots they are in (combination rank) and their flips in slot order,
+    //rank << edgePieces | flips. Its classes, times the edgePieces! orders of the pieces over the slots, index the edge table
+    struct edgeConjugation
+    {
+        uint8_t slot[EDGE_COUNT];           //S(u), for slots and pieces alike
+        uint8_t slotFlip[EDGE_COUNT];       //Flip S^-1 gives slot S(u)
+        uint8_t pieceFlip[EDGE_COUNT];      //Flip S gives piece c
+    };
+
+    const uint8_t* mTracked = nullptr;
+    int8_t mTrackedIndex[EDGE_COUNT] = {};      //Position in mTracked, -1 for other pieces
+    uint16_t mComboRank[1 << EDGE_COUNT] = {};
+    std::vector<uint16_t> mComboMask;
+    std::vector<uint16_t> mLayoutClass;
+    std::vector<uint8_t> mLayoutSym;
+    std::vector<uint32_t> mLayoutRep;
+    std::vector<uint16_t> mLayoutSelf;
+    edgeConjugation mEdgeConj[SYMMETRY_COUNT] = {};
+    uint32_t mEdgeGroup = 0;                    //Bit s for the symmetries the layouts are reduced by
+    uint64_t mOrderCount = 0;
+    int mOrderWeight[MAX_EDGE_PATTERN_PIECES] = {};     //(edgePieces - 1 - j)! for piece j
+    uint64_t mEdgeCount = 0;
+
+    //Symmetries whose conjugates are looked up (the state itself first) and the pieces each one carries onto the tracked ones
+    int mEdgeLookups = 0;
+    uint8_t mEdgeLookupSym[MAX_EDGE_LOOKUPS] = {};
+    uint8_t mEdgeLookupSource[MAX_EDGE_LOOKUPS][MAX_EDGE_PATTERN_PIECES] = {};
+};
@@ -0,0 +1,139 @@
+#include "pruneTables.h"
+#include <iostream>
+#include <memory>
+
+//Breadth first search over the product of two coordinates, then widened to one byte per entry for the lookups
+static bfsStats fillTable(uint8_t* table, int countA, int countB, const uint16_t (*movesA)[MOVE_COUNT], const uint16_t (*movesB)[MOVE_COUNT],
+                          const uint8_t* moveList, int moveCount, int threads)
+{
+    uint64_t size = (uint64_t)countA * countB;
+    packedTable packed(4, size);
+    bfsStats stats = breadthFirstFill(packed, 0, [&](uint64_t index, auto&& visit)
+    {
+        int a = (int)(index / countB);
+        int b = (int)(index % countB);
+        for (int i = 0; i < moveCount; i++)
+        {
+            if (visit((uint64_t)movesA[a][moveList[i]] * countB + movesB[b][moveList[i]]))
+                return;
+        }
+    }, threads);
+
+    for (uint64_t i = 0; i < size; i++)
+    {
+        uint8_t value = packed.get(i);
+        table[i] = value == packed.unvisited() ? 0xFF : value;
+    }
+    return stats;
+}
+
+//Phase 1 search over (flip-slice class, twist). A move leaves the representative's class, so the neighbor is reduced again
+//Representatives with self-symmetries stand for several twists, all of them are visited so they get their distance together
+static bfsStats fillFlipSliceTwist(packedTable& table, const moveTables& moves, const symmetryTables& symmetry, int threads)
+{
+    return breadthFirstFill(table, 0, [&](uint64_t index, auto&& visit)
+    {
+        uint32_t rep = symmetry.flipSliceRep[index / TWIST_COUNT];
+        int flip = (int)(rep % FLIP_COUNT);
+        int slice = (int)(rep / FLIP_COUNT);
+        int twist = (int)(index % TWIST_COUNT);
+        for (int m = 0; m < MOVE_COUNT; m++)
+        {
+            int flipSlice = moves.slice[slice][m] * FLIP_COUNT + moves.flip[flip][m];
+            uint32_t base = (uint32_t)symmetry.flipSliceClass[flipSlice] * TWIST_COUNT;
+            int nextTwist = symmetry.twistConj[moves.twist[twist][m]][symmetry.flipSliceSym[flipSlice]];
+            if (visit(base + nextTwist))
+                return;
+
+            uint16_t self = symmetry.flipSliceSelf[base / TWIST_COUNT];
+            for (int s = 1; self >> s; s++)
+            {
+                if ((self >> s) & 1)
+                    visit(base + symmetry.twistConj[nextTwist][s]);
+            }
+        }
+    }, threads);
+}
+
+std::vector<bfsStats> pruneTables::generate(const moveTables& moves, int threads)
+{
+    mFile.close();
+    symmetry = &symmetryTables::get();
+    mStorage.resize(CORNER_SLICE_SIZE + EDGE_SLICE_SIZE);
+    uint8_t* cornerTable = mStorage.data();
+    uint8_t* edgeTable = cornerTable + CORNER_SLICE_SIZE;
+
+    std::vector<bfsStats> stats;
+    packedTable phase1(4, FLIP_SLICE_TWIST_COUNT);
+    stats.push_back(fillFlipSliceTwist(phase1, moves, *symmetry, threads));
+    flipSliceTwist.adopt(std::move(phase1));
+
+    //Inside phase 2 the sorted slice coordinate stays below 24 and equals the slice permutation
+    stats.push_back(fillTable(cornerTable, CORNER_PERM_COUNT, SLICE_PERM_COUNT, moves.cornerPerm, moves.sliceSorted, PHASE2_MOVES, PHASE2_MOVE_COUNT, threads));
+    stats.push_back(fillTable(edgeTable, UD_EDGE_PERM_COUNT, SLICE_PERM_COUNT, moves.udEdgePerm, moves.sliceSorted, PHASE2_MOVES, PHASE2_MOVE_COUNT, threads));
+
+    cornerSlice = cornerTable;
+    edgeSlice = edgeTable;
+    return stats;
+}
+
+//The parameter records the table sizes, so files from a build with other coordinates are rebuilt
+static const uint64_t PRUNE_TABLE_PARAMETER = FLIP_SLICE_TWIST_COUNT + pruneTables::CORNER_SLICE_SIZE + pruneTables::EDGE_SLICE_SIZE;
+static const uint32_t PRUNE_TABLE_SYMMETRY = UD_SYMMETRY_COUNT;     //The phase 1 table is stored per flip-slice class
+
+bool pruneTables::load(const std::string& path)
+{
+    if (!mFile.open(path, tableScheme::twoPhasePrune, PRUNE_TABLE_PARAMETER, PRUNE_TABLE_SYMMETRY))
+        return false;
+
+    const uint8_t* phase1 = mFile.section("flipSliceTwist", (FLIP_SLICE_TWIST_COUNT + 1) / 2);
+    cornerSlice = mFile.section("cornerSlice", CORNER_SLICE_SIZE);
+    edgeSlice = mFile.section("edgeSlice", EDGE_SLICE_SIZE);
+    if (!phase1 || !cornerSlice || !edgeSlice)
+    {
+        mFile.close();
+        return false;
+    }
+
+    flipSliceTwist.attach(phase1, FLIP_SLICE_TWIST_COUNT);
+    symmetry = &symmetryTables::get();
+    mStorage.clear();
+    mStorage.shrink_to_fit();
+    mFile.verifyInBackground();
+    return true;
+}
+
+void pruneTables::save(const std::string& path) const
+{
+    tableWriter writer(tableScheme::twoPhasePrune, PRUNE_TABLE_PARAMETER, PRUNE_TABLE_SYMMETRY);
+    writer.addSection("flipSliceTwist", flipSliceTwist.data(), flipSliceTwist.bytes());
+    writer.addSection("cornerSlice", cornerSlice, CORNER_SLICE_SIZE);
+    writer.addSection("edgeSlice", edgeSlice, EDGE_SLICE_SIZE);
+    writer.write(path);
+}
+
+const pruneTables& pruneTables::get()
+{
+    static const std::unique_ptr<pruneTables> tables = []()
+    {
+        std::unique_ptr<pruneTables> created(new pruneTables());
+        std::string path = tableDirectory() + "/twophase_prune.tbl";
+        if (created->load(path))
+            return created;
+
+        std::vector<bfsStats> stats = created->generate(moveTables::get());
+        const char* names[] = { "flip-slice class x twist", "corner perm x slice perm", "UD edge perm x slice perm" };
+        for (size_t i = 0; i < stats.size(); i++)
+            stats[i].report(std::cerr, names[i]);
+        try
+        {
+            created->save(path);
+        }
+        catch (const std::exception&)
+        {
+            //A read-only table directory only costs regenerating next launch
+        }
+        return created;
+    }();
+    return *tables;
+}
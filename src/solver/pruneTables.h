@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "moveTables.h"
+#include "symmetry.h"
+#include "tableFile.h"
+#include "tableGenerator.h"
+
+//Exact move distances in a projection of the cube, used as admissible IDA* heuristics
+//Phase 1 projects onto (flip-slice, twist), reduced by the 16 UD symmetries to (flip-slice class, twist): 141 million
+//4-bit entries in 70 MB instead of 2.2 billion. Phase 2 projects onto (corner perm, slice perm) and (UD edge perm, slice perm)
+struct pruneTables
+{
+    static const size_t CORNER_SLICE_SIZE = (size_t)CORNER_PERM_COUNT * SLICE_PERM_COUNT;
+    static const size_t EDGE_SLICE_SIZE = (size_t)UD_EDGE_PERM_COUNT * SLICE_PERM_COUNT;
+
+    nibbleTable flipSliceTwist;             //symmetry->flipSliceTwistIndex(flip, slice, twist)
+    const uint8_t* cornerSlice = nullptr;   //cornerPerm * SLICE_PERM_COUNT + slicePerm
+    const uint8_t* edgeSlice = nullptr;     //udEdgePerm * SLICE_PERM_COUNT + slicePerm
+    const symmetryTables* symmetry = nullptr;
+
+    //Mapped from the table directory on first use, thread safe. Generated and saved there if missing
+    static const pruneTables& get();
+
+    //Returns the breadth first search statistics of each table. 0 threads uses every hardware thread
+    std::vector<bfsStats> generate(const moveTables& moves, int threads = 0);
+    bool load(const std::string& path);
+    void save(const std::string& path) const;
+
+    int phase1Distance(int twist, int flip, int slice) const
+    {
+        return flipSliceTwist.get(phase1Index(twist, flip, slice));
+    }
+
+    int phase2Distance(int cornerPerm, int udEdgePerm, int slicePerm) const
+    {
+        int a = cornerSlice[cornerPerm * SLICE_PERM_COUNT + slicePerm];
+        int b = edgeSlice[udEdgePerm * SLICE_PERM_COUNT + slicePerm];
+        return a > b ? a : b;
+    }
+
+    //Split lookups for the search loops: compute and prefetch every child's entry first, read them afterwards
+    uint32_t phase1Index(int twist, int flip, int slice) const { return symmetry->flipSliceTwistIndex(flip, slice, twist); }
+    int phase1DistanceAt(uint32_t index) const { return flipSliceTwist.get(index); }
+    void prefetchPhase2(int cornerPerm, int udEdgePerm, int slicePerm) const
+    {
+        RUBIK_PREFETCH(cornerSlice + cornerPerm * SLICE_PERM_COUNT + slicePerm);
+        RUBIK_PREFETCH(edgeSlice + udEdgePerm * SLICE_PERM_COUNT + slicePerm);
+    }
+
+private:
+    std::vector<uint8_t> mStorage;
+    tableFile mFile;
+};
@@ -0,0 +1,121 @@
+#include "randomState.h"
+
+#include "coordinates.h"
+
+static uint64_t splitMix(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotateLeft(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+randomStateGenerator::randomStateGenerator(uint64_t seed)
+{
+    for (uint64_t& word : mState)
+        word = splitMix(seed);
+}
+
+uint64_t randomStateGenerator::nextRandom()
+{
+    uint64_t result = rotateLeft(mState[1] * 5, 7) * 9;
+    uint64_t t = mState[1] << 17;
+    mState[2] ^= mState[0];
+    mState[3] ^= mState[1];
+    mState[1] ^= mState[2];
+    mState[0] ^= mState[3];
+    mState[2] ^= t;
+    mState[3] = rotateLeft(mState[3], 45);
+    return result;
+}
+
+//Lemire's multiply-shift with rejection, exactly uniform and almost never divides
+uint32_t randomStateGenerator::below(uint32_t bound)
+{
+    uint64_t product = (nextRandom() >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound)
+    {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold)
+        {
+            product = (nextRandom() >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+cubieCube randomStateGenerator::next()
+{
+    cubieCube cube = cubieCube::solved();
+
+    //Fisher-Yates on the piece bytes, every swap of two different slots flips the permutation parity
+    int cornerParity = 0;
+    for (int i = CORNER_COUNT - 1; i > 0; i--)
+    {
+        int j = (int)below((uint32_t)i + 1);
+        cornerParity ^= j != i;
+        uint8_t piece = cube.corners[i];
+        cube.corners[i] = cube.corners[j];
+        cube.corners[j] = piece;
+    }
+    int edgeParity = 0;
+    for (int i = EDGE_COUNT - 1; i > 0; i--)
+    {
+        int j = (int)below((uint32_t)i + 1);
+        edgeParity ^= j != i;
+        uint8_t piece = cube.edges[i];
+        cube.edges[i] = cube.edges[j];
+        cube.edges[j] = piece;
+    }
+
+    //Swapping the last two edges pairs each edge permutation of the wrong parity with exactly one of the right parity
+    if (cornerParity != edgeParity)
+    {
+        uint8_t piece = cube.edges[EDGE_COUNT - 1];
+        cube.edges[EDGE_COUNT - 1] = cube.edges[EDGE_COUNT - 2];
+        cube.edges[EDGE_COUNT - 2] = piece;
+    }
+
+    //The first 7 twists and 11 flips are free, the last one makes the sum come out right
+    uint32_t twist = below(TWIST_COUNT);
+    int twistSum = 0;
+    for (int i = 0; i < CORNER_COUNT - 1; i++)
+    {
+        int ori = (int)(twist % 3);
+        twist /= 3;
+        twistSum += ori;
+        cube.corners[i] |= (uint8_t)(ori << 4);
+    }
+    cube.corners[CORNER_COUNT - 1] |= (uint8_t)(((3 - twistSum % 3) % 3) << 4);
+
+    uint32_t flip = (uint32_t)(nextRandom() >> 53);
+    int flipSum = 0;
+    for (int i = 0; i < EDGE_COUNT - 1; i++)
+    {
+        int ori = (int)((flip >> i) & 1);
+        flipSum += ori;
+        cube.edges[i] |= (uint8_t)(ori << 4);
+    }
+    cube.edges[EDGE_COUNT - 1] |= (uint8_t)((flipSum & 1) << 4);
+    return cube;
+}
+
+void randomStateGenerator::generate(cubieCube* cubes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        cubes[i] = next();
+}
+
+std::vector<cubieCube> randomStateGenerator::generate(size_t count)
+{
+    std::vector<cubieCube> cubes(count);
+    generate(cubes.data(), count);
+    return cubes;
+}
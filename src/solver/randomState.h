@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "cubieCube.h"
+
+//Uniformly random legal cube states, for benchmarks and load tests
+//Random move sequences are biased towards states near the one they start from; this samples the permutations and
+//orientations directly, then repairs parity and the twist/flip sums, which keeps every one of the 4.3e19 states equally likely
+//The sequence depends only on the seed (xoshiro256**, no std distributions), so it is the same on every platform
+class randomStateGenerator
+{
+public:
+    explicit randomStateGenerator(uint64_t seed);
+
+    cubieCube next();
+
+    //Fills the buffer, several million states per second per thread. Use one generator per thread
+    void generate(cubieCube* cubes, size_t count);
+    std::vector<cubieCube> generate(size_t count);
+
+private:
+    uint64_t nextRandom();
+    uint32_t below(uint32_t bound);
+
+    uint64_t mState[4];
+};
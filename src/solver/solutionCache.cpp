@@ -0,0 +1,196 @@
+#include "solutionCache.h"
+#include <algorithm>
+#include <cstring>
+
+#include "tableFile.h"
+
+canonicalCube canonicalize(const symmetryTables& tables, const cubieCube& cube)
+{
+    canonicalCube best = { cube, 0, false };
+    cubieCube inverse = cube.inverse();
+    for (int inverted = 0; inverted < 2; inverted++)
+    {
+        //Odd symmetries are the even one before them times lr2, so after mirroring once with the slow reflection-aware
+        //multiply, all 96 conjugates are plain rotations the vector multiply handles
+        const cubieCube& source = inverted ? inverse : cube;
+        cubieCube mirrored = symmetryConjugate(tables, 1, source);
+        for (int s = 0; s < SYMMETRY_COUNT; s++)
+        {
+            int rotation = s & ~1;
+            cubieCube left;
+            cubieCube conjugated;
+            multiply(tables.cubes[rotation], (s & 1) ? mirrored : source, left);
+            multiply(left, tables.cubes[tables.inverse[rotation]], conjugated);
+            if (memcmp(&conjugated, &best.cube, sizeof(cubieCube)) < 0)
+                best = { conjugated, s, inverted != 0 };
+        }
+    }
+    return best;
+}
+
+//Keys are canonical under all 48 symmetries and the inverse
+static const uint32_t CACHE_SYMMETRY = 2 * SYMMETRY_COUNT;
+
+static uint64_t keyHash(const cubieCube& cube)
+{
+    uint64_t words[4];
+    memcpy(words, &cube, sizeof(words));
+    uint64_t hash = 0x9E3779B97F4A7C15ull;
+    for (uint64_t word : words)
+    {
+        hash ^= word;
+        hash *= 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 31;
+    }
+    return hash;
+}
+
+solutionCache::solutionCache(size_t capacity)
+{
+    mShardCapacity = std::max<size_t>(1, (capacity + SHARD_COUNT - 1) / SHARD_COUNT);
+    mShards.reset(new cacheShard[SHARD_COUNT]);
+}
+
+bool solutionCache::lookup(const cubieCube& cube, std::vector<uint8_t>& moves, bool& optimal)
+{
+    canonicalCube canonical = canonicalize(mSymmetry, cube);
+    uint64_t hash = keyHash(canonical.cube);
+    cacheShard& shard = mShards[hash % SHARD_COUNT];
+
+    cacheRecord record;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.index.find(hash);
+        if (found == shard.index.end() || shard.records[found->second].key != canonical.cube)
+        {
+            mMisses++;
+            return false;
+        }
+        shard.referenced[found->second] = 1;
+        record = shard.records[found->second];
+    }
+    mHits++;
+
+    //The record solves K = S C S^-1, so S^-1 K S = C is solved by the same moves conjugated with S^-1.
+    //For the inverse, C^-1 = S^-1 K S and C is solved by the inverse of that sequence
+    int back = mSymmetry.inverse[canonical.symmetry];
+    optimal = record.optimal;
+    moves.resize(record.length);
+    for (int i = 0; i < record.length; i++)
+    {
+        if (canonical.inverted)
+            moves[i] = (uint8_t)inverseMove(mSymmetry.moveConj[back][record.moves[record.length - 1 - i]]);
+        else
+            moves[i] = mSymmetry.moveConj[back][record.moves[i]];
+    }
+    return true;
+}
+
+void solutionCache::insert(const cubieCube& cube, const std::vector<uint8_t>& moves, bool optimal)
+{
+    if (moves.size() > (size_t)MAX_CACHED_MOVES)
+        return;
+
+    //Same translation as lookup, the other way round
+    canonicalCube canonical = canonicalize(mSymmetry, cube);
+    cacheRecord record = {};
+    record.key = canonical.cube;
+    record.length = (uint8_t)moves.size();
+    record.optimal = optimal;
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        if (canonical.inverted)
+            record.moves[i] = (uint8_t)inverseMove(mSymmetry.moveConj[canonical.symmetry][moves[moves.size() - 1 - i]]);
+        else
+            record.moves[i] = mSymmetry.moveConj[canonical.symmetry][moves[i]];
+    }
+    store(record, keyHash(record.key));
+}
+
+void solutionCache::store(const cacheRecord& record, uint64_t hash)
+{
+    cacheShard& shard = mShards[hash % SHARD_COUNT];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.index.find(hash);
+    if (found != shard.index.end())
+    {
+        //A different key with the same 64-bit hash is simply replaced
+        cacheRecord& existing = shard.records[found->second];
+        if (existing.key != record.key || record.length < existing.length
+            || (record.length == existing.length && record.optimal && !existing.optimal))
+            existing = record;
+        return;
+    }
+
+    if (shard.records.size() < mShardCapacity)
+    {
+        shard.index[hash] = (uint32_t)shard.records.size();
+        shard.records.push_back(record);
+        shard.referenced.push_back(0);
+        return;
+    }
+
+    while (shard.referenced[shard.hand])
+    {
+        shard.referenced[shard.hand] = 0;
+        shard.hand = (shard.hand + 1) % shard.records.size();
+    }
+    shard.index.erase(keyHash(shard.records[shard.hand].key));
+    shard.index[hash] = (uint32_t)shard.hand;
+    shard.records[shard.hand] = record;
+    shard.hand = (shard.hand + 1) % shard.records.size();
+}
+
+size_t solutionCache::size()
+{
+    size_t total = 0;
+    for (int i = 0; i < SHARD_COUNT; i++)
+    {
+        std::lock_guard<std::mutex> lock(mShards[i].mutex);
+        total += mShards[i].records.size();
+    }
+    return total;
+}
+
+bool solutionCache::load(const std::string& path)
+{
+    tableFile file;
+    if (!file.open(path, tableScheme::solutionCache, sizeof(cacheRecord), CACHE_SYMMETRY))
+        return false;
+
+    const uint8_t* countData = file.section("count", sizeof(uint64_t));
+    if (countData == nullptr)
+        return false;
+    uint64_t count;
+    memcpy(&count, countData, sizeof(count));
+
+    const uint8_t* data = file.section("records", count * sizeof(cacheRecord));
+    if (data == nullptr || !file.verifyAll())
+        return false;
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        cacheRecord record;
+        memcpy(&record, data + i * sizeof(cacheRecord), sizeof(cacheRecord));
+        if (record.length <= MAX_CACHED_MOVES && record.key.verify() == 0)
+            store(record, keyHash(record.key));
+    }
+    return true;
+}
+
+void solutionCache::save(const std::string& path)
+{
+    std::vector<cacheRecord> records;
+    for (int i = 0; i < SHARD_COUNT; i++)
+    {
+        std::lock_guard<std::mutex> lock(mShards[i].mutex);
+        records.insert(records.end(), mShards[i].records.begin(), mShards[i].records.end());
+    }
+
+    uint64_t count = records.size();
+    tableWriter writer(tableScheme::solutionCache, sizeof(cacheRecord), CACHE_SYMMETRY);
+    writer.addSection("count", &count, sizeof(count));
+    writer.addSection("records", records.data(), count * sizeof(cacheRecord));
+    writer.write(path);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "symmetry.h"
+
+const int MAX_CACHED_MOVES = 31;
+
+//Canonical form of a cube: the smallest of its 48 symmetry conjugates and theirs of its inverse. Rotated or recolored copies of
+//a scramble, and its inverse, all share one canonical cube
+struct canonicalCube
+{
+    cubieCube cube;
+    int symmetry;       //cube = S C S^-1, or S C^-1 S^-1 when inverted
+    bool inverted;
+};
+
+canonicalCube canonicalize(const symmetryTables& tables, const cubieCube& cube);
+
+//Concurrent solution cache keyed by the canonical cube, so a repeated scramble costs one canonicalization and one hash lookup
+//Split into lock-striped shards by key hash. A full shard evicts with the CLOCK algorithm: hits mark an entry, the hand clears marks
+//and replaces the first unmarked entry, which approximates LRU without touching shared state on every hit
+class solutionCache
+{
+public:
+    explicit solutionCache(size_t capacity);
+
+    //Moves solving this exact cube, translated back from the canonical entry, and whether they were proven optimal
+    bool lookup(const cubieCube& cube, std::vector<uint8_t>& moves, bool& optimal);
+
+    //Keeps the shorter solution if the cube is cached already, or the optimal one of two equally long. Solutions over
+    //MAX_CACHED_MOVES are not cached
+    void insert(const cubieCube& cube, const std::vector<uint8_t>& moves, bool optimal);
+
+    //Snapshot in the table file format. load returns false (and keeps the cache as it is) if the file is missing or damaged
+    bool load(const std::string& path);
+    void save(const std::string& path);
+
+    size_t size();
+    size_t capacity() const { return mShardCapacity * SHARD_COUNT; }
+    uint64_t hits() const { return mHits; }
+    uint64_t misses() const { return mMisses; }
+
+private:
+    static const int SHARD_COUNT = 64;
+
+    //64 bytes, also the snapshot record. The optimal flag takes the top bit of the length byte, which is clear in snapshots
+    //written before it existed
+    struct cacheRecord
+    {
+        cubieCube key;
+        uint8_t length : 7;
+        uint8_t optimal : 1;
+        uint8_t moves[MAX_CACHED_MOVES];
+    };
+
+    struct cacheShard
+    {
+        std::mutex mutex;
+        std::vector<cacheRecord> records;
+        std::vector<uint8_t> referenced;
+        std::unordered_map<uint64_t, uint32_t> index;
+        size_t hand = 0;
+    };
+
+    void store(const cacheRecord& record, uint64_t hash);
+
+    const symmetryTables& mSymmetry = symmetryTables::get();
+    size_t mShardCapacity;
+    std::unique_ptr<cacheShard[]> mShards;
+    std::atomic<uint64_t> mHits{0};
+    std::atomic<uint64_t> mMisses{0};
+};
@@ -0,0 +1,179 @@
+#include "solutionOptimizer.h"
+#include <cstring>
+#include <stdexcept>
+
+bool parseMoveMetric(const std::string& name, moveMetric& metric)
+{
+    if (name == "htm")
+        metric = moveMetric::htm;
+    else if (name == "qtm")
+        metric = moveMetric::qtm;
+    else if (name == "stm")
+        metric = moveMetric::stm;
+    else if (name == "execution")
+        metric = moveMetric::execution;
+    else
+        return false;
+    return true;
+}
+
+solutionOptimizer::solutionOptimizer(moveMetric metric, int layers, const executionModel& model) : mMetric(metric), mLayers(layers), mModel(model)
+{
+    if (layers < 1 || layers > 4)
+        throw std::runtime_error("Layer count is out of range!");
+
+    memset(mMoveOf, 0, sizeof(mMoveOf));
+    for (int move = 0; move < 18 * layers; move++)
+    {
+        int face = move / 3 / layers;
+        mAxis[move] = (uint8_t)(face % 3);
+        mLayer[move] = (uint8_t)(face / 3 * layers + move / 3 % layers);
+        mMoveOf[mAxis[move]][mLayer[move]][move % 3 + 1] = (uint8_t)move;
+    }
+}
+
+double solutionOptimizer::turnSeconds(int move) const
+{
+    int face = move / 3 / mLayers;
+    double seconds = mModel.quarterTurn[face];
+    if (move / 3 % mLayers != 0)
+        seconds *= mModel.innerLayerFactor;
+    if (move % 3 == 1)
+        seconds *= mModel.halfTurnFactor;
+    return seconds;
+}
+
+double solutionOptimizer::transitionSeconds(int from, int to) const
+{
+    int fromFace = from / 3 / mLayers;
+    int toFace = to / 3 / mLayers;
+    if (fromFace % 3 == toFace % 3)
+        return 0.0;
+    if ((fromFace == FACE_U && toFace == FACE_R) || (fromFace == FACE_R && toFace == FACE_U))
+        return 0.0;
+    return mModel.regrip;
+}
+
+std::vector<uint8_t> solutionOptimizer::optimize(const std::vector<uint8_t>& moves) const
+{
+    //Runs on a stack, so a run that cancels out exposes the one before it to the next move
+    std::vector<axisRun> runs;
+    runs.reserve(moves.size());
+    for (uint8_t move : moves)
+    {
+        int axis = axisOf(move);
+        if (runs.empty() || runs.back().axis != axis)
+            runs.push_back(axisRun{ axis, {} });
+
+        axisRun& run = runs.back();
+        int layer = layerOf(move);
+        run.turns[layer] = (int8_t)((run.turns[layer] + move % 3 + 1) % 4);
+        bool cancelled = true;
+        for (int i = 0; i < 2 * mLayers; i++)
+            cancelled &= run.turns[i] == 0;
+        if (cancelled)
+            runs.pop_back();
+    }
+
+    //Each run is turned from its face's outer layer inwards (order 0) or the other way round (order 1). The time of a run
+    //only depends on the order through its first and last turn, so the best orders follow from one pass over the runs
+    std::vector<uint8_t> order(runs.size(), 0);
+    if (mMetric == moveMetric::execution && !runs.empty())
+    {
+        auto end = [&](const axisRun& run, bool last)
+        {
+            int layer = last ? 2 * mLayers - 1 : 0;
+            int step = last ? -1 : 1;
+            while (run.turns[layer] == 0)
+                layer += step;
+            return moveOf(run.axis, layer, run.turns[layer]);
+        };
+
+        std::vector<uint8_t> previousOrder(2 * runs.size(), 0);
+        double seconds[2] = { 0.0, 0.0 };
+        int lastMove[2] = { end(runs[0], true), end(runs[0], false) };
+        for (size_t i = 1; i < runs.size(); i++)
+        {
+            int firstMove[2] = { end(runs[i], false), end(runs[i], true) };
+            double nextSeconds[2];
+            for (int o = 0; o < 2; o++)
+            {
+                double viaZero = seconds[0] + transitionSeconds(lastMove[0], firstMove[o]);
+                double viaOne = seconds[1] + transitionSeconds(lastMove[1], firstMove[o]);
+                previousOrder[2 * i + o] = viaOne < viaZero;
+                nextSeconds[o] = viaOne < viaZero ? viaOne : viaZero;
+            }
+            seconds[0] = nextSeconds[0];
+            seconds[1] = nextSeconds[1];
+            lastMove[0] = end(runs[i], true);
+            lastMove[1] = end(runs[i], false);
+        }
+
+        uint8_t o = seconds[1] < seconds[0];
+        for (size_t i = runs.size(); i-- > 0;)
+        {
+            order[i] = o;
+            o = previousOrder[2 * i + o];
+        }
+    }
+
+    std::vector<uint8_t> optimized;
+    optimized.reserve(moves.size());
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        for (int k = 0; k < 2 * mLayers; k++)
+        {
+            int layer = order[i] ? 2 * mLayers - 1 - k : k;
+            if (runs[i].turns[layer] != 0)
+                optimized.push_back((uint8_t)moveOf(runs[i].axis, layer, runs[i].turns[layer]));
+        }
+    }
+    return optimized;
+}
+
+double solutionOptimizer::cost(const std::vector<uint8_t>& moves) const
+{
+    //Stm: outer turns of the current axis not yet paired into a slice turn, per side and power
+    int unpaired[2][4] = {};
+    double total = 0.0;
+    for (size_t i = 0; i < moves.size(); i++)
+    {
+        int move = moves[i];
+        switch (mMetric)
+        {
+        case moveMetric::htm:
+            total += 1.0;
+            break;
+        case moveMetric::qtm:
+            total += move % 3 == 1 ? 2.0 : 1.0;
+            break;
+        case moveMetric::stm:
+        {
+            if (i > 0 && axisOf(moves[i - 1]) != axisOf(move))
+                memset(unpaired, 0, sizeof(unpaired));
+            int layer = layerOf(move);
+            if (layer % mLayers != 0)
+            {
+                total += 1.0;
+                break;
+            }
+            int side = layer / mLayers;
+            int power = move % 3 + 1;
+            if (unpaired[1 - side][4 - power] > 0)
+                unpaired[1 - side][4 - power]--;
+            else
+            {
+                unpaired[side][power]++;
+                total += 1.0;
+            }
+            break;
+        }
+        case moveMetric::execution:
+            total += turnSeconds(move);
+            if (i > 0)
+                total += transitionSeconds(moves[i - 1], move);
+            break;
+        }
+    }
+    return total;
+}
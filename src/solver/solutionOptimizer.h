@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cubieCube.h"
+
+//What a solution is measured in
+//  htm: every turn counts 1, qtm: half turns count 2, stm: as htm, except that opposite outer turns meeting as a slice
+//  turn (U D', R2 L2) count 1 together, execution: seconds under an executionModel
+enum class moveMetric : uint8_t
+{
+    htm,
+    qtm,
+    stm,
+    execution
+};
+
+//"htm", "qtm", "stm" or "execution", false for anything else
+bool parseMoveMetric(const std::string& name, moveMetric& metric);
+
+//Rough finger trick timing of a hand solve, in seconds. Turns of R and U are the fastest, B the slowest, and a turn on a new
+//axis costs a regrip unless it is the R and U pair the grip is made for
+struct executionModel
+{
+    float quarterTurn[6] = { 0.10f, 0.10f, 0.16f, 0.13f, 0.12f, 0.22f };    //URFDLB
+    float halfTurnFactor = 1.6f;
+    float innerLayerFactor = 1.3f;      //Big cubes: a turn of an inner layer
+    float regrip = 0.05f;
+};
+
+//Rewrites a solution into an equivalent one that is never longer in htm, qtm or stm, in well under a microsecond per move
+//Turns of one axis commute, so a run of them reduces to one net turn per layer; a run whose turns all cancel vanishes, which
+//lets the runs on both sides of it merge, and so on. The result has no two runs of the same axis in a row and at most one
+//turn per layer in a run, which is as short as cancellation and commutation can get in htm, qtm and stm alike. Only the
+//order of the turns inside a run is left free: the execution metric picks it over the whole solution to save regrips
+//Works on cubieCube moves and, with layers > 1, on bigCube moves of a size with that many layers per face
+class solutionOptimizer
+{
+public:
+    explicit solutionOptimizer(moveMetric metric = moveMetric::htm, int layers = 1, const executionModel& model = executionModel());
+
+    std::vector<uint8_t> optimize(const std::vector<uint8_t>& moves) const;
+
+    //The solution's length in the optimizer's metric
+    double cost(const std::vector<uint8_t>& moves) const;
+
+private:
+    struct axisRun
+    {
+        int axis;
+        int8_t turns[8];    //Net quarter turns mod 4 per layer, the face's layers from the outside in then the opposite face's
+    };
+
+    static const int MAX_MOVES = 72;    //18 per layer of a 7x7x7 face
+
+    int axisOf(int move) const { return mAxis[move]; }
+    int layerOf(int move) const { return mLayer[move]; }
+    int moveOf(int axis, int layer, int turns) const { return mMoveOf[axis][layer][turns]; }
+
+    double turnSeconds(int move) const;
+    double transitionSeconds(int from, int to) const;
+
+    moveMetric mMetric;
+    int mLayers;
+    executionModel mModel;
+
+    //Lookups instead of divisions by the layer count
+    uint8_t mAxis[MAX_MOVES];
+    uint8_t mLayer[MAX_MOVES];
+    uint8_t mMoveOf[3][8][4];
+};
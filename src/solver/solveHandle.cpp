@@ -0,0 +1,69 @@
+#include "solveHandle.h"
+
+solveHandle::solveHandle(solutionCallback onSolution) : mOnSolution(std::move(onSolution)), mStartTime(std::chrono::steady_clock::now())
+{
+}
+
+solveHandle::~solveHandle()
+{
+    cancel();
+    if (mThread.joinable())
+        mThread.join();
+    delete mLatest.exchange(nullptr);
+}
+
+void solveHandle::start(std::function<solverResult()> search)
+{
+    mStartTime = std::chrono::steady_clock::now();
+    mThread = std::thread([this, search]()
+    {
+        solverResult result;
+        try
+        {
+            result = search();
+        }
+        catch (const std::exception&)
+        {
+            //Nothing to report beyond found = false, the cube was checked before the search started
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFinal = result;
+        mFinished = true;
+        mDone.notify_all();
+    });
+}
+
+void solveHandle::publish(const solverResult& result)
+{
+    delete mLatest.exchange(new solverResult(result));
+    if (mOnSolution)
+        mOnSolution(result);
+}
+
+bool solveHandle::poll(solverResult& result)
+{
+    std::unique_ptr<solverResult> latest(mLatest.exchange(nullptr));
+    if (!latest)
+        return false;
+    result = std::move(*latest);
+    return true;
+}
+
+solverResult solveHandle::wait()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDone.wait(lock, [this]() { return mFinished.load(); });
+    return mFinal;
+}
+
+double solveHandle::seconds() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count();
+}
+
+double solveHandle::nodesPerSecond() const
+{
+    double elapsed = seconds();
+    return elapsed > 0.0 ? nodes() / elapsed : 0.0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "solverResult.h"
+
+//A search running on its own thread, reporting every improvement as it is found
+//Each solution is shorter than the one before. poll never blocks (the search side only swaps a pointer), so a render
+//loop can call it once per frame; the optional callback runs on a search thread right after the solution is found
+//Destroying the handle cancels the search and waits for it
+class solveHandle
+{
+public:
+    using solutionCallback = std::function<void(const solverResult&)>;
+
+    explicit solveHandle(solutionCallback onSolution = nullptr);
+    ~solveHandle();
+    solveHandle(const solveHandle&) = delete;
+    solveHandle& operator=(const solveHandle&) = delete;
+
+    //Cooperative, the search notices within a few thousand nodes and finishes with the best solution so far
+    void cancel() { mCancelled = true; }
+    bool cancelled() const { return mCancelled; }
+    bool finished() const { return mFinished; }
+
+    //Takes the newest solution not taken yet, older unread ones are dropped. Returns false if there is none
+    bool poll(solverResult& result);
+
+    //Blocks until the search ends. The final result is the shortest solution, or found = false if it was stopped before one
+    solverResult wait();
+
+    //Progress, updated every few thousand nodes
+    uint64_t nodes() const { return mNodes.load(std::memory_order_relaxed); }
+    double seconds() const;
+    double nodesPerSecond() const;
+
+    //Search side
+    void start(std::function<solverResult()> search);
+    void publish(const solverResult& result);
+    void reportNodes(uint64_t nodes) { mNodes.store(nodes, std::memory_order_relaxed); }
+
+private:
+    solutionCallback mOnSolution;
+    std::atomic<solverResult*> mLatest{nullptr};
+    std::atomic<bool> mCancelled{false};
+    std::atomic<bool> mFinished{false};
+    std::atomic<uint64_t> mNodes{0};
+    std::chrono::steady_clock::time_point mStartTime;
+
+    std::mutex mMutex;
+    std::condition_variable mDone;
+    solverResult mFinal;
+    std::thread mThread;
+};
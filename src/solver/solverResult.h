@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+//Builds with RUBIK_SOLVER_STATS=1 (the benchmark) count the pruning values each search looks up
+#ifndef RUBIK_SOLVER_STATS
+    #define RUBIK_SOLVER_STATS 0
+#endif
+
+const int PRUNE_HIT_VALUES = 16;
+
+//What every solver engine returns
+struct solverResult
+{
+    std::vector<uint8_t> moves;
+    bool found = false;
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+
+    //Lookups per pruning value: row 0 is phase 1 (or the only heuristic), row 1 phase 2. All zero without RUBIK_SOLVER_STATS
+    uint64_t pruneHits[2][PRUNE_HIT_VALUES] = {};
+};
+
+//What every solver engine accepts. Engines without a search to cut short (thistlethwaite) ignore the lengths and limits
+struct solverOptions
+{
+    int maxLength = 24;             //Never return a longer solution
+    int targetLength = 20;          //Stop as soon as a solution this short is found
+    double timeLimitSeconds = 0.1;  //Keep looking for shorter solutions until this runs out
+    int threads = 0;                //0 uses every hardware thread
+
+    //Hard limits, the search ends at either of them even without a solution
+    uint64_t nodeLimit = 0;         //0 for no budget, checked every few thousand nodes
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+};
+
+//twoPhase finds near optimal solutions from about 100 MB of tables. thistlethwaite needs about 1 MB and answers within a
+//fixed number of lookups, with solutions about half again as long, for devices that cannot hold the two-phase tables
+enum class solverEngine : uint8_t
+{
+    twoPhase,
+    thistlethwaite
+};
+
+//"twophase" or "thistlethwaite", false for anything else
+inline bool parseSolverEngine(const std::string& name, solverEngine& engine)
+{
+    if (name == "twophase")
+        engine = solverEngine::twoPhase;
+    else if (name == "thistlethwaite")
+        engine = solverEngine::thistlethwaite;
+    else
+        return false;
+    return true;
+}
+
+//RUBIK_SOLVER_ENGINE from the environment, twoPhase if it is unset or unknown
+inline solverEngine defaultSolverEngine()
+{
+    solverEngine engine = solverEngine::twoPhase;
+    const char* name = std::getenv("RUBIK_SOLVER_ENGINE");
+    if (name != nullptr)
+        parseSolverEngine(name, engine);
+    return engine;
+}
@@ -0,0 +1,223 @@
+#include "symmetry.h"
+#include <memory>
+#include <stdexcept>
+
+#include "tableFile.h"
+
+static cubieCube makeBasic(const uint8_t* cornerPerm, const uint8_t* cornerOri, const uint8_t* edgePerm, const uint8_t* edgeOri)
+{
+    cubieCube cube = cubieCube::solved();
+    for (int i = 0; i < CORNER_COUNT; i++)
+        cube.setCorner(i, cornerPerm[i], cornerOri[i]);
+    for (int i = 0; i < EDGE_COUNT; i++)
+        cube.setEdge(i, edgePerm[i], edgeOri[i]);
+    return cube;
+}
+
+void symmetryMultiply(const cubieCube& a, const cubieCube& b, cubieCube& c)
+{
+    cubieCube r;
+    for (int i = 0; i < 16; i++)
+    {
+        int from = b.corners[i] & 0x0F;
+        int oriA = a.corners[from] >> 4;
+        int oriB = b.corners[i] >> 4;
+        int ori;
+        if (oriA < 3 && oriB < 3)
+            ori = (oriA + oriB) % 3;
+        else if (oriA < 3)
+            ori = oriA + oriB >= 6 ? oriA + oriB - 3 : oriA + oriB;
+        else if (oriB < 3)
+            ori = oriA - oriB < 3 ? oriA - oriB + 3 : oriA - oriB;
+        else
+            ori = oriA - oriB < 0 ? oriA - oriB + 3 : oriA - oriB;
+        r.corners[i] = (uint8_t)((a.corners[from] & 0x0F) | (ori << 4));
+
+        int edgeFrom = b.edges[i] & 0x0F;
+        r.edges[i] = (uint8_t)((a.edges[edgeFrom] & 0x0F) | ((((a.edges[edgeFrom] ^ b.edges[i]) >> 4) & 1) << 4));
+    }
+    c = r;
+}
+
+//S C S^-1
+cubieCube symmetryConjugate(const symmetryTables& tables, int symmetry, const cubieCube& cube)
+{
+    cubieCube left;
+    cubieCube result;
+    symmetryMultiply(tables.cubes[symmetry], cube, left);
+    symmetryMultiply(left, tables.cubes[tables.inverse[symmetry]], result);
+    return result;
+}
+
+//Walks the coordinate in increasing order, so every representative is the smallest member of its class
+template <typename Class, typename Rep>
+static int buildClasses(const symmetryTables& tables, int count, void (*setter)(cubieCube&, int), int (*getter)(const cubieCube&),
+                        Class* classOf, uint8_t* symOf, Rep* reps, uint16_t* self, int classLimit)
+{
+    const Class UNASSIGNED = (Class)~0u;
+    for (int i = 0; i < count; i++)
+        classOf[i] = UNASSIGNED;
+
+    int classes = 0;
+    for (int coord = 0; coord < count; coord++)
+    {
+        if (classOf[coord] != UNASSIGNED)
+            continue;
+        if (classes == classLimit)
+            throw std::runtime_error("Too many symmetry classes!");
+
+        classOf[coord] = (Class)classes;
+        symOf[coord] = 0;
+        reps[classes] = (Rep)coord;
+        self[classes] = 0;
+
+        cubieCube cube = cubieCube::solved();
+        setter(cube, coord);
+        for (int s = 0; s < UD_SYMMETRY_COUNT; s++)
+        {
+            //S^-1 C S, which symmetry s carries back onto the representative
+            int other = getter(symmetryConjugate(tables, tables.inverse[s], cube));
+            if (other == coord)
+                self[classes] |= (uint16_t)(1 << s);
+            if (classOf[other] == UNASSIGNED)
+            {
+                classOf[other] = (Class)classes;
+                symOf[other] = (uint8_t)s;
+            }
+        }
+        classes++;
+    }
+    return classes;
+}
+
+static void setFlipSlice(cubieCube& cube, int flipSlice)
+{
+    setSlice(cube, flipSlice / FLIP_COUNT);
+    setFlip(cube, flipSlice % FLIP_COUNT);
+}
+
+static int getFlipSlice(const cubieCube& cube)
+{
+    return getSlice(cube) * FLIP_COUNT + getFlip(cube);
+}
+
+void symmetryTables::generate()
+{
+    static const uint8_t urf3Corners[CORNER_COUNT] = { URF, DFR, DLF, UFL, UBR, DRB, DBL, ULB };
+    static const uint8_t urf3CornerOri[CORNER_COUNT] = { 1, 2, 1, 2, 2, 1, 2, 1 };
+    static const uint8_t urf3Edges[EDGE_COUNT] = { UF, FR, DF, FL, UB, BR, DB, BL, UR, DR, DL, UL };
+    static const uint8_t urf3EdgeOri[EDGE_COUNT] = { 1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1 };
+    static const uint8_t f2Corners[CORNER_COUNT] = { DLF, DFR, DRB, DBL, UFL, URF, UBR, ULB };
+    static const uint8_t f2Edges[EDGE_COUNT] = { DL, DF, DR, DB, UL, UF, UR, UB, FL, FR, BR, BL };
+    static const uint8_t u4Corners[CORNER_COUNT] = { UBR, URF, UFL, ULB, DRB, DFR, DLF, DBL };
+    static const uint8_t u4Edges[EDGE_COUNT] = { UB, UR, UF, UL, DB, DR, DF, DL, BR, FR, FL, BL };
+    static const uint8_t u4EdgeOri[EDGE_COUNT] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1 };
+    static const uint8_t lr2Corners[CORNER_COUNT] = { UFL, URF, UBR, ULB, DLF, DFR, DRB, DBL };
+    static const uint8_t lr2CornerOri[CORNER_COUNT] = { 3, 3, 3, 3, 3, 3, 3, 3 };
+    static const uint8_t lr2Edges[EDGE_COUNT] = { UL, UF, UR, UB, DL, DF, DR, DB, FL, FR, BR, BL };
+    static const uint8_t zeros[EDGE_COUNT] = {};
+
+    const cubieCube urf3 = makeBasic(urf3Corners, urf3CornerOri, urf3Edges, urf3EdgeOri);
+    const cubieCube f2 = makeBasic(f2Corners, zeros, f2Edges, zeros);
+    const cubieCube u4 = makeBasic(u4Corners, zeros, u4Edges, u4EdgeOri);
+    const cubieCube lr2 = makeBasic(lr2Corners, lr2CornerOri, lr2Edges, zeros);
+
+    cubieCube current = cubieCube::solved();
+    int index = 0;
+    for (int a = 0; a < 3; a++)
+    {
+        for (int b = 0; b < 2; b++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                for (int d = 0; d < 2; d++)
+                {
+                    cubes[index++] = current;
+                    symmetryMultiply(current, lr2, current);
+                }
+                symmetryMultiply(current, u4, current);
+            }
+            symmetryMultiply(current, f2, current);
+        }
+        symmetryMultiply(current, urf3, current);
+    }
+
+    for (int i = 0; i < SYMMETRY_COUNT; i++)
+    {
+        for (int j = 0; j < SYMMETRY_COUNT; j++)
+        {
+            cubieCube product;
+            symmetryMultiply(cubes[i], cubes[j], product);
+            if (product == cubieCube::solved())
+                inverse[i] = (uint8_t)j;
+        }
+    }
+
+    //Conjugating a face turn by a reflection gives the opposite direction turn of the mirrored face, so moves map onto moves
+    for (int s = 0; s < SYMMETRY_COUNT; s++)
+    {
+        for (int m = 0; m < MOVE_COUNT; m++)
+        {
+            cubieCube conjugated = symmetryConjugate(*this, s, cubieCube::moveCube(m));
+            int found = -1;
+            for (int candidate = 0; candidate < MOVE_COUNT && found < 0; candidate++)
+                if (cubieCube::moveCube(candidate) == conjugated)
+                    found = candidate;
+            if (found < 0)
+                throw std::runtime_error("Symmetry does not map moves to moves!");
+            moveConj[s][m] = (uint8_t)found;
+        }
+    }
+
+    for (int t = 0; t < TWIST_COUNT; t++)
+    {
+        cubieCube cube = cubieCube::solved();
+        setTwist(cube, t);
+        for (int s = 0; s < UD_SYMMETRY_COUNT; s++)
+            twistConj[t][s] = (uint16_t)getTwist(symmetryConjugate(*this, s, cube));
+    }
+
+    if (buildClasses(*this, FLIP_SLICE_COUNT, setFlipSlice, getFlipSlice, flipSliceClass, flipSliceSym, flipSliceRep, flipSliceSelf,
+                     FLIP_SLICE_CLASS_COUNT) != FLIP_SLICE_CLASS_COUNT)
+        throw std::runtime_error("Unexpected number of symmetry classes!");
+}
+
+//Either a view into the mapped table file or a freshly generated copy on the heap (about 3.5 MB)
+struct symmetryTableStore
+{
+    tableFile file;
+    std::unique_ptr<symmetryTables> generated;
+    const symmetryTables* tables = nullptr;
+
+    symmetryTableStore()
+    {
+        std::string path = tableDirectory() + "/symmetry.tbl";
+        if (file.open(path, tableScheme::symmetryClasses, sizeof(symmetryTables), UD_SYMMETRY_COUNT))
+            tables = reinterpret_cast<const symmetryTables*>(file.section("symmetry", sizeof(symmetryTables)));
+        if (tables != nullptr)
+        {
+            file.verifyInBackground();
+            return;
+        }
+
+        generated.reset(new symmetryTables());
+        generated->generate();
+        tables = generated.get();
+        try
+        {
+            tableWriter writer(tableScheme::symmetryClasses, sizeof(symmetryTables), UD_SYMMETRY_COUNT);
+            writer.addSection("symmetry", tables, sizeof(symmetryTables));
+            writer.write(path);
+        }
+        catch (const std::exception&)
+        {
+            //A read-only table directory only costs regenerating next launch
+        }
+    }
+};
+
+const symmetryTables& symmetryTables::get()
+{
+    static const symmetryTableStore store;
+    return *store.tables;
+}
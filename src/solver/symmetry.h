@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+#include "coordinates.h"
+
+//The 48 symmetries of the cube, numbered 16 * urf3 + 8 * f2 + 2 * u4 + lr2 from the basic symmetries below
+//urf3: 120 degree rotation around the URF-DBL diagonal, f2: 180 degrees around the FB axis, u4: 90 degrees around the UD axis,
+//lr2: reflection in the plane between L and R. The first 16 (urf3 = 0) keep the UD axis in place, so they map G1 onto itself
+const int SYMMETRY_COUNT = 48;
+const int UD_SYMMETRY_COUNT = 16;
+
+const int FLIP_SLICE_COUNT = SLICE_COUNT * FLIP_COUNT;    //slice * FLIP_COUNT + flip
+const int FLIP_SLICE_CLASS_COUNT = 64430;                 //Classes of flip-slice under the UD symmetries
+
+//Conjugation tables and symmetry classes. A coordinate x belongs to class classOf[x] and S x S^-1 is the class representative,
+//with S the symmetry symOf[x]. A pruning table over (class, other coordinate) is then indexed with the other coordinate
+//conjugated by the same S, which cuts its size by almost 16 since every state of a class shares one distance
+//Representatives fixed by some symmetries (selfSymmetries, bit s for symmetry s) stand for several entries of such a table;
+//table generators have to fill all of them. The pattern database builds its own classes, with inversion for the corners and
+//the symmetries that keep its edge set for the edges
+struct symmetryTables
+{
+    cubieCube cubes[SYMMETRY_COUNT];    //Corner orientations 3..5 mark the mirrored corners of reflections
+    uint8_t inverse[SYMMETRY_COUNT];
+    uint8_t moveConj[SYMMETRY_COUNT][MOVE_COUNT];           //S m S^-1 as a move
+    uint16_t twistConj[TWIST_COUNT][UD_SYMMETRY_COUNT];     //Twist of S C S^-1
+
+    uint16_t flipSliceClass[FLIP_SLICE_COUNT];
+    uint8_t flipSliceSym[FLIP_SLICE_COUNT];
+    uint32_t flipSliceRep[FLIP_SLICE_CLASS_COUNT];
+    uint16_t flipSliceSelf[FLIP_SLICE_CLASS_COUNT];
+
+    //Mapped from the table directory on first use, thread safe. Generated (about a second) and saved there if missing
+    static const symmetryTables& get();
+
+    void generate();
+
+    //Index into a (flip-slice class, twist) table, the symmetry-reduced phase 1 projection
+    uint32_t flipSliceTwistIndex(int flip, int slice, int twist) const
+    {
+        int flipSlice = slice * FLIP_COUNT + flip;
+        return (uint32_t)flipSliceClass[flipSlice] * TWIST_COUNT + twistConj[twist][flipSliceSym[flipSlice]];
+    }
+};
+
+const uint64_t FLIP_SLICE_TWIST_COUNT = (uint64_t)FLIP_SLICE_CLASS_COUNT * TWIST_COUNT;
+
+//c = a * b for cubes that may be reflections, whose corner orientations 3..5 count twists the other way round
+void symmetryMultiply(const cubieCube& a, const cubieCube& b, cubieCube& c);
+
+//S C S^-1 for symmetry S, a legal cube again even when S is a reflection
+cubieCube symmetryConjugate(const symmetryTables& tables, int symmetry, const cubieCube& cube);
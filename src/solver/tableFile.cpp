@@ -0,0 +1,327 @@
+#include "tableFile.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__linux__)
+    #include <sched.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#elif defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#endif
+
+static const char TABLE_MAGIC[8] = { 'R', 'R', 'T', 'A', 'B', 'L', 'E', '\0' };
+static const uint64_t SECTION_ALIGNMENT = 4096;
+static const uint32_t MAX_SECTIONS = 64;
+
+//Set by a background verification that found a damaged chunk, for every table of the process
+static std::atomic<bool> sDamagedTable{false};
+
+static inline uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+std::string tableDirectory()
+{
+    const char* directory = std::getenv("RUBIK_TABLE_DIR");
+    return directory != nullptr && directory[0] != '\0' ? directory : "tables";
+}
+
+mapOptions tableMapOptions()
+{
+    mapOptions options;
+    const char* populate = std::getenv("RUBIK_TABLE_POPULATE");
+    const char* hugePages = std::getenv("RUBIK_TABLE_HUGEPAGES");
+    options.populate = populate != nullptr && strcmp(populate, "1") == 0;
+    options.hugePages = hugePages != nullptr && strcmp(hugePages, "1") == 0;
+    return options;
+}
+
+//64-bit multiply-rotate hash over 8 byte words, several GB/s and good enough to catch torn writes and bit rot
+uint64_t tableChecksum(const uint8_t* data, size_t size)
+{
+    const uint64_t prime1 = 0x9E3779B185EBCA87ull;
+    const uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+    uint64_t hash = prime1 ^ (uint64_t)size;
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash ^= word * prime2;
+        hash = ((hash << 31) | (hash >> 33)) * prime1;
+    }
+    for (; i < size; i++)
+    {
+        hash ^= data[i] * prime1;
+        hash = ((hash << 11) | (hash >> 53)) * prime2;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+void requireIntactTables()
+{
+    if (sDamagedTable.load(std::memory_order_relaxed))
+        throw std::runtime_error("A table file is damaged and was deleted, restart to rebuild it!");
+}
+
+//Checksum of header (with its checksum field zeroed), directory and chunk checksums
+static uint64_t headerChecksum(tableFileHeader header, const tableSectionEntry* sections, const uint64_t* chunks, size_t chunkCount)
+{
+    header.headerChecksum = 0;
+    std::vector<uint8_t> bytes(sizeof(header) + header.sectionCount * sizeof(tableSectionEntry) + chunkCount * sizeof(uint64_t));
+    memcpy(bytes.data(), &header, sizeof(header));
+    memcpy(bytes.data() + sizeof(header), sections, header.sectionCount * sizeof(tableSectionEntry));
+    memcpy(bytes.data() + sizeof(header) + header.sectionCount * sizeof(tableSectionEntry), chunks, chunkCount * sizeof(uint64_t));
+    return tableChecksum(bytes.data(), bytes.size());
+}
+
+tableWriter::tableWriter(tableScheme scheme, uint64_t parameter, uint32_t symmetry) : mScheme(scheme), mParameter(parameter), mSymmetry(symmetry)
+{
+}
+
+void tableWriter::addSection(const char* name, const void* data, uint64_t size)
+{
+    if (strlen(name) >= sizeof(tableSectionEntry::name) || mSections.size() >= MAX_SECTIONS)
+        throw std::runtime_error("Invalid table section!");
+    mSections.push_back({ name, static_cast<const uint8_t*>(data), size });
+}
+
+void tableWriter::write(const std::string& path) const
+{
+    std::vector<tableSectionEntry> directory(mSections.size());
+    uint64_t payloadSize = 0;
+    for (size_t i = 0; i < mSections.size(); i++)
+    {
+        memset(&directory[i], 0, sizeof(tableSectionEntry));
+        strcpy(directory[i].name, mSections[i].name.c_str());
+        directory[i].offset = alignUp(payloadSize, SECTION_ALIGNMENT);
+        directory[i].size = mSections[i].size;
+        payloadSize = directory[i].offset + directory[i].size;
+    }
+
+    size_t chunkCount = (size_t)((payloadSize + TABLE_CHUNK_SIZE - 1) / TABLE_CHUNK_SIZE);
+    tableFileHeader header = {};
+    memcpy(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC));
+    header.version = TABLE_FILE_VERSION;
+    header.scheme = (uint32_t)mScheme;
+    header.symmetry = mSymmetry;
+    header.sectionCount = (uint32_t)mSections.size();
+    header.parameter = mParameter;
+    header.chunkSize = TABLE_CHUNK_SIZE;
+    header.payloadOffset = alignUp(sizeof(header) + directory.size() * sizeof(tableSectionEntry) + chunkCount * sizeof(uint64_t), SECTION_ALIGNMENT);
+    header.payloadSize = payloadSize;
+
+    std::filesystem::path target(path);
+    if (target.has_parent_path())
+        std::filesystem::create_directories(target.parent_path());
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open table file for writing!");
+
+    //Payload first, assembled chunk by chunk so its checksums are known before the header goes in front of it
+    std::vector<uint64_t> chunkChecksums(chunkCount);
+    std::vector<uint8_t> chunk;
+    file.seekp((std::streamoff)header.payloadOffset);
+    for (size_t c = 0; c < chunkCount; c++)
+    {
+        uint64_t begin = c * TABLE_CHUNK_SIZE;
+        uint64_t end = std::min(begin + TABLE_CHUNK_SIZE, payloadSize);
+        chunk.assign((size_t)(end - begin), 0);
+        for (size_t i = 0; i < mSections.size(); i++)
+        {
+            uint64_t from = std::max(begin, directory[i].offset);
+            uint64_t to = std::min(end, directory[i].offset + directory[i].size);
+            if (from < to)
+                memcpy(chunk.data() + (from - begin), mSections[i].data + (from - directory[i].offset), (size_t)(to - from));
+        }
+        chunkChecksums[c] = tableChecksum(chunk.data(), chunk.size());
+        file.write(reinterpret_cast<const char*>(chunk.data()), (std::streamsize)chunk.size());
+    }
+
+    header.headerChecksum = headerChecksum(header, directory.data(), chunkChecksums.data(), chunkCount);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(directory.data()), (std::streamsize)(directory.size() * sizeof(tableSectionEntry)));
+    file.write(reinterpret_cast<const char*>(chunkChecksums.data()), (std::streamsize)(chunkCount * sizeof(uint64_t)));
+    file.close();
+    if (!file)
+        throw std::runtime_error("Failed to write table file!");
+
+    std::error_code error;
+    std::filesystem::rename(temporary, target, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary, error);
+        throw std::runtime_error("Failed to move table file into place!");
+    }
+}
+
+tableFile::~tableFile()
+{
+    close();
+}
+
+bool tableFile::open(const std::string& path, tableScheme scheme, uint64_t parameter, uint32_t symmetry, const mapOptions& options)
+{
+    close();
+    if (!mFile.open(path, options))
+        return false;
+
+    const uint8_t* data = mFile.data();
+    size_t size = mFile.size();
+    if (size < sizeof(tableFileHeader))
+    {
+        close();
+        return false;
+    }
+    memcpy(&mHeader, data, sizeof(mHeader));
+
+    bool valid = memcmp(mHeader.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) == 0 && mHeader.version == TABLE_FILE_VERSION
+        && mHeader.scheme == (uint32_t)scheme && mHeader.parameter == parameter && mHeader.symmetry == symmetry
+        && mHeader.sectionCount <= MAX_SECTIONS && mHeader.chunkSize > 0
+        && mHeader.payloadOffset + mHeader.payloadSize == size;
+    if (valid)
+    {
+        mChunkCount = (size_t)((mHeader.payloadSize + mHeader.chunkSize - 1) / mHeader.chunkSize);
+        size_t metadata = sizeof(tableFileHeader) + mHeader.sectionCount * sizeof(tableSectionEntry) + mChunkCount * sizeof(uint64_t);
+        valid = metadata <= mHeader.payloadOffset;
+    }
+    if (valid)
+    {
+        const tableSectionEntry* directory = reinterpret_cast<const tableSectionEntry*>(data + sizeof(tableFileHeader));
+        mSections.assign(directory, directory + mHeader.sectionCount);
+        mChunkChecksums = reinterpret_cast<const uint64_t*>(data + sizeof(tableFileHeader) + mHeader.sectionCount * sizeof(tableSectionEntry));
+        valid = headerChecksum(mHeader, mSections.data(), mChunkChecksums, mChunkCount) == mHeader.headerChecksum;
+        for (const tableSectionEntry& entry : mSections)
+            valid = valid && entry.name[sizeof(entry.name) - 1] == '\0' && entry.offset + entry.size <= mHeader.payloadSize;
+    }
+    if (!valid)
+    {
+        close();
+        return false;
+    }
+
+    mPath = path;
+    mChunkState.reset(new std::atomic<uint8_t>[mChunkCount]);
+    for (size_t i = 0; i < mChunkCount; i++)
+        mChunkState[i] = 0;
+    return true;
+}
+
+void tableFile::close()
+{
+    mStopVerifier = true;
+    if (mVerifier.joinable())
+        mVerifier.join();
+    mStopVerifier = false;
+
+    mFile.close();
+    mSections.clear();
+    mChunkChecksums = nullptr;
+    mChunkState.reset();
+    mChunkCount = 0;
+    mHeader = {};
+    mCorrupted = false;
+}
+
+const uint8_t* tableFile::section(const char* name, uint64_t size) const
+{
+    for (const tableSectionEntry& entry : mSections)
+        if (strcmp(entry.name, name) == 0)
+            return entry.size == size ? mFile.data() + mHeader.payloadOffset + entry.offset : nullptr;
+    return nullptr;
+}
+
+bool tableFile::verifyChunk(size_t index)
+{
+    uint8_t state = mChunkState[index];
+    if (state != 0)
+        return state == 1;
+
+    uint64_t begin = index * mHeader.chunkSize;
+    uint64_t end = std::min(begin + mHeader.chunkSize, mHeader.payloadSize);
+    bool good = tableChecksum(mFile.data() + mHeader.payloadOffset + begin, (size_t)(end - begin)) == mChunkChecksums[index];
+    mChunkState[index] = good ? 1 : 2;
+    if (!good)
+        mCorrupted = true;
+    return good;
+}
+
+bool tableFile::verifySection(const char* name)
+{
+    for (const tableSectionEntry& entry : mSections)
+    {
+        if (strcmp(entry.name, name) != 0)
+            continue;
+        bool good = true;
+        if (entry.size == 0)
+            return true;
+        for (uint64_t c = entry.offset / mHeader.chunkSize; c <= (entry.offset + entry.size - 1) / mHeader.chunkSize; c++)
+            good = verifyChunk((size_t)c) && good;
+        return good;
+    }
+    return false;
+}
+
+bool tableFile::verifyAll()
+{
+    bool good = true;
+    for (size_t i = 0; i < mChunkCount; i++)
+        good = verifyChunk(i) && good;
+    return good;
+}
+
+//The calling thread only gets CPU time and disk bandwidth nothing else is using. Best effort, failures keep normal priority
+static void lowerThreadPriority()
+{
+#if defined(__linux__)
+    sched_param param = {};
+    sched_setscheduler(0, SCHED_IDLE, &param);
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+    #ifdef SYS_ioprio_set
+    const int IOPRIO_WHO_PROCESS = 1;
+    const int IOPRIO_CLASS_IDLE = 3;
+    syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << 13);
+    #endif
+#elif defined(_WIN32)
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#endif
+}
+
+void tableFile::verifyInBackground()
+{
+    if (mVerifier.joinable() || mChunkCount == 0)
+        return;
+
+    mVerifier = std::thread([this]()
+    {
+        lowerThreadPriority();
+        for (size_t i = 0; i < mChunkCount && !mStopVerifier; i++)
+        {
+            if (verifyChunk(i))
+                continue;
+
+            //Mapped pages stay readable after the file is removed, but requireIntactTables keeps solvers off them
+            sDamagedTable = true;
+            std::error_code error;
+            std::filesystem::remove(mPath, error);
+            std::cerr << "Table file " << mPath << " is damaged in chunk " << i << (error ? ", delete it" : ", deleted it") << " to have it rebuilt\n";
+            return;
+        }
+    });
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mappedFile.h"
+
+//What a table file holds. Files of another scheme, version or parameter are regenerated rather than reinterpreted
+enum class tableScheme : uint32_t
+{
+    twoPhaseMoves = 1,
+    twoPhasePrune = 2,
+    korfPattern = 3,
+    symmetryClasses = 4,
+    solutionCache = 5,
+    moveAutomaton = 6,
+    thistlethwaite = 7,
+};
+
+//On-disk layout, little endian:
+//  header, section directory, one checksum per CHUNK_SIZE bytes of payload, then the sections, each page aligned
+//The header checksum covers header, directory and chunk checksums, so opening only reads a few KB.
+//Payload chunks are verified lazily, on a background thread or when a caller asks for a section to be checked
+struct tableFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t scheme;
+    uint32_t symmetry;          //Symmetries the coordinates are reduced by, 1 for none. Files of several tables pack one factor per byte
+    uint32_t sectionCount;
+    uint64_t parameter;         //Scheme specific, e.g. the number of edges in a pattern database
+    uint64_t chunkSize;
+    uint64_t payloadOffset;
+    uint64_t payloadSize;
+    uint64_t headerChecksum;
+};
+
+struct tableSectionEntry
+{
+    char name[16];
+    uint64_t offset;            //From the start of the payload
+    uint64_t size;
+};
+
+const uint32_t TABLE_FILE_VERSION = 1;
+const uint64_t TABLE_CHUNK_SIZE = 1 << 20;
+
+//Directory for generated tables: RUBIK_TABLE_DIR, or "tables" next to the working directory
+std::string tableDirectory();
+
+//Mapping hints from the environment: RUBIK_TABLE_POPULATE=1 and RUBIK_TABLE_HUGEPAGES=1
+mapOptions tableMapOptions();
+
+uint64_t tableChecksum(const uint8_t* data, size_t size);
+
+//Throws once any mapped table failed a background checksum. Solvers call it before each search, so damaged tables stop
+//being used instead of pruning with wrong distances
+void requireIntactTables();
+
+class tableWriter
+{
+public:
+    tableWriter(tableScheme scheme, uint64_t parameter, uint32_t symmetry);
+
+    //The data must stay valid until write returns
+    void addSection(const char* name, const void* data, uint64_t size);
+
+    //Writes to a temporary file and renames it, so readers never map a half written table. Throws on failure
+    void write(const std::string& path) const;
+
+private:
+    struct pendingSection
+    {
+        std::string name;
+        const uint8_t* data;
+        uint64_t size;
+    };
+
+    tableScheme mScheme;
+    uint64_t mParameter;
+    uint32_t mSymmetry;
+    std::vector<pendingSection> mSections;
+};
+
+class tableFile
+{
+public:
+    tableFile() = default;
+    ~tableFile();
+    tableFile(const tableFile&) = delete;
+    tableFile& operator=(const tableFile&) = delete;
+
+    //Checks the header only, false if the file is missing, damaged or of another scheme, version, parameter or symmetry
+    bool open(const std::string& path, tableScheme scheme, uint64_t parameter, uint32_t symmetry, const mapOptions& options = tableMapOptions());
+    void close();
+
+    //nullptr if the section is missing or has another size
+    const uint8_t* section(const char* name, uint64_t size) const;
+
+    //Verifies the chunks a section spans (once each), false on a checksum mismatch
+    bool verifySection(const char* name);
+    bool verifyAll();
+
+    //Walks every chunk on a thread at idle CPU and I/O priority, so it only reads the file while nothing else wants the
+    //machine. A damaged chunk makes requireIntactTables throw and deletes the file so the next launch rebuilds it. Joined by close
+    void verifyInBackground();
+    bool corrupted() const { return mCorrupted; }
+
+private:
+    bool verifyChunk(size_t index);
+
+    std::string mPath;
+    mappedFile mFile;
+    tableFileHeader mHeader = {};
+    std::vector<tableSectionEntry> mSections;
+    const uint64_t* mChunkChecksums = nullptr;
+    std::unique_ptr<std::atomic<uint8_t>[]> mChunkState;     //0 unchecked, 1 good, 2 bad
+    size_t mChunkCount = 0;
+
+    std::thread mVerifier;
+    std::atomic<bool> mStopVerifier{false};
+    std::atomic<bool> mCorrupted{false};
+};
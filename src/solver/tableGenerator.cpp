@@ -0,0 +1,166 @@
+#include "tableGenerator.h"
+#include <cstdio>
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "packedTable reads its words as bytes!");
+
+packedTable::packedTable(int bitsPerEntry, uint64_t entries) : mEntries(entries), mBits(bitsPerEntry)
+{
+    if (bitsPerEntry != 2 && bitsPerEntry != 4)
+        throw std::runtime_error("Packed tables hold 2 or 4 bit entries!");
+    mWordShift = bitsPerEntry == 2 ? 5 : 4;
+    mIndexMask = (1ull << mWordShift) - 1;
+    mMask = (uint8_t)((1 << bitsPerEntry) - 1);
+
+    uint64_t words = (entries + mIndexMask) >> mWordShift;
+    mWords.reset(new std::atomic<uint64_t>[(size_t)words]);
+    for (uint64_t i = 0; i < words; i++)
+        mWords[(size_t)i].store(~0ull, std::memory_order_relaxed);
+}
+
+void nibbleTable::adopt(packedTable&& table)
+{
+    if (table.bitsPerEntry() != 4)
+        throw std::runtime_error("Nibble tables hold 4-bit entries!");
+    mOwned = std::move(table);
+    mEntries = mOwned.entries();
+    mData = mOwned.data();
+}
+
+void nibbleTable::attach(const uint8_t* data, uint64_t entries)
+{
+    mOwned = packedTable();
+    mEntries = entries;
+    mData = data;
+}
+
+bool parsePruneEncoding(const std::string& name, pruneEncoding& encoding)
+{
+    if (name == "nibble")
+        encoding = pruneEncoding::nibble;
+    else if (name == "cached")
+        encoding = pruneEncoding::cachedNibble;
+    else if (name == "mod3")
+        encoding = pruneEncoding::mod3;
+    else if (name == "base3")
+        encoding = pruneEncoding::base3;
+    else
+        return false;
+    return true;
+}
+
+const char* pruneEncodingName(pruneEncoding encoding)
+{
+    switch (encoding)
+    {
+    case pruneEncoding::cachedNibble:
+        return "cached";
+    case pruneEncoding::mod3:
+        return "mod3";
+    case pruneEncoding::base3:
+        return "base3";
+    default:
+        return "nibble";
+    }
+}
+
+const distanceTable::base3Digits distanceTable::BASE3 = []()
+{
+    base3Digits table = {};
+    for (int value = 0; value < 243; value++)
+    {
+        int rest = value;
+        for (int digit = 0; digit < 5; digit++, rest /= 3)
+            table.digits[value][digit] = (uint8_t)(rest % 3);
+    }
+    return table;
+}();
+
+const int8_t distanceTable::NEIGHBOR_STEP[3] = { 0, 1, -1 };
+
+uint64_t distanceTable::dataBytes(pruneEncoding encoding, uint64_t entries)
+{
+    switch (encoding)
+    {
+    case pruneEncoding::mod3:
+        return (entries + 3) / 4;
+    case pruneEncoding::base3:
+        return (entries + 4) / 5;
+    default:
+        return (entries + 1) / 2;
+    }
+}
+
+uint64_t distanceTable::cacheBytes(pruneEncoding encoding, uint64_t entries)
+{
+    if (encoding != pruneEncoding::cachedNibble)
+        return 0;
+    uint64_t blocks = (entries + DISTANCE_CACHE_BLOCK - 1) / DISTANCE_CACHE_BLOCK;
+    return (blocks + 1) / 2;
+}
+
+void distanceTable::adopt(packedTable&& table, pruneEncoding encoding)
+{
+    if (table.bitsPerEntry() != generatorBits(encoding))
+        throw std::runtime_error("Table was generated with the wrong entry size for its encoding!");
+    mEncoding = encoding;
+    mEntries = table.entries();
+    mCache = nullptr;
+    mOwnedData.clear();
+    mOwnedCache.clear();
+
+    if (encoding == pruneEncoding::base3)
+    {
+        mOwnedData.assign((size_t)dataBytes(encoding, mEntries), 0);
+        for (uint64_t index = mEntries; index-- > 0;)
+        {
+            uint8_t& byte = mOwnedData[(size_t)(index / 5)];
+            byte = (uint8_t)(byte * 3 + table.get(index));
+        }
+        mOwned = packedTable();
+        mData = mOwnedData.data();
+        return;
+    }
+
+    mOwned = std::move(table);
+    mData = mOwned.data();
+    if (encoding == pruneEncoding::cachedNibble)
+    {
+        mOwnedCache.assign((size_t)cacheBytes(encoding, mEntries), 0xFF);
+        for (uint64_t index = 0; index < mEntries; index++)
+        {
+            uint64_t block = index / DISTANCE_CACHE_BLOCK;
+            uint8_t& byte = mOwnedCache[(size_t)(block >> 1)];
+            int shift = (int)(block & 1) << 2;
+            int value = nibble(index);
+            if (value < ((byte >> shift) & 0x0F))
+                byte = (uint8_t)((byte & ~(0x0F << shift)) | (value << shift));
+        }
+        mCache = mOwnedCache.data();
+    }
+}
+
+void distanceTable::attach(pruneEncoding encoding, const uint8_t* data, const uint8_t* cache, uint64_t entries)
+{
+    mOwned = packedTable();
+    mOwnedData.clear();
+    mOwnedCache.clear();
+    mEncoding = encoding;
+    mEntries = entries;
+    mData = data;
+    mCache = encoding == pruneEncoding::cachedNibble ? cache : nullptr;
+}
+
+void bfsStats::report(std::ostream& out, const std::string& name) const
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%s: %llu entries in %.2f s on %d threads\n", name.c_str(), (unsigned long long)entries, seconds, threads);
+    out << line;
+    for (const bfsLevel& level : levels)
+    {
+        //Every sweep scans the whole table, so throughput is entries scanned per second
+        double rate = level.seconds > 0.0 ? entries / level.seconds / 1e6 : 0.0;
+        snprintf(line, sizeof(line), "  depth %2d %-8s %12llu states %8.3f s %9.1f M entries/s\n", level.depth,
+                 level.depth == 0 ? "start" : level.backward ? "backward" : "forward", (unsigned long long)level.states, level.seconds, rate);
+        out << line;
+    }
+}
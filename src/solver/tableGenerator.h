@@ -0,0 +1,285 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../cpuFeatures.h"
+#include "workStealingPool.h"
+
+//Table of 2 or 4 bit entries packed into 64-bit words, lowest bits first, which on a little endian host is the byte
+//layout nibbleTable reads. Entries start out all ones (unvisited) and are filled with compare-and-swap so the
+//generator threads can share one table without locks
+class packedTable
+{
+public:
+    packedTable() = default;
+    packedTable(int bitsPerEntry, uint64_t entries);
+
+    int bitsPerEntry() const { return mBits; }
+    uint8_t unvisited() const { return mMask; }
+    uint64_t entries() const { return mEntries; }
+    uint64_t bytes() const { return (mEntries * mBits + 7) / 8; }
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(mWords.get()); }
+
+    uint8_t get(uint64_t index) const
+    {
+        uint64_t word = mWords[index >> mWordShift].load(std::memory_order_relaxed);
+        return (uint8_t)((word >> ((index & mIndexMask) * mBits)) & mMask);
+    }
+
+    //Writes value only if the entry is still unvisited. Returns true for the one caller that wrote it
+    bool trySet(uint64_t index, uint8_t value)
+    {
+        std::atomic<uint64_t>& word = mWords[index >> mWordShift];
+        int shift = (int)(index & mIndexMask) * mBits;
+        uint64_t current = word.load(std::memory_order_relaxed);
+        do
+        {
+            if (((current >> shift) & mMask) != mMask)
+                return false;
+        } while (!word.compare_exchange_weak(current, current & ~((uint64_t)(mMask ^ value) << shift), std::memory_order_relaxed));
+        return true;
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> mWords;
+    uint64_t mEntries = 0;
+    int mBits = 0;
+    int mWordShift = 0;
+    uint64_t mIndexMask = 0;
+    uint8_t mMask = 0;
+};
+
+//Packed table of 4-bit distances. 0xF marks entries the generator has not reached yet
+class nibbleTable
+{
+public:
+    static const uint8_t UNVISITED = 0x0F;
+
+    //Takes over a 4-bit table from the generator, whose words have the same byte layout
+    void adopt(packedTable&& table);
+    void attach(const uint8_t* data, uint64_t entries);
+
+    uint8_t get(uint64_t index) const { return (mData[index >> 1] >> ((index & 1) << 2)) & 0x0F; }
+    void prefetch(uint64_t index) const { RUBIK_PREFETCH(mData + (index >> 1)); }
+
+    const uint8_t* data() const { return mData; }
+    uint64_t entries() const { return mEntries; }
+    uint64_t bytes() const { return (mEntries + 1) / 2; }
+
+private:
+    const uint8_t* mData = nullptr;
+    uint64_t mEntries = 0;
+    packedTable mOwned;
+};
+
+//How a table of exact distances is stored, chosen per table when it is generated
+//  nibble: the distance in 4 bits
+//  cachedNibble: the same behind a cache of the smallest distance in each block of DISTANCE_CACHE_BLOCK entries, 1/64 of
+//      the size, which prunes many nodes before the full table is read
+//  mod3: the distance mod 3 in 2 bits. Neighbors are at most one move apart, so the exact distance follows from a neighbor's
+//  base3: the distance mod 3, 5 entries per byte (1.6 bits each), decoded through a 256-entry table
+enum class pruneEncoding : uint8_t
+{
+    nibble,
+    cachedNibble,
+    mod3,
+    base3
+};
+
+const int DISTANCE_CACHE_BLOCK = 64;
+
+//"nibble", "cached", "mod3" or "base3", false for anything else
+bool parsePruneEncoding(const std::string& name, pruneEncoding& encoding);
+const char* pruneEncodingName(pruneEncoding encoding);
+
+//Bits per entry of the breadth first search that fills a table of that encoding
+inline int generatorBits(pruneEncoding encoding) { return encoding == pruneEncoding::nibble || encoding == pruneEncoding::cachedNibble ? 4 : 2; }
+
+class distanceTable
+{
+public:
+    //Takes over a table from the generator (4-bit for the nibble encodings, 2-bit for the others) and encodes it
+    void adopt(packedTable&& table, pruneEncoding encoding);
+
+    //cache is only used by cachedNibble
+    void attach(pruneEncoding encoding, const uint8_t* data, const uint8_t* cache, uint64_t entries);
+
+    static uint64_t dataBytes(pruneEncoding encoding, uint64_t entries);
+    static uint64_t cacheBytes(pruneEncoding encoding, uint64_t entries);
+
+    pruneEncoding encoding() const { return mEncoding; }
+    bool exact() const { return mEncoding == pruneEncoding::nibble || mEncoding == pruneEncoding::cachedNibble; }
+    const uint8_t* data() const { return mData; }
+    const uint8_t* cache() const { return mCache; }
+    uint64_t entries() const { return mEntries; }
+    uint64_t bytes() const { return dataBytes(mEncoding, mEntries); }
+    uint64_t cacheBytes() const { return cacheBytes(mEncoding, mEntries); }
+
+    //Distance mod 3 from the table alone
+    int residue(uint64_t index) const
+    {
+        switch (mEncoding)
+        {
+        case pruneEncoding::mod3:
+            return (mData[index >> 2] >> ((index & 3) << 1)) & 3;
+        case pruneEncoding::base3:
+            return BASE3.digits[mData[index / 5]][index % 5];
+        default:
+            return nibble(index) % 3;
+        }
+    }
+
+    //Exact distance. The mod 3 encodings need the exact distance of a neighbor, the others ignore it
+    int distance(uint64_t index, int neighbor) const
+    {
+        if (exact())
+            return nibble(index);
+        return neighbor + NEIGHBOR_STEP[(residue(index) - neighbor % 3 + 3) % 3];
+    }
+
+    //Lower bound from the cache alone, 0 without one
+    int cachedBound(uint64_t index) const
+    {
+        if (mCache == nullptr)
+            return 0;
+        uint64_t block = index / DISTANCE_CACHE_BLOCK;
+        return (mCache[block >> 1] >> ((block & 1) << 2)) & 0x0F;
+    }
+
+    //A cached table only prefetches its cache, the full table is read for the nodes the cache cannot prune
+    void prefetch(uint64_t index) const
+    {
+        if (mCache != nullptr)
+            RUBIK_PREFETCH(mCache + (index / DISTANCE_CACHE_BLOCK >> 1));
+        else if (mEncoding == pruneEncoding::base3)
+            RUBIK_PREFETCH(mData + index / 5);
+        else
+            RUBIK_PREFETCH(mData + (index >> (mEncoding == pruneEncoding::mod3 ? 2 : 1)));
+    }
+
+private:
+    struct base3Digits { uint8_t digits[256][5]; };
+    static const base3Digits BASE3;
+    static const int8_t NEIGHBOR_STEP[3];   //By residue minus the neighbor's residue: the same, one more or one less
+
+    int nibble(uint64_t index) const { return (mData[index >> 1] >> ((index & 1) << 2)) & 0x0F; }
+
+    pruneEncoding mEncoding = pruneEncoding::nibble;
+    const uint8_t* mData = nullptr;
+    const uint8_t* mCache = nullptr;
+    uint64_t mEntries = 0;
+    packedTable mOwned;
+    std::vector<uint8_t> mOwnedData;
+    std::vector<uint8_t> mOwnedCache;
+};
+
+struct bfsLevel
+{
+    int depth;
+    bool backward;
+    uint64_t states;    //states first reached at this depth
+    double seconds;
+};
+
+struct bfsStats
+{
+    std::vector<bfsLevel> levels;
+    uint64_t entries = 0;
+    double seconds = 0.0;
+    int threads = 0;
+
+    //One line per level with the direction, new states and scan throughput
+    void report(std::ostream& out, const std::string& name) const;
+};
+
+//Breadth first search from start over a state space indexed 0 .. table.entries() - 1, one depth layer per sweep
+//expand(index, visit) calls visit(neighbor) for each neighbor and may return as soon as visit returns true
+//The neighbor relation must be symmetric, as it is for any move set closed under inverses
+//Early layers run forwards (the frontier marks its unvisited neighbors). Once more than half the table is reached it
+//runs backwards instead: every unvisited entry looks for a neighbor in the frontier and stops at the first one
+//4-bit tables store the depth itself (up to 14), 2-bit tables the depth mod 3, which a search recovers from the parent's depth
+template <typename Expand>
+bfsStats breadthFirstFill(packedTable& table, uint64_t start, Expand expand, int threads = 0)
+{
+    //Chunks cover whole words so backward sweeps never write a word another worker writes
+    const uint64_t CHUNK_ENTRIES = 1 << 16;
+    const uint64_t size = table.entries();
+    const uint8_t unvisited = table.unvisited();
+    const bool modular = table.bitsPerEntry() == 2;
+
+    workStealingPool pool(threads);
+    bfsStats stats;
+    stats.entries = size;
+    stats.threads = pool.size();
+    auto began = std::chrono::steady_clock::now();
+
+    table.trySet(start, 0);
+    stats.levels.push_back({ 0, false, 1, 0.0 });
+    uint64_t visited = 1;
+    for (int depth = 0; visited < size; depth++)
+    {
+        if (!modular && depth + 1 >= unvisited)
+            throw std::runtime_error("Table depth does not fit in its entries!");
+
+        auto levelBegan = std::chrono::steady_clock::now();
+        uint8_t current = (uint8_t)(modular ? depth % 3 : depth);
+        uint8_t next = (uint8_t)(modular ? (depth + 1) % 3 : depth + 1);
+        bool backward = visited * 2 > size;
+        std::atomic<uint64_t> found{0};
+
+        for (uint64_t begin = 0; begin < size; begin += CHUNK_ENTRIES)
+        {
+            uint64_t end = begin + CHUNK_ENTRIES < size ? begin + CHUNK_ENTRIES : size;
+            pool.submit([&, begin, end]()
+            {
+                uint64_t count = 0;
+                for (uint64_t index = begin; index < end; index++)
+                {
+                    uint8_t value = table.get(index);
+                    if (backward)
+                    {
+                        if (value != unvisited)
+                            continue;
+                        bool reached = false;
+                        expand(index, [&](uint64_t neighbor)
+                        {
+                            if (table.get(neighbor) == current)
+                                reached = true;
+                            return reached;
+                        });
+                        if (reached && table.trySet(index, next))
+                            count++;
+                    }
+                    else if (value == current)
+                    {
+                        //In a 2-bit table this also re-expands depth - 3, whose neighbors are all visited already
+                        expand(index, [&](uint64_t neighbor)
+                        {
+                            if (table.get(neighbor) == unvisited && table.trySet(neighbor, next))
+                                count++;
+                            return false;
+                        });
+                    }
+                }
+                found += count;
+            });
+        }
+        pool.wait();
+
+        //Unreachable entries stay unvisited
+        if (found == 0)
+            break;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - levelBegan).count();
+        stats.levels.push_back({ depth + 1, backward, found.load(), seconds });
+        visited += found;
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+    return stats;
+}
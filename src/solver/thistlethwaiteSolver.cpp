@@ -0,0 +1,456 @@
+#include "thistlethwaiteSolver.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+//Moves that keep the cube in the subgroup each phase starts from: all, then <U, D, R, L, F2, B2>, <U, D, R2, L2, F2, B2> and
+//the half turns. Edges only flip under F and B quarter turns and corners only keep their twist under U and D quarter turns
+static const int PHASE_MOVE_COUNTS[THISTLETHWAITE_PHASE_COUNT] = { 18, 14, 10, 6 };
+static const uint8_t PHASE_MOVES[THISTLETHWAITE_PHASE_COUNT][MOVE_COUNT] =
+{
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17 },
+    { 0, 1, 2, 3, 4, 5, 7, 9, 10, 11, 12, 13, 14, 16 },
+    { 0, 1, 2, 4, 7, 9, 10, 11, 13, 16 },
+    { 1, 4, 7, 10, 13, 16 },
+};
+
+//The longest distance of each phase, a solve stepping further has damaged tables
+static const int PHASE_MAX_LENGTHS[THISTLETHWAITE_PHASE_COUNT] = { 7, 10, 13, 15 };
+
+const uint64_t thistlethwaiteTables::PHASE_SIZES[THISTLETHWAITE_PHASE_COUNT] =
+{
+    (uint64_t)FLIP_COUNT,
+    (uint64_t)TWIST_COUNT * SLICE_COUNT,
+    (uint64_t)CORNER_COSET_COUNT * M_SLICE_COUNT,
+    (uint64_t)CORNER_GROUP_COUNT * SLICE_ORDER_COUNT,
+};
+
+//Half turns keep every edge in its slice. An edge's place in its slice's list is its part of the slice order coordinate
+static const uint8_t SLICE_EDGES[3][4] = { { UF, UB, DF, DB }, { UR, UL, DR, DL }, { FR, FL, BL, BR } };
+static const uint8_t SLICE_POSITION[EDGE_COUNT] = { 0, 0, 1, 1, 2, 2, 3, 3, 0, 1, 2, 3 };
+
+static bool isHalfTurn(int move) { return move % 3 == 1; }
+
+//Phase 3 edges: the E-slice edges stay in the E slice from G2 on, so the M-slice edges are all in the U and D layers
+static bool isPhase3Move(int move) { return move / 3 == FACE_U || move / 3 == FACE_D || isHalfTurn(move); }
+
+static int mSliceMask(const cubieCube& cube)
+{
+    int mask = 0;
+    for (int slot = 0; slot < 8; slot++)
+    {
+        int piece = cube.edgePerm(slot);
+        if (piece < 8 && (piece & 1))
+            mask |= 1 << slot;
+    }
+    return mask;
+}
+
+static int sliceOrderOf(const cubieCube& cube, int slice)
+{
+    uint8_t order[4];
+    for (int i = 0; i < 4; i++)
+        order[i] = SLICE_POSITION[cube.edgePerm(SLICE_EDGES[slice][i])];
+    return permutationRank(order, 4);
+}
+
+static int groupIndex(const thistlethwaiteMoves& moves, int cornerPerm)
+{
+    const uint16_t* end = moves.groupCorners + CORNER_GROUP_COUNT;
+    const uint16_t* found = std::lower_bound(moves.groupCorners, end, (uint16_t)cornerPerm);
+    if (found == end || *found != cornerPerm)
+        throw std::runtime_error("Corners are not in the half turn group!");
+    return (int)(found - moves.groupCorners);
+}
+
+void thistlethwaiteMoves::generate()
+{
+    memset(this, 0, sizeof(*this));
+
+    for (int m = 0; m < MOVE_COUNT; m++)
+    {
+        for (int f = 0; f < FLIP_COUNT; f++)
+        {
+            cubieCube cube = cubieCube::solved();
+            setFlip(cube, f);
+            cube.move(m);
+            flip[f][m] = (uint16_t)getFlip(cube);
+        }
+        for (int t = 0; t < TWIST_COUNT; t++)
+        {
+            cubieCube cube = cubieCube::solved();
+            setTwist(cube, t);
+            cube.move(m);
+            twist[t][m] = (uint16_t)getTwist(cube);
+        }
+        for (int s = 0; s < SLICE_COUNT; s++)
+        {
+            cubieCube cube = cubieCube::solved();
+            setSlice(cube, s);
+            cube.move(m);
+            slice[s][m] = (uint16_t)getSlice(cube);
+        }
+    }
+
+    //The half turn group H of the corners, by breadth first search from the identity
+    std::vector<int> members = { 0 };
+    std::vector<bool> seen(CORNER_PERM_COUNT, false);
+    seen[0] = true;
+    for (size_t i = 0; i < members.size(); i++)
+    {
+        for (int m = 1; m < MOVE_COUNT; m += 3)
+        {
+            cubieCube cube = cubieCube::solved();
+            setCornerPerm(cube, members[i]);
+            cube.move(m);
+            int next = getCornerPerm(cube);
+            if (!seen[next])
+            {
+                seen[next] = true;
+                members.push_back(next);
+            }
+        }
+    }
+    if (members.size() != CORNER_GROUP_COUNT)
+        throw std::runtime_error("Unexpected size of the half turn corner group!");
+    std::sort(members.begin(), members.end());
+    cubieCube groupCubes[CORNER_GROUP_COUNT];
+    for (int g = 0; g < CORNER_GROUP_COUNT; g++)
+    {
+        groupCorners[g] = (uint16_t)members[g];
+        groupCubes[g] = cubieCube::solved();
+        setCornerPerm(groupCubes[g], members[g]);
+    }
+    for (int g = 0; g < CORNER_GROUP_COUNT; g++)
+    {
+        for (int m = 1; m < MOVE_COUNT; m += 3)
+        {
+            cubieCube cube = groupCubes[g];
+            cube.move(m);
+            group[g][m] = (uint8_t)groupIndex(*this, getCornerPerm(cube));
+        }
+    }
+
+    //p and h p need the same moves to reach H, so phase 3 only tracks the coset H p. The identity comes first, its coset is H
+    const uint16_t UNASSIGNED = 0xFFFF;
+    int cosetReps[CORNER_COSET_COUNT];
+    int cosets = 0;
+    std::fill(cornerCoset, cornerCoset + CORNER_PERM_COUNT, UNASSIGNED);
+    for (int p = 0; p < CORNER_PERM_COUNT; p++)
+    {
+        if (cornerCoset[p] != UNASSIGNED)
+            continue;
+        if (cosets == CORNER_COSET_COUNT)
+            throw std::runtime_error("Too many corner cosets!");
+
+        cubieCube cube = cubieCube::solved();
+        setCornerPerm(cube, p);
+        for (int g = 0; g < CORNER_GROUP_COUNT; g++)
+        {
+            cubieCube product;
+            multiply(groupCubes[g], cube, product);
+            cornerCoset[getCornerPerm(product)] = (uint16_t)cosets;
+        }
+        cosetReps[cosets++] = p;
+    }
+    if (cosets != CORNER_COSET_COUNT)
+        throw std::runtime_error("Unexpected number of corner cosets!");
+    for (int c = 0; c < CORNER_COSET_COUNT; c++)
+    {
+        for (int m = 0; m < MOVE_COUNT; m++)
+        {
+            cubieCube cube = cubieCube::solved();
+            setCornerPerm(cube, cosetReps[c]);
+            cube.move(m);
+            coset[c][m] = cornerCoset[getCornerPerm(cube)];
+        }
+    }
+
+    int masks[M_SLICE_COUNT];
+    int positions = 0;
+    memset(mSliceOf, 0xFF, sizeof(mSliceOf));
+    for (int mask = 0; mask < 256; mask++)
+    {
+        int bits = 0;
+        for (int slot = 0; slot < 8; slot++)
+            bits += (mask >> slot) & 1;
+        if (bits != 4)
+            continue;
+        mSliceOf[mask] = (uint8_t)positions;
+        masks[positions++] = mask;
+    }
+    for (int i = 0; i < M_SLICE_COUNT; i++)
+    {
+        cubieCube start = cubieCube::solved();
+        int m = 0;
+        int s = 0;
+        for (int slot = 0; slot < 8; slot++)
+        {
+            int piece = (masks[i] >> slot) & 1 ? SLICE_EDGES[0][m++] : SLICE_EDGES[1][s++];
+            start.setEdge(slot, piece, 0);
+        }
+        for (int move = 0; move < MOVE_COUNT; move++)
+        {
+            if (!isPhase3Move(move))
+                continue;
+            cubieCube cube = start;
+            cube.move(move);
+            mSlice[i][move] = mSliceOf[mSliceMask(cube)];
+        }
+    }
+
+    for (int s = 0; s < 3; s++)
+    {
+        for (int o = 0; o < 24; o++)
+        {
+            uint8_t order[4];
+            permutationUnrank(o, order, 4);
+            cubieCube start = cubieCube::solved();
+            for (int i = 0; i < 4; i++)
+                start.setEdge(SLICE_EDGES[s][i], SLICE_EDGES[s][order[i]], 0);
+            for (int m = 1; m < MOVE_COUNT; m += 3)
+            {
+                cubieCube cube = start;
+                cube.move(m);
+                sliceOrder[s][o][m] = (uint8_t)sliceOrderOf(cube, s);
+            }
+        }
+    }
+}
+
+uint64_t thistlethwaiteTables::phaseIndex(int phase, const cubieCube& cube) const
+{
+    const thistlethwaiteMoves& moves = *mMoves;
+    switch (phase)
+    {
+    case 0:
+        return (uint64_t)getFlip(cube);
+    case 1:
+        return (uint64_t)getTwist(cube) * SLICE_COUNT + getSlice(cube);
+    case 2:
+        return (uint64_t)moves.cornerCoset[getCornerPerm(cube)] * M_SLICE_COUNT + moves.mSliceOf[mSliceMask(cube)];
+    default:
+        return (uint64_t)groupIndex(moves, getCornerPerm(cube)) * SLICE_ORDER_COUNT
+            + (sliceOrderOf(cube, 0) * 24 + sliceOrderOf(cube, 1)) * 24 + sliceOrderOf(cube, 2);
+    }
+}
+
+uint64_t thistlethwaiteTables::phaseMove(int phase, uint64_t index, int move) const
+{
+    const thistlethwaiteMoves& moves = *mMoves;
+    switch (phase)
+    {
+    case 0:
+        return moves.flip[index][move];
+    case 1:
+        return (uint64_t)moves.twist[index / SLICE_COUNT][move] * SLICE_COUNT + moves.slice[index % SLICE_COUNT][move];
+    case 2:
+        return (uint64_t)moves.coset[index / M_SLICE_COUNT][move] * M_SLICE_COUNT + moves.mSlice[index % M_SLICE_COUNT][move];
+    default:
+    {
+        int edges = (int)(index % SLICE_ORDER_COUNT);
+        int m = moves.sliceOrder[0][edges / 576][move];
+        int s = moves.sliceOrder[1][edges / 24 % 24][move];
+        int e = moves.sliceOrder[2][edges % 24][move];
+        return (uint64_t)moves.group[index / SLICE_ORDER_COUNT][move] * SLICE_ORDER_COUNT + (m * 24 + s) * 24 + e;
+    }
+    }
+}
+
+std::vector<bfsStats> thistlethwaiteTables::generate(int threads)
+{
+    mFile.close();
+    mGeneratedMoves.reset(new thistlethwaiteMoves());
+    mGeneratedMoves->generate();
+    mMoves = mGeneratedMoves.get();
+
+    std::vector<bfsStats> stats;
+    for (int phase = 0; phase < THISTLETHWAITE_PHASE_COUNT; phase++)
+    {
+        packedTable table(2, PHASE_SIZES[phase]);
+        stats.push_back(breadthFirstFill(table, phaseIndex(phase, cubieCube::solved()), [&](uint64_t index, auto&& visit)
+        {
+            for (int i = 0; i < PHASE_MOVE_COUNTS[phase]; i++)
+            {
+                if (visit(phaseMove(phase, index, PHASE_MOVES[phase][i])))
+                    return;
+            }
+        }, threads));
+        mGeneratedPrune[phase] = std::move(table);
+        mPrune[phase] = mGeneratedPrune[phase].data();
+    }
+    return stats;
+}
+
+static const char* PHASE_SECTIONS[THISTLETHWAITE_PHASE_COUNT] = { "phase1", "phase2", "phase3", "phase4" };
+
+static uint64_t phaseBytes(int phase)
+{
+    return (thistlethwaiteTables::PHASE_SIZES[phase] * 2 + 7) / 8;
+}
+
+//The parameter records the table sizes, so files from a build with other coordinates are rebuilt
+static const uint64_t THISTLETHWAITE_PARAMETER = sizeof(thistlethwaiteMoves) + FLIP_COUNT + (uint64_t)TWIST_COUNT * SLICE_COUNT
+    + CORNER_COSET_COUNT * M_SLICE_COUNT + (uint64_t)CORNER_GROUP_COUNT * SLICE_ORDER_COUNT;
+
+bool thistlethwaiteTables::load(const std::string& path)
+{
+    if (!mFile.open(path, tableScheme::thistlethwaite, THISTLETHWAITE_PARAMETER, 1))
+        return false;
+
+    const uint8_t* moves = mFile.section("moves", sizeof(thistlethwaiteMoves));
+    const uint8_t* prune[THISTLETHWAITE_PHASE_COUNT];
+    bool complete = moves != nullptr;
+    for (int phase = 0; phase < THISTLETHWAITE_PHASE_COUNT; phase++)
+    {
+        prune[phase] = mFile.section(PHASE_SECTIONS[phase], phaseBytes(phase));
+        complete = complete && prune[phase] != nullptr;
+    }
+    if (!complete)
+    {
+        mFile.close();
+        return false;
+    }
+
+    mMoves = reinterpret_cast<const thistlethwaiteMoves*>(moves);
+    for (int phase = 0; phase < THISTLETHWAITE_PHASE_COUNT; phase++)
+    {
+        mPrune[phase] = prune[phase];
+        mGeneratedPrune[phase] = packedTable();
+    }
+    mGeneratedMoves.reset();
+    mFile.verifyInBackground();
+    return true;
+}
+
+void thistlethwaiteTables::save(const std::string& path) const
+{
+    tableWriter writer(tableScheme::thistlethwaite, THISTLETHWAITE_PARAMETER, 1);
+    writer.addSection("moves", mMoves, sizeof(thistlethwaiteMoves));
+    for (int phase = 0; phase < THISTLETHWAITE_PHASE_COUNT; phase++)
+        writer.addSection(PHASE_SECTIONS[phase], mPrune[phase], phaseBytes(phase));
+    writer.write(path);
+}
+
+const thistlethwaiteTables& thistlethwaiteTables::get()
+{
+    static const std::unique_ptr<thistlethwaiteTables> tables = []()
+    {
+        std::unique_ptr<thistlethwaiteTables> created(new thistlethwaiteTables());
+        std::string path = tableDirectory() + "/thistlethwaite.tbl";
+        if (created->load(path))
+            return created;
+
+        std::vector<bfsStats> stats = created->generate();
+        const char* names[] = { "flip", "twist x slice", "corner coset x M-slice", "corner group x slice orders" };
+        for (size_t i = 0; i < stats.size(); i++)
+            stats[i].report(std::cerr, names[i]);
+        try
+        {
+            created->save(path);
+        }
+        catch (const std::exception&)
+        {
+            //A read-only table directory only costs regenerating next launch
+        }
+        return created;
+    }();
+    return *tables;
+}
+
+//Phases end on arbitrary faces, so the first move of a phase can merge with the last one of the phase before
+static void appendMove(std::vector<uint8_t>& moves, int move)
+{
+    if (!moves.empty() && moves.back() / 3 == move / 3)
+    {
+        int quarterTurns = (moves.back() % 3 + move % 3 + 2) % 4;
+        moves.pop_back();
+        if (quarterTurns != 0)
+            moves.push_back((uint8_t)(move - move % 3 + quarterTurns - 1));
+        return;
+    }
+    moves.push_back((uint8_t)move);
+}
+
+thistlethwaiteSolver::thistlethwaiteSolver() : mTables(thistlethwaiteTables::get())
+{
+}
+
+//Within a phase a neighbor is at most one move closer, and exactly one residue mod 3 tells the closer ones apart
+void thistlethwaiteSolver::solvePhases(const cubieCube& start, std::vector<uint8_t>& moves, uint64_t& lookups) const
+{
+    cubieCube cube = start;
+    for (int phase = 0; phase < THISTLETHWAITE_PHASE_COUNT; phase++)
+    {
+        uint64_t index = mTables.phaseIndex(phase, cube);
+        uint64_t goal = mTables.phaseIndex(phase, cubieCube::solved());
+        int distance = mTables.distanceMod3(phase, index);
+        lookups++;
+        for (int step = 0; index != goal; step++)
+        {
+            if (distance == 3 || step == PHASE_MAX_LENGTHS[phase])
+                throw std::runtime_error("Thistlethwaite tables are damaged!");
+
+            int closer = (distance + 2) % 3;
+            int found = -1;
+            for (int i = 0; i < PHASE_MOVE_COUNTS[phase] && found < 0; i++)
+            {
+                uint64_t next = mTables.phaseMove(phase, index, PHASE_MOVES[phase][i]);
+                lookups++;
+                if (mTables.distanceMod3(phase, next) == closer)
+                {
+                    found = PHASE_MOVES[phase][i];
+                    index = next;
+                }
+            }
+            if (found < 0)
+                throw std::runtime_error("Thistlethwaite tables are damaged!");
+
+            distance = closer;
+            cube.move(found);
+            appendMove(moves, found);
+        }
+    }
+}
+
+solverResult thistlethwaiteSolver::solve(const cubieCube& cube, const solverOptions&)
+{
+    if (cube.verify() != 0)
+        throw std::runtime_error("Cube state is not solvable!");
+    requireIntactTables();
+
+    auto startTime = std::chrono::steady_clock::now();
+    solverResult result;
+    std::vector<uint8_t> inverse;
+    solvePhases(cube, result.moves, result.nodes);
+    solvePhases(cube.inverse(), inverse, result.nodes);
+
+    //A solution of the inverse, reversed and inverted move by move, solves the cube
+    if (inverse.size() < result.moves.size())
+    {
+        result.moves.clear();
+        for (auto move = inverse.rbegin(); move != inverse.rend(); ++move)
+            result.moves.push_back((uint8_t)inverseMove(*move));
+    }
+    result.found = true;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+std::unique_ptr<solveHandle> thistlethwaiteSolver::solveAnytime(const cubieCube& cube, const solverOptions& options, solveHandle::solutionCallback onSolution)
+{
+    if (cube.verify() != 0)
+        throw std::runtime_error("Cube state is not solvable!");
+
+    std::unique_ptr<solveHandle> handle(new solveHandle(std::move(onSolution)));
+    solveHandle* target = handle.get();
+    handle->start([cube, options, target]()
+    {
+        thistlethwaiteSolver solver;
+        solverResult result = solver.solve(cube, options);
+        target->reportNodes(result.nodes);
+        target->publish(result);
+        return result;
+    });
+    return handle;
+}
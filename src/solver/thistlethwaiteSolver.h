@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "coordinates.h"
+#include "solveHandle.h"
+#include "solverResult.h"
+#include "tableFile.h"
+#include "tableGenerator.h"
+
+const int THISTLETHWAITE_PHASE_COUNT = 4;
+const int CORNER_GROUP_COUNT = 96;      //Corner permutations reachable with half turns only
+const int CORNER_COSET_COUNT = 420;     //Cosets H p of that group H among the 8! corner permutations
+const int M_SLICE_COUNT = 70;           //C(8,4) positions of the M-slice edges (UF, UB, DF, DB) among the U and D layer slots
+const int SLICE_ORDER_COUNT = 13824;    //Order of the edges inside the M, S and E slice, 24^3
+
+//Coordinate move tables of the four phases, about 270 KB. An entry is only meaningful for the moves of its own phase
+struct thistlethwaiteMoves
+{
+    uint16_t flip[FLIP_COUNT][MOVE_COUNT];
+    uint16_t twist[TWIST_COUNT][MOVE_COUNT];
+    uint16_t slice[SLICE_COUNT][MOVE_COUNT];
+    uint16_t cornerCoset[CORNER_PERM_COUNT];            //Coset of a corner permutation, 0 for the half turn group itself
+    uint16_t coset[CORNER_COSET_COUNT][MOVE_COUNT];
+    uint16_t groupCorners[CORNER_GROUP_COUNT];          //Corner permutations of the half turn group, increasing
+    uint8_t group[CORNER_GROUP_COUNT][MOVE_COUNT];
+    uint8_t mSliceOf[256];                              //Bit mask of the U and D layer slots holding M-slice edges to coordinate
+    uint8_t mSlice[M_SLICE_COUNT][MOVE_COUNT];
+    uint8_t sliceOrder[3][24][MOVE_COUNT];              //Per slice (M, S, E), the order of its edges while all of them stay in it
+
+    void generate();
+};
+
+//Distances to the end of each phase, 2 bits per entry (the depth mod 3, 3 for unreachable entries), about 600 KB in all
+//Phase 1 projects onto flip, phase 2 onto (twist, slice), phase 3 onto (corner coset, M-slice) and phase 4 onto
+//(half turn corner group, slice orders). Each one is exact, so a phase is solved by stepping to any neighbor one closer
+class thistlethwaiteTables
+{
+public:
+    static const uint64_t PHASE_SIZES[THISTLETHWAITE_PHASE_COUNT];
+
+    //Mapped from the table directory on first use, thread safe. Generated (well under a second) and saved there if missing
+    static const thistlethwaiteTables& get();
+
+    //Returns the breadth first search statistics of each phase. 0 threads uses every hardware thread
+    std::vector<bfsStats> generate(int threads = 0);
+    bool load(const std::string& path);
+    void save(const std::string& path) const;
+
+    const thistlethwaiteMoves& moves() const { return *mMoves; }
+
+    int distanceMod3(int phase, uint64_t index) const { return (mPrune[phase][index >> 2] >> ((index & 3) << 1)) & 3; }
+
+    //Projection of cube for phase and of its neighbor after move, which has to be one of the phase's moves
+    uint64_t phaseIndex(int phase, const cubieCube& cube) const;
+    uint64_t phaseMove(int phase, uint64_t index, int move) const;
+
+private:
+    const thistlethwaiteMoves* mMoves = nullptr;
+    const uint8_t* mPrune[THISTLETHWAITE_PHASE_COUNT] = {};
+    std::unique_ptr<thistlethwaiteMoves> mGeneratedMoves;
+    packedTable mGeneratedPrune[THISTLETHWAITE_PHASE_COUNT];
+    tableFile mFile;
+};
+
+//Thistlethwaite's subgroup chain G0 -> G1 = <U, D, R, L, F2, B2> -> G2 = <U, D, R2, L2, F2, B2> -> G3 = <U2, D2, R2, L2, F2, B2> -> solved
+//Each phase follows its exact distance table down to the next subgroup, so a solve is a fixed amount of work with no search:
+//at most MAX_LENGTH steps of at most 18 lookups, for the cube and for its inverse, whichever gives the shorter solution.
+//Solutions average about 30 moves. Meant as the fallback engine where the two-phase tables do not fit
+class thistlethwaiteSolver
+{
+public:
+    static constexpr int MAX_LENGTH = 45;   //7 + 10 + 13 + 15, the longest distance of each phase
+
+    thistlethwaiteSolver();
+
+    //Throws if the cube is not a legal state. Always finds a solution, the options are accepted for the common API only
+    solverResult solve(const cubieCube& cube, const solverOptions& options = solverOptions());
+
+    //Runs solve on a worker thread and publishes its one solution to the handle, for callers written against the anytime API
+    static std::unique_ptr<solveHandle> solveAnytime(const cubieCube& cube, const solverOptions& options = solverOptions(),
+                                                     solveHandle::solutionCallback onSolution = nullptr);
+
+private:
+    void solvePhases(const cubieCube& cube, std::vector<uint8_t>& moves, uint64_t& lookups) const;
+
+    const thistlethwaiteTables& mTables;
+};
@@ -0,0 +1,431 @@
+#include "twoPhaseSolver.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+//Long phase 2 searches rarely pay off, a slightly longer phase 1 usually reaches a shorter total sooner
+static const int MAX_PHASE2_DEPTH = 10;
+
+//How many nodes to expand between clock reads
+static const uint64_t TIME_CHECK_MASK = 0xFFF;
+
+//120 degree whole-cube rotation around the URF-DBL diagonal. It carries U to R, R to F and F to U
+static cubieCube makeUrf3()
+{
+    static const uint8_t cornerPerm[CORNER_COUNT] = { URF, DFR, DLF, UFL, UBR, DRB, DBL, ULB };
+    static const uint8_t cornerOri[CORNER_COUNT] = { 1, 2, 1, 2, 2, 1, 2, 1 };
+    static const uint8_t edgePerm[EDGE_COUNT] = { UF, FR, DF, FL, UB, BR, DB, BL, UR, DR, DL, UL };
+    static const uint8_t edgeOri[EDGE_COUNT] = { 1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1 };
+
+    cubieCube urf3 = cubieCube::solved();
+    for (int i = 0; i < CORNER_COUNT; i++)
+        urf3.setCorner(i, cornerPerm[i], cornerOri[i]);
+    for (int i = 0; i < EDGE_COUNT; i++)
+        urf3.setEdge(i, edgePerm[i], edgeOri[i]);
+    return urf3;
+}
+
+//Rotations 0, 1 and 2 of URF3, and for each the move of the original cube that a move of the rotated cube stands for
+struct axisRotations
+{
+    cubieCube rotation[3];
+    cubieCube inverse[3];
+    uint8_t originalMove[3][MOVE_COUNT];
+
+    axisRotations()
+    {
+        cubieCube urf3 = makeUrf3();
+        rotation[0] = cubieCube::solved();
+        multiply(rotation[0], urf3, rotation[1]);
+        multiply(rotation[1], urf3, rotation[2]);
+        for (int r = 0; r < 3; r++)
+            inverse[r] = rotation[r].inverse();
+
+        //A solution s of S^-1 * c * S solves c as the sequence of S * s_i * S^-1
+        for (int r = 0; r < 3; r++)
+        {
+            for (int m = 0; m < MOVE_COUNT; m++)
+            {
+                cubieCube turned;
+                cubieCube conjugate;
+                multiply(rotation[r], cubieCube::moveCube(m), turned);
+                multiply(turned, inverse[r], conjugate);
+
+                int match = -1;
+                for (int candidate = 0; candidate < MOVE_COUNT && match < 0; candidate++)
+                    if (cubieCube::moveCube(candidate) == conjugate)
+                        match = candidate;
+                if (match < 0)
+                    throw std::runtime_error("URF3 rotation does not map moves to moves!");
+                originalMove[r][m] = (uint8_t)match;
+            }
+        }
+    }
+};
+
+static const axisRotations& getAxisRotations()
+{
+    static const axisRotations rotations;
+    return rotations;
+}
+
+//Phase 1 children that cannot finish within togo moves, or that sit in G1 but would have to leave and come back
+//within a few moves, which only reaches phase 2 states a shorter phase 1 already covered
+static inline bool prunedPhase1(int distance, int togo)
+{
+    return distance >= togo || (distance == 0 && togo > 1 && togo < 6);
+}
+
+twoPhaseSolver::twoPhaseSolver() : mMoves(moveTables::get()), mPrune(pruneTables::get()), mPhase1Automaton(moveAutomaton::full()),
+    mPhase2Automaton(moveAutomaton::phase2())
+{
+}
+
+solverResult twoPhaseSolver::solve(const cubieCube& cube, const solverOptions& options)
+{
+    return solve(cube, options, nullptr);
+}
+
+solverResult twoPhaseSolver::solve(const cubieCube& cube, const solverOptions& options, solveHandle* handle)
+{
+    if (cube.verify() != 0)
+        throw std::runtime_error("Cube state is not solvable!");
+    requireIntactTables();
+
+    auto startTime = std::chrono::steady_clock::now();
+    mStartTime = startTime;
+    mOptions = options;
+    mHandle = handle;
+    mResult = solverResult();
+    mBestLength = std::min(options.maxLength, MAX_DEPTH - 1) + 1;
+    mFound = false;
+    mStop = false;
+    mNodes = 0;
+    memset(mHits, 0, sizeof(mHits));
+    mDeadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeLimitSeconds));
+
+    int threads = options.threads > 0 ? options.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    if (!mPool || mPool->size() != threads)
+        mPool.reset(new workStealingPool(threads));
+
+    const axisRotations& rotations = getAxisRotations();
+    int shortestPhase1 = MAX_DEPTH;
+    for (int i = 0; i < AXIS_COUNT; i++)
+    {
+        searchAxis& axis = mAxes[i];
+        axis.rotation = i / 2;
+        axis.inverted = (i & 1) != 0;
+
+        cubieCube turned;
+        multiply(rotations.inverse[axis.rotation], cube, turned);
+        multiply(turned, rotations.rotation[axis.rotation], axis.cube);
+        if (axis.inverted)
+            axis.cube = axis.cube.inverse();
+
+        axis.twist = getTwist(axis.cube);
+        axis.flip = getFlip(axis.cube);
+        axis.slice = getSlice(axis.cube);
+        shortestPhase1 = std::min(shortestPhase1, mPrune.phase1Distance(axis.twist, axis.flip, axis.slice));
+    }
+
+    for (int phase1Length = shortestPhase1; phase1Length < mBestLength && !mStop; phase1Length++)
+    {
+        //Canonical move prefixes of the split depth, each one a task per axis
+        int prefixLength = std::min(phase1Length, SPLIT_DEPTH);
+        std::vector<uint8_t> prefixes;
+        if (prefixLength == 0)
+            prefixes.push_back(0);
+        for (int first = 0; first < MOVE_COUNT && prefixLength > 0; first++)
+        {
+            if (prefixLength == 1)
+            {
+                prefixes.push_back((uint8_t)first);
+                continue;
+            }
+            for (int second = 0; second < MOVE_COUNT; second++)
+            {
+                if (mPhase1Automaton.next(mPhase1Automaton.next(moveAutomaton::START, first), second) == moveAutomaton::FORBIDDEN)
+                    continue;
+                prefixes.push_back((uint8_t)first);
+                prefixes.push_back((uint8_t)second);
+            }
+        }
+
+        size_t stride = std::max(prefixLength, 1);
+        for (size_t p = 0; p < prefixes.size(); p += stride)
+        {
+            for (int i = 0; i < AXIS_COUNT; i++)
+            {
+                const searchAxis& axis = mAxes[i];
+                if (mPrune.phase1Distance(axis.twist, axis.flip, axis.slice) > phase1Length)
+                    continue;
+                const uint8_t* prefix = &prefixes[p];
+                mPool->submit([this, &axis, prefix, prefixLength, phase1Length]()
+                {
+                    runTask(axis, prefix, prefixLength, phase1Length);
+                });
+            }
+        }
+        mPool->wait();
+    }
+
+    std::lock_guard<std::mutex> lock(mResultMutex);
+    mResult.nodes = mNodes;
+    memcpy(mResult.pruneHits, mHits, sizeof(mHits));
+    mResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (mHandle != nullptr)
+        mHandle->reportNodes(mResult.nodes);
+    mHandle = nullptr;
+    return mResult;
+}
+
+std::future<solverResult> twoPhaseSolver::solveAsync(const cubieCube& cube, const solverOptions& options)
+{
+    return std::async(std::launch::async, [cube, options]()
+    {
+        twoPhaseSolver solver;
+        return solver.solve(cube, options);
+    });
+}
+
+std::unique_ptr<solveHandle> twoPhaseSolver::solveAnytime(const cubieCube& cube, const solverOptions& options, solveHandle::solutionCallback onSolution)
+{
+    if (cube.verify() != 0)
+        throw std::runtime_error("Cube state is not solvable!");
+
+    std::unique_ptr<solveHandle> handle(new solveHandle(std::move(onSolution)));
+    solveHandle* target = handle.get();
+    handle->start([cube, options, target]()
+    {
+        twoPhaseSolver solver;
+        return solver.solve(cube, options, target);
+    });
+    return handle;
+}
+
+bool twoPhaseSolver::outOfTime(uint64_t nodes)
+{
+    if (mHandle != nullptr && mHandle->cancelled())
+        return true;
+    if (mOptions.nodeLimit > 0 && nodes >= mOptions.nodeLimit)
+        return true;
+
+    //The time limit only ends the search once there is something to return, the deadline always does
+    auto now = std::chrono::steady_clock::now();
+    return now >= mOptions.deadline || (mFound && now >= mDeadline);
+}
+
+//Called every TIME_CHECK_MASK + 1 nodes of a task: adds them to the shared count and checks the limits
+void twoPhaseSolver::checkpoint(searchContext& context)
+{
+    uint64_t nodes = mNodes += context.nodes - context.reported;
+    context.reported = context.nodes;
+    if (mHandle != nullptr)
+        mHandle->reportNodes(nodes);
+    if (outOfTime(nodes))
+        mStop = true;
+}
+
+void twoPhaseSolver::runTask(const searchAxis& axis, const uint8_t* prefix, int prefixLength, int phase1Length)
+{
+    //Most tasks end before their first checkpoint, so the limits are also checked once per task
+    if (!mStop && outOfTime(mNodes))
+        mStop = true;
+    if (mStop)
+        return;
+
+    searchContext context = {};
+    context.axis = &axis;
+
+    int twist = axis.twist;
+    int flip = axis.flip;
+    int slice = axis.slice;
+    uint16_t state = moveAutomaton::START;
+    for (int i = 0; i < prefixLength; i++)
+    {
+        int m = prefix[i];
+        state = mPhase1Automaton.next(state, m);
+        twist = mMoves.twist[twist][m];
+        flip = mMoves.flip[flip][m];
+        slice = mMoves.slice[slice][m];
+        context.nodes++;
+        if (prunedPhase1(mPrune.phase1Distance(twist, flip, slice), phase1Length - i))
+        {
+            finishTask(context);
+            return;
+        }
+        context.path[i] = (uint8_t)m;
+    }
+
+    searchPhase1(context, twist, flip, slice, prefixLength, phase1Length - prefixLength, state);
+    finishTask(context);
+}
+
+void twoPhaseSolver::finishTask(const searchContext& context)
+{
+    mNodes += context.nodes - context.reported;
+    if (RUBIK_SOLVER_STATS)
+    {
+        std::lock_guard<std::mutex> lock(mResultMutex);
+        for (int phase = 0; phase < 2; phase++)
+            for (int value = 0; value < PRUNE_HIT_VALUES; value++)
+                mHits[phase][value] += context.hits[phase][value];
+    }
+}
+
+//Returns true when the whole search should stop
+bool twoPhaseSolver::searchPhase1(searchContext& context, int twist, int flip, int slice, int depth, int togo, uint16_t state)
+{
+    if (togo == 0)
+    {
+        //The heuristic is 0 only inside G1. A phase 1 ending in a G1 move was already tried one move shorter
+        if (depth > 0 && isPhase2Move(context.path[depth - 1]))
+            return false;
+        return startPhase2(context, depth);
+    }
+
+    //The phase 1 table is far larger than the caches. Prefetching the entries of all children before reading the first one
+    //overlaps their misses, where looking each one up after the subtree of the one before would wait for every miss in turn
+    uint8_t moves[MOVE_COUNT];
+    uint16_t states[MOVE_COUNT];
+    uint32_t indices[MOVE_COUNT];
+    int children = 0;
+    for (int m = 0; m < MOVE_COUNT; m++)
+    {
+        uint16_t nextState = mPhase1Automaton.next(state, m);
+        if (nextState == moveAutomaton::FORBIDDEN)
+            continue;
+        uint32_t index = mPrune.phase1Index(mMoves.twist[twist][m], mMoves.flip[flip][m], mMoves.slice[slice][m]);
+        mPrune.flipSliceTwist.prefetch(index);
+        moves[children] = (uint8_t)m;
+        states[children] = nextState;
+        indices[children++] = index;
+    }
+
+    for (int i = 0; i < children; i++)
+    {
+        int m = moves[i];
+        int distance = mPrune.phase1DistanceAt(indices[i]);
+        if (RUBIK_SOLVER_STATS)
+            context.hits[0][distance]++;
+        if (prunedPhase1(distance, togo))
+            continue;
+
+        int nextTwist = mMoves.twist[twist][m];
+        int nextFlip = mMoves.flip[flip][m];
+        int nextSlice = mMoves.slice[slice][m];
+
+        if ((++context.nodes & TIME_CHECK_MASK) == 0)
+            checkpoint(context);
+        if (mStop)
+            return true;
+
+        context.path[depth] = (uint8_t)m;
+        if (searchPhase1(context, nextTwist, nextFlip, nextSlice, depth + 1, togo - 1, states[i]))
+            return true;
+    }
+    return false;
+}
+
+bool twoPhaseSolver::startPhase2(searchContext& context, int phase1Length)
+{
+    //Other workers may have lowered the bound since this phase 1 started
+    int maxDepth = std::min(mBestLength.load(std::memory_order_relaxed) - 1 - phase1Length, MAX_PHASE2_DEPTH);
+    if (maxDepth < 0)
+        return false;
+
+    //Phase 2 coordinates are not derived from the phase 1 ones, replaying the moves on the cubie state is cheaper
+    cubieCube cube = context.axis->cube;
+    applyMoves(cube, context.path, phase1Length);
+    int cornerPerm = getCornerPerm(cube);
+    int udEdgePerm = getUdEdgePerm(cube);
+    int slicePerm = getSliceSorted(cube);
+
+    int lastMove = phase1Length > 0 ? context.path[phase1Length - 1] : -1;
+    for (int depth = mPrune.phase2Distance(cornerPerm, udEdgePerm, slicePerm); depth <= maxDepth && !mStop; depth++)
+    {
+        if (searchPhase2(context, cornerPerm, udEdgePerm, slicePerm, phase1Length, depth, moveAutomaton::START, lastMove))
+        {
+            recordSolution(context, phase1Length + depth);
+            break;
+        }
+    }
+    return mStop;
+}
+
+//Returns true when a solution was completed in the context path
+//The phase 2 automaton starts fresh at the phase boundary, canFollow keeps the first phase 2 move from merging with the last phase 1 move
+bool twoPhaseSolver::searchPhase2(searchContext& context, int cornerPerm, int udEdgePerm, int slicePerm, int depth, int togo, uint16_t state, int lastMove)
+{
+    if (togo == 0)
+        return true;
+
+    //Same batching as phase 1, the phase 2 tables mostly live in L2/L3
+    uint8_t moves[PHASE2_MOVE_COUNT];
+    uint16_t states[PHASE2_MOVE_COUNT];
+    int children = 0;
+    for (int i = 0; i < PHASE2_MOVE_COUNT; i++)
+    {
+        int m = PHASE2_MOVES[i];
+        uint16_t nextState = mPhase2Automaton.next(state, m);
+        if (nextState == moveAutomaton::FORBIDDEN || !canFollow(m, lastMove))
+            continue;
+        mPrune.prefetchPhase2(mMoves.cornerPerm[cornerPerm][m], mMoves.udEdgePerm[udEdgePerm][m], mMoves.sliceSorted[slicePerm][m]);
+        moves[children] = (uint8_t)m;
+        states[children++] = nextState;
+    }
+
+    for (int i = 0; i < children; i++)
+    {
+        int m = moves[i];
+        int nextCorner = mMoves.cornerPerm[cornerPerm][m];
+        int nextEdge = mMoves.udEdgePerm[udEdgePerm][m];
+        int nextSlice = mMoves.sliceSorted[slicePerm][m];
+        int distance = mPrune.phase2Distance(nextCorner, nextEdge, nextSlice);
+        if (RUBIK_SOLVER_STATS)
+            context.hits[1][distance]++;
+        if (distance >= togo)
+            continue;
+
+        if ((++context.nodes & TIME_CHECK_MASK) == 0)
+            checkpoint(context);
+        if (mStop)
+            return false;
+
+        context.path[depth] = (uint8_t)m;
+        if (searchPhase2(context, nextCorner, nextEdge, nextSlice, depth + 1, togo - 1, states[i], m))
+            return true;
+    }
+    return false;
+}
+
+void twoPhaseSolver::recordSolution(const searchContext& context, int length)
+{
+    std::lock_guard<std::mutex> lock(mResultMutex);
+    if (mFound && length >= mBestLength)
+        return;
+
+    //Undo the axis: an inverse solution is reversed with every move inverted, then moves are rotated back
+    const searchAxis& axis = *context.axis;
+    const axisRotations& rotations = getAxisRotations();
+    mResult.moves.resize(length);
+    for (int i = 0; i < length; i++)
+    {
+        int m = axis.inverted ? inverseMove(context.path[length - 1 - i]) : context.path[i];
+        mResult.moves[i] = rotations.originalMove[axis.rotation][m];
+    }
+    mResult.found = true;
+    mFound = true;
+    mBestLength = length;
+
+    if (mHandle != nullptr)
+    {
+        solverResult progress = mResult;
+        progress.nodes = mNodes;
+        progress.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count();
+        mHandle->publish(progress);
+    }
+
+    if (length <= mOptions.targetLength || outOfTime(mNodes))
+        mStop = true;
+}
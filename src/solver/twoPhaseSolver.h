@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "moveAutomaton.h"
+#include "pruneTables.h"
+#include "solveHandle.h"
+#include "solverResult.h"
+#include "workStealingPool.h"
+
+//Kociemba's two-phase algorithm: phase 1 reaches the subgroup G1 = <U, D, R2, F2, L2, B2>, phase 2 solves within G1
+//Phase 1 solutions are enumerated by increasing length, each one followed by a bounded phase 2 search, so the best
+//solution found shortens the longer the search runs
+//The cube is searched along six axes at once (G1 around the UD, RL and FB axis, each for the cube and its inverse).
+//Each phase 1 depth is split into one task per axis and two-move prefix on a work-stealing pool, and every task
+//prunes phase 2 against the shared best length
+class twoPhaseSolver
+{
+public:
+    twoPhaseSolver();
+
+    //Throws if the cube is not a legal state. Unless maxLength is below about 22, a solution is returned even past the time limit
+    solverResult solve(const cubieCube& cube, const solverOptions& options = solverOptions());
+
+    //Same, reporting progress and each shorter solution to handle and stopping when it is cancelled
+    solverResult solve(const cubieCube& cube, const solverOptions& options, solveHandle* handle);
+
+    //Runs solve on a worker thread, the first call also builds the tables there so the caller never blocks
+    static std::future<solverResult> solveAsync(const cubieCube& cube, const solverOptions& options = solverOptions());
+
+    //Anytime search: the first solution usually arrives within a millisecond and shorter ones follow until the target
+    //length, the time limit, a hard limit or handle->cancel(). Throws here, not on the worker, if the cube is not legal
+    static std::unique_ptr<solveHandle> solveAnytime(const cubieCube& cube, const solverOptions& options = solverOptions(),
+                                                     solveHandle::solutionCallback onSolution = nullptr);
+
+private:
+    static constexpr int MAX_DEPTH = 32;
+    static constexpr int AXIS_COUNT = 6;
+    static constexpr int SPLIT_DEPTH = 2;
+
+    struct searchAxis
+    {
+        cubieCube cube;
+        int twist;
+        int flip;
+        int slice;
+        int rotation;
+        bool inverted;
+    };
+
+    struct searchContext
+    {
+        const searchAxis* axis;
+        uint8_t path[MAX_DEPTH];
+        uint64_t nodes;
+        uint64_t reported;  //Part of nodes already added to mNodes
+        uint64_t hits[2][PRUNE_HIT_VALUES];
+    };
+
+    void runTask(const searchAxis& axis, const uint8_t* prefix, int prefixLength, int phase1Length);
+    bool searchPhase1(searchContext& context, int twist, int flip, int slice, int depth, int togo, uint16_t state);
+    bool startPhase2(searchContext& context, int phase1Length);
+    bool searchPhase2(searchContext& context, int cornerPerm, int udEdgePerm, int slicePerm, int depth, int togo, uint16_t state, int lastMove);
+    void recordSolution(const searchContext& context, int length);
+    void checkpoint(searchContext& context);
+    void finishTask(const searchContext& context);
+    bool outOfTime(uint64_t nodes);
+
+    const moveTables& mMoves;
+    const pruneTables& mPrune;
+    const moveAutomaton& mPhase1Automaton;
+    const moveAutomaton& mPhase2Automaton;
+    std::unique_ptr<workStealingPool> mPool;
+
+    solverOptions mOptions;
+    solveHandle* mHandle = nullptr;
+    searchAxis mAxes[AXIS_COUNT];
+    std::chrono::steady_clock::time_point mStartTime;
+    std::chrono::steady_clock::time_point mDeadline;
+
+    std::atomic<int> mBestLength{0};
+    std::atomic<bool> mFound{false};
+    std::atomic<bool> mStop{false};
+    std::atomic<uint64_t> mNodes{0};
+    std::mutex mResultMutex;
+    uint64_t mHits[2][PRUNE_HIT_VALUES];
+    solverResult mResult;
+};
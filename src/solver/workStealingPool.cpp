@@ -0,0 +1,106 @@
+#include "workStealingPool.h"
+#include <algorithm>
+
+//Which pool and deque the current thread works for, so tasks submitted from inside a task stay local
+static thread_local const workStealingPool* tCurrentPool = nullptr;
+static thread_local int tWorkerIndex = -1;
+
+workStealingPool::workStealingPool(int threads)
+{
+    if (threads <= 0)
+        threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 0; i < threads; i++)
+        mQueues.push_back(std::unique_ptr<taskQueue>(new taskQueue()));
+    for (int i = 0; i < threads; i++)
+        mThreads.emplace_back(&workStealingPool::workerLoop, this, i);
+}
+
+workStealingPool::~workStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mShutdown = true;
+    }
+    mWake.notify_all();
+    for (std::thread& thread : mThreads)
+        thread.join();
+}
+
+void workStealingPool::submit(std::function<void()> task)
+{
+    int index = tCurrentPool == this ? tWorkerIndex : (int)(mNextQueue++ % mQueues.size());
+    mPending++;
+    {
+        //Counted before it is pushed so a thief can never take it while the count is still 0
+        //Taking the sleep lock orders the update against a worker checking the count before sleeping
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mQueued++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mQueues[index]->mutex);
+        mQueues[index]->tasks.push_back(std::move(task));
+    }
+    mWake.notify_one();
+}
+
+void workStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mSleepMutex);
+    mIdle.wait(lock, [this]() { return mPending == 0; });
+}
+
+bool workStealingPool::takeTask(int index, std::function<void()>& task)
+{
+    {
+        taskQueue& own = *mQueues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < mQueues.size(); offset++)
+    {
+        taskQueue& victim = *mQueues[(index + offset) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void workStealingPool::workerLoop(int index)
+{
+    tCurrentPool = this;
+    tWorkerIndex = index;
+
+    std::function<void()> task;
+    while (true)
+    {
+        if (takeTask(index, task))
+        {
+            mQueued--;
+            task();
+            task = nullptr;
+            if (--mPending == 0)
+            {
+                std::lock_guard<std::mutex> lock(mSleepMutex);
+                mIdle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWake.wait(lock, [this]() { return mQueued > 0 || mShutdown; });
+        if (mShutdown && mQueued == 0)
+            return;
+    }
+}
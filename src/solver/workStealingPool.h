@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed set of worker threads, each with its own task deque
+//A worker pops its newest task first (depth first, cache warm) and steals the oldest task of another worker when it runs dry
+class workStealingPool
+{
+public:
+    //0 uses every hardware thread
+    explicit workStealingPool(int threads = 0);
+    ~workStealingPool();
+    workStealingPool(const workStealingPool&) = delete;
+    workStealingPool& operator=(const workStealingPool&) = delete;
+
+    int size() const { return (int)mThreads.size(); }
+
+    //From a worker the task goes on that worker's deque, from outside the deques are filled round robin
+    void submit(std::function<void()> task);
+
+    //Blocks until every submitted task has finished, including tasks submitted by tasks
+    void wait();
+
+private:
+    struct taskQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(int index);
+    bool takeTask(int index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<taskQueue>> mQueues;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mSleepMutex;
+    std::condition_variable mWake;
+    std::condition_variable mIdle;
+    std::atomic<size_t> mQueued{0};
+    std::atomic<size_t> mPending{0};
+    std::atomic<size_t> mNextQueue{0};
+    bool mShutdown = false;
+};
@@ -0,0 +1,691 @@
+#include "solverService.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #define RUBIK_HAS_UNIX_SOCKETS 1
+#else
+    #define RUBIK_HAS_UNIX_SOCKETS 0
+#endif
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+//Where results for one input stream go. Socket descriptors stay open until the last queued result has been written
+struct solverService::serviceClient
+{
+    int fd = -1;    //-1 is stdin/stdout
+    std::mutex mutex;
+    bool open = true;
+
+    ~serviceClient()
+    {
+#if RUBIK_HAS_UNIX_SOCKETS
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    void write(const std::string& line)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd < 0)
+        {
+            fwrite(line.data(), 1, line.size(), stdout);
+            fputc('\n', stdout);
+            fflush(stdout);
+            return;
+        }
+#if RUBIK_HAS_UNIX_SOCKETS
+        std::string data = line + "\n";
+        size_t sent = 0;
+        while (open && sent < data.size())
+        {
+            ssize_t count = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (count <= 0)
+                open = false;
+            else
+                sent += (size_t)count;
+        }
+#endif
+    }
+};
+
+struct solverService::solveRequest
+{
+    std::string id;     //Already encoded as JSON
+    cubieCube cube;
+    solverOptions options;
+    std::shared_ptr<serviceClient> client;
+    std::chrono::steady_clock::time_point received;
+};
+
+struct jsonValue
+{
+    std::string text;
+    bool isString;
+};
+
+static std::string jsonEscape(const std::string& text)
+{
+    std::string escaped = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else
+            escaped += c;
+    }
+    return escaped + "\"";
+}
+
+//A JSON number exactly as the grammar allows: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool isJsonNumber(const std::string& text)
+{
+    size_t i = 0;
+    auto digits = [&]()
+    {
+        size_t start = i;
+        while (i < text.size() && isdigit((unsigned char)text[i]))
+            i++;
+        return i > start;
+    };
+
+    if (i < text.size() && text[i] == '-')
+        i++;
+    if (i < text.size() && text[i] == '0')
+        i++;
+    else if (!digits())
+        return false;
+    if (i < text.size() && text[i] == '.')
+    {
+        i++;
+        if (!digits())
+            return false;
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+    {
+        i++;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-'))
+            i++;
+        if (!digits())
+            return false;
+    }
+    return i == text.size();
+}
+
+//Request ids are echoed back verbatim, so only numbers and literals go out unquoted, anything else is sent back as a string
+static std::string jsonId(const jsonValue& value)
+{
+    if (!value.isString && (isJsonNumber(value.text) || value.text == "true" || value.text == "false" || value.text == "null"))
+        return value.text;
+    return jsonEscape(value.text);
+}
+
+static bool readHex4(const std::string& text, size_t at, uint32_t& code)
+{
+    if (at + 4 > text.size())
+        return false;
+    code = 0;
+    for (size_t i = at; i < at + 4; i++)
+    {
+        char c = text[i];
+        int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (digit < 0)
+            return false;
+        code = code << 4 | (uint32_t)digit;
+    }
+    return true;
+}
+
+static void appendUtf8(std::string& out, uint32_t code)
+{
+    if (code < 0x80)
+        out += (char)code;
+    else if (code < 0x800)
+    {
+        out += (char)(0xC0 | code >> 6);
+        out += (char)(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000)
+    {
+        out += (char)(0xE0 | code >> 12);
+        out += (char)(0x80 | (code >> 6 & 0x3F));
+        out += (char)(0x80 | (code & 0x3F));
+    }
+    else
+    {
+        out += (char)(0xF0 | code >> 18);
+        out += (char)(0x80 | (code >> 12 & 0x3F));
+        out += (char)(0x80 | (code >> 6 & 0x3F));
+        out += (char)(0x80 | (code & 0x3F));
+    }
+}
+
+//Reads one flat JSON object of string, number and literal values. Nested objects and arrays are rejected
+static bool parseFlatJson(const std::string& text, std::map<std::string, jsonValue>& values)
+{
+    size_t i = 0;
+    auto skipSpace = [&]() { while (i < text.size() && isspace((unsigned char)text[i])) i++; };
+    auto readString = [&](std::string& out) -> bool
+    {
+        if (i >= text.size() || text[i] != '"')
+            return false;
+        for (i++; i < text.size(); i++)
+        {
+            char c = text[i];
+            if (c == '"')
+            {
+                i++;
+                return true;
+            }
+            if (c == '\\')
+            {
+                if (++i >= text.size())
+                    return false;
+                c = text[i];
+                if (c == 'u')
+                {
+                    //Surrogate pairs come as two escapes, a lone half is rejected
+                    uint32_t code;
+                    if (!readHex4(text, i + 1, code))
+                        return false;
+                    i += 4;
+                    if (code >= 0xDC00 && code <= 0xDFFF)
+                        return false;
+                    if (code >= 0xD800 && code <= 0xDBFF)
+                    {
+                        uint32_t low;
+                        if (i + 2 >= text.size() || text[i + 1] != '\\' || text[i + 2] != 'u' || !readHex4(text, i + 3, low)
+                            || low < 0xDC00 || low > 0xDFFF)
+                            return false;
+                        i += 6;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, code);
+                    continue;
+                }
+                static const char ESCAPED[] = "\"\\/bfnrt";
+                static const char DECODED[] = "\"\\/\b\f\n\r\t";
+                const char* escape = c ? strchr(ESCAPED, c) : nullptr;
+                if (escape == nullptr)
+                    return false;
+                c = DECODED[escape - ESCAPED];
+            }
+            out += c;
+        }
+        return false;
+    };
+
+    skipSpace();
+    if (i >= text.size() || text[i++] != '{')
+        return false;
+    skipSpace();
+    if (i < text.size() && text[i] == '}')
+        return true;
+
+    while (i < text.size())
+    {
+        std::string key;
+        skipSpace();
+        if (!readString(key))
+            return false;
+        skipSpace();
+        if (i >= text.size() || text[i++] != ':')
+            return false;
+        skipSpace();
+
+        jsonValue value;
+        value.isString = i < text.size() && text[i] == '"';
+        if (value.isString)
+        {
+            if (!readString(value.text))
+                return false;
+        }
+        else
+        {
+            while (i < text.size() && text[i] != ',' && text[i] != '}' && !isspace((unsigned char)text[i]))
+                value.text += text[i++];
+            if (value.text.empty() || value.text[0] == '{' || value.text[0] == '[')
+                return false;
+        }
+        values[key] = value;
+
+        skipSpace();
+        if (i < text.size() && text[i] == ',')
+        {
+            i++;
+            continue;
+        }
+        return i < text.size() && text[i] == '}';
+    }
+    return false;
+}
+
+solverService::solverService(const serviceOptions& options) : mOptions(options)
+{
+    if (mOptions.workers <= 0)
+        mOptions.workers = (int)std::max(1u, std::thread::hardware_concurrency());
+    if (mOptions.queueCapacity == 0)
+        mOptions.queueCapacity = 1;
+
+    //Throughput comes from solving many cubes at once, so every worker searches on a single thread
+    mOptions.solver.threads = 1;
+
+    if (mOptions.cacheEntries > 0)
+        mCache.reset(new solutionCache(mOptions.cacheEntries));
+}
+
+solverService::~solverService()
+{
+    closeQueue();
+    for (std::thread& worker : mWorkers)
+        worker.join();
+}
+
+int solverService::run()
+{
+    auto tableStart = std::chrono::steady_clock::now();
+    if (mOptions.engine == solverEngine::thistlethwaite)
+        thistlethwaiteTables::get();
+    else
+        pruneTables::get();
+    int frontierDepth = frontierTable::depthForBudget(mOptions.frontierBytes);
+    if (mOptions.engine == solverEngine::twoPhase && frontierDepth > 0)
+        mFrontier = &frontierTable::get(frontierDepth);
+    std::cerr << "Solver tables ready in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tableStart).count()
+              << " ms, " << mOptions.workers << " workers\n";
+
+    if (mCache && !mOptions.cachePath.empty() && mCache->load(mOptions.cachePath))
+        std::cerr << "Loaded " << mCache->size() << " cached solutions\n";
+
+    mStartTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < mOptions.workers; i++)
+        mWorkers.emplace_back(&solverService::workerLoop, this);
+
+    if (!mOptions.socketPath.empty())
+        return serveSocket();
+
+    readLines(std::make_shared<serviceClient>());
+    closeQueue();
+    for (std::thread& worker : mWorkers)
+        worker.join();
+    mWorkers.clear();
+    if (mCache && !mOptions.cachePath.empty())
+        std::cerr << saveCache() << "\n";
+    return EXIT_SUCCESS;
+}
+
+void solverService::readLines(std::shared_ptr<serviceClient> client)
+{
+    if (client->fd < 0)
+    {
+        std::string line;
+        while (std::getline(std::cin, line))
+            handleLine(client, line);
+        return;
+    }
+
+#if RUBIK_HAS_UNIX_SOCKETS
+    std::string pending;
+    char buffer[4096];
+    while (true)
+    {
+        ssize_t count = recv(client->fd, buffer, sizeof(buffer), 0);
+        if (count <= 0)
+            break;
+        pending.append(buffer, (size_t)count);
+
+        size_t start = 0;
+        for (size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', start))
+        {
+            handleLine(client, pending.substr(start, end - start));
+            start = end + 1;
+        }
+        pending.erase(0, start);
+    }
+    if (!pending.empty())
+        handleLine(client, pending);
+#endif
+}
+
+void solverService::handleLine(const std::shared_ptr<serviceClient>& client, const std::string& rawLine)
+{
+    size_t first = rawLine.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+        return;
+    std::string line = rawLine.substr(first, rawLine.find_last_not_of(" \t\r") - first + 1);
+
+    std::map<std::string, jsonValue> fields;
+    if (line[0] == '{' && !parseFlatJson(line, fields))
+    {
+        mFailed++;
+        client->write("{\"id\":null,\"error\":\"Malformed JSON request\"}");
+        return;
+    }
+
+    if (line == "stats" || (fields.count("cmd") && fields["cmd"].text == "stats"))
+    {
+        client->write(statsJson());
+        return;
+    }
+    if (line == "save" || (fields.count("cmd") && fields["cmd"].text == "save"))
+    {
+        client->write(saveCache());
+        return;
+    }
+
+    std::unique_ptr<solveRequest> request(new solveRequest());
+    request->client = client;
+    request->options = mOptions.solver;
+    request->received = std::chrono::steady_clock::now();
+    if (fields.count("id"))
+        request->id = jsonId(fields["id"]);
+    else
+        request->id = std::to_string(++mAutoId);
+    mReceived++;
+
+    auto fail = [&](const std::string& message)
+    {
+        mFailed++;
+        client->write("{\"id\":" + request->id + ",\"error\":" + jsonEscape(message) + "}");
+    };
+
+    if (fields.count("timeLimit"))
+        request->options.timeLimitSeconds = atof(fields["timeLimit"].text.c_str());
+    if (fields.count("targetLength"))
+        request->options.targetLength = atoi(fields["targetLength"].text.c_str());
+    if (fields.count("maxLength"))
+        request->options.maxLength = atoi(fields["maxLength"].text.c_str());
+
+    if (line[0] != '{' || fields.count("facelets"))
+    {
+        faceletError error = cubieCube::checkFacelets(line[0] != '{' ? line : fields["facelets"].text, request->cube);
+        if (error != faceletError::none)
+            return fail(std::string("Invalid facelet string: ") + faceletErrorName(error));
+    }
+    else if (fields.count("scramble"))
+    {
+        try
+        {
+            request->cube = cubieCube::solved();
+            request->cube.apply(parseMoves(fields["scramble"].text));
+        }
+        catch (const std::exception& error)
+        {
+            return fail(error.what());
+        }
+    }
+    else
+        return fail("Request needs facelets or scramble");
+
+    if (request->cube.verify() != 0)
+        return fail("Cube state is not solvable");
+
+    push(std::move(request));
+}
+
+bool solverService::push(std::unique_ptr<solveRequest> request)
+{
+    std::unique_lock<std::mutex> lock(mQueueMutex);
+    mNotFull.wait(lock, [this]() { return mQueue.size() < mOptions.queueCapacity || mClosed; });
+    if (mClosed)
+        return false;
+    mQueue.push_back(std::move(request));
+    mNotEmpty.notify_one();
+    return true;
+}
+
+std::unique_ptr<solverService::solveRequest> solverService::pop()
+{
+    std::unique_lock<std::mutex> lock(mQueueMutex);
+    mNotEmpty.wait(lock, [this]() { return !mQueue.empty() || mClosed; });
+    if (mQueue.empty())
+        return nullptr;
+    std::unique_ptr<solveRequest> request = std::move(mQueue.front());
+    mQueue.pop_front();
+    mNotFull.notify_one();
+    return request;
+}
+
+void solverService::closeQueue()
+{
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+    mClosed = true;
+    mNotEmpty.notify_all();
+    mNotFull.notify_all();
+}
+
+void solverService::workerLoop()
+{
+    //Only the selected engine is built, so a thistlethwaite service never maps the two-phase tables
+    std::unique_ptr<twoPhaseSolver> twoPhase;
+    std::unique_ptr<thistlethwaiteSolver> thistlethwaite;
+    if (mOptions.engine == solverEngine::thistlethwaite)
+        thistlethwaite.reset(new thistlethwaiteSolver());
+    else
+        twoPhase.reset(new twoPhaseSolver());
+    std::unique_ptr<bidirectionalSolver> bidirectional;
+    if (mFrontier != nullptr)
+        bidirectional.reset(new bidirectionalSolver(*mFrontier));
+
+    while (std::unique_ptr<solveRequest> request = pop())
+    {
+        std::ostringstream out;
+        out << "{\"id\":" << request->id;
+        try
+        {
+            //A cached solution longer than this request's target is searched again, the shorter one replaces it.
+            //Thistlethwaite has no search that could do better, it takes any cached solution
+            solverResult result;
+            bool optimal = false;
+            bool cached = mCache && mCache->lookup(request->cube, result.moves, optimal)
+                && (thistlethwaite || (int)result.moves.size() <= request->options.targetLength);
+            if (cached)
+                result.found = true;
+            else
+            {
+                optimal = false;
+                result = thistlethwaite ? thistlethwaite->solve(request->cube, request->options) : twoPhase->solve(request->cube, request->options);
+
+                //Short enough to search every shorter length: a solution found there replaces the two-phase one, none proves it optimal
+                int shorter = (int)result.moves.size() - 1;
+                if (bidirectional && result.found && shorter >= 0 && shorter <= mFrontier->depth() + FRONTIER_FORWARD_DEPTH)
+                {
+                    bidirectionalOptions meetOptions;
+                    meetOptions.maxLength = shorter;
+                    meetOptions.threads = 1;
+                    solverResult meet = bidirectional->solve(request->cube, meetOptions);
+                    if (meet.found)
+                        result.moves = meet.moves;
+                    result.nodes += meet.nodes;
+                    result.seconds += meet.seconds;
+                    optimal = true;
+                }
+                if (mCache && result.found)
+                    mCache->insert(request->cube, result.moves, optimal);
+            }
+            double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - request->received).count();
+            recordLatency(latency);
+            mSolved++;
+            mNodes += result.nodes;
+            mMoveTotal += result.moves.size();
+
+            out << ",\"solution\":" << jsonEscape(formatMoves(result.moves)) << ",\"length\":" << result.moves.size()
+                << ",\"solveMs\":" << result.seconds * 1000.0 << ",\"latencyMs\":" << latency * 1000.0 << ",\"nodes\":" << result.nodes;
+            if (optimal)
+                out << ",\"optimal\":true";
+            if (cached)
+                out << ",\"cached\":true";
+            out << "}";
+        }
+        catch (const std::exception& error)
+        {
+            mFailed++;
+            out << ",\"error\":" << jsonEscape(error.what()) << "}";
+        }
+        request->client->write(out.str());
+    }
+}
+
+void solverService::recordLatency(double seconds)
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    if (mLatencies.size() < LATENCY_WINDOW)
+        mLatencies.push_back((float)seconds);
+    else
+        mLatencies[mLatencyNext] = (float)seconds;
+    mLatencyNext = (mLatencyNext + 1) % LATENCY_WINDOW;
+}
+
+std::string solverService::statsJson()
+{
+    std::vector<float> latencies;
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        latencies = mLatencies;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) -> double
+    {
+        if (latencies.empty())
+            return 0.0;
+        return latencies[std::min(latencies.size() - 1, (size_t)(p * latencies.size()))] * 1000.0;
+    };
+
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        queued = mQueue.size();
+    }
+
+    double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count();
+    uint64_t solved = mSolved;
+    std::ostringstream out;
+    out << "{\"stats\":{\"received\":" << mReceived << ",\"solved\":" << solved << ",\"failed\":" << mFailed << ",\"queued\":" << queued
+        << ",\"workers\":" << mOptions.workers
+        << ",\"engine\":\"" << (mOptions.engine == solverEngine::thistlethwaite ? "thistlethwaite" : "twophase") << "\""
+        << ",\"frontierDepth\":" << (mFrontier ? mFrontier->depth() : 0)
+        << ",\"uptimeSeconds\":" << uptime
+        << ",\"solvesPerSecond\":" << (uptime > 0.0 ? solved / uptime : 0.0)
+        << ",\"averageLength\":" << (solved ? (double)mMoveTotal / solved : 0.0)
+        << ",\"nodes\":" << mNodes
+        << ",\"latencyMs\":{\"p50\":" << percentile(0.50) << ",\"p95\":" << percentile(0.95) << ",\"p99\":" << percentile(0.99)
+        << ",\"max\":" << (latencies.empty() ? 0.0 : latencies.back() * 1000.0) << ",\"window\":" << latencies.size() << "}";
+    if (mCache)
+        out << ",\"cache\":{\"entries\":" << mCache->size() << ",\"capacity\":" << mCache->capacity() << ",\"hits\":" << mCache->hits()
+            << ",\"misses\":" << mCache->misses() << "}";
+    out << "}}";
+    return out.str();
+}
+
+std::string solverService::saveCache()
+{
+    if (!mCache || mOptions.cachePath.empty())
+        return "{\"error\":\"No cache snapshot path, start with --cache-file\"}";
+    try
+    {
+        mCache->save(mOptions.cachePath);
+        return "{\"saved\":" + std::to_string(mCache->size()) + "}";
+    }
+    catch (const std::exception& error)
+    {
+        return "{\"error\":" + jsonEscape(error.what()) + "}";
+    }
+}
+
+int solverService::serveSocket()
+{
+#if RUBIK_HAS_UNIX_SOCKETS
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        throw std::runtime_error("Failed to create solver socket!");
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (mOptions.socketPath.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Solver socket path is too long!");
+    strcpy(address.sun_path, mOptions.socketPath.c_str());
+    unlink(mOptions.socketPath.c_str());
+
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0)
+    {
+        close(listener);
+        throw std::runtime_error("Failed to listen on solver socket!");
+    }
+    std::cerr << "Listening on " << mOptions.socketPath << "\n";
+
+    //Each connection reads on its own thread, they all share the request queue and workers
+    while (true)
+    {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0)
+            break;
+        std::shared_ptr<serviceClient> client = std::make_shared<serviceClient>();
+        client->fd = fd;
+        std::thread(&solverService::readLines, this, client).detach();
+    }
+    close(listener);
+    return EXIT_FAILURE;
+#else
+    throw std::runtime_error("Unix domain sockets are not supported on this platform!");
+#endif
+}
+
+int runSolverService(int argc, char* argv[])
+{
+    serviceOptions options;
+    for (int i = 0; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--socket" && hasValue)
+            options.socketPath = argv[++i];
+        else if (argument == "--workers" && hasValue)
+            options.workers = atoi(argv[++i]);
+        else if (argument == "--queue" && hasValue)
+            options.queueCapacity = (size_t)atoll(argv[++i]);
+        else if (argument == "--time-limit" && hasValue)
+            options.solver.timeLimitSeconds = atof(argv[++i]);
+        else if (argument == "--target" && hasValue)
+            options.solver.targetLength = atoi(argv[++i]);
+        else if (argument == "--max-length" && hasValue)
+            options.solver.maxLength = atoi(argv[++i]);
+        else if (argument == "--cache" && hasValue)
+            options.cacheEntries = (size_t)atoll(argv[++i]);
+        else if (argument == "--cache-file" && hasValue)
+            options.cachePath = argv[++i];
+        else if (argument == "--frontier-mb" && hasValue)
+            options.frontierBytes = (size_t)atoll(argv[++i]) << 20;
+        else if (argument == "--engine" && hasValue && parseSolverEngine(argv[i + 1], options.engine))
+            i++;
+        else
+        {
+            std::cerr << "Usage: Rubik-Rescue --serve [--socket PATH] [--workers N] [--queue N] [--time-limit SECONDS] [--target MOVES] [--max-length MOVES]"
+                         " [--cache ENTRIES] [--cache-file PATH] [--frontier-mb MB] [--engine twophase|thistlethwaite]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    solverService service(options);
+    return service.run();
+}
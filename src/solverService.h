@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "solver/bidirectionalSolver.h"
+#include "solver/solutionCache.h"
+#include "solver/thistlethwaiteSolver.h"
+#include "solver/twoPhaseSolver.h"
+
+struct serviceOptions
+{
+    std::string socketPath;         //Empty serves stdin/stdout
+    int workers = 0;                //0 uses every hardware thread
+    size_t queueCapacity = 1024;    //Readers block once this many requests wait, which stops them reading input
+    size_t cacheEntries = 1 << 16;  //Solutions kept for repeated scrambles, 0 disables the cache
+    std::string cachePath;          //Snapshot loaded at start and saved when the input ends or on "save"
+    solverEngine engine = defaultSolverEngine();
+    size_t frontierBytes = DEFAULT_FRONTIER_BYTES;  //Meet in the middle table that makes short two-phase solutions optimal, 0 disables it
+    solverOptions solver;
+};
+
+//Headless batch solver (Rubik-Rescue --serve)
+//Every input line is either a 54 character facelet string or a flat JSON object:
+//  {"id": "a1", "facelets": "UUU...BBB"}, {"id": 7, "scramble": "R U F'", "timeLimit": 0.5, "targetLength": 19}
+//  "stats" or {"cmd": "stats"} answers with throughput and latency percentiles right away
+//  "save" or {"cmd": "save"} writes the solution cache snapshot
+//The thistlethwaite engine (--engine thistlethwaite) loads about 1 MB of tables instead of the two-phase ones
+//A two-phase solution short enough for the meet in the middle search (about 12 moves with the default 128 MB table) is replaced by
+//an optimal one, or proven optimal, and answered with "optimal": true
+//Scrambles seen before (also rotated, recolored or inverted) are answered from the solution cache without searching
+//Every result is one JSON line carrying the request id. Results come back in completion order, not request order
+class solverService
+{
+public:
+    explicit solverService(const serviceOptions& options);
+    ~solverService();
+
+    int run();
+
+private:
+    struct serviceClient;
+    struct solveRequest;
+
+    void readLines(std::shared_ptr<serviceClient> client);
+    void handleLine(const std::shared_ptr<serviceClient>& client, const std::string& line);
+    void workerLoop();
+    void recordLatency(double seconds);
+    std::string statsJson();
+    std::string saveCache();
+    int serveSocket();
+
+    bool push(std::unique_ptr<solveRequest> request);
+    std::unique_ptr<solveRequest> pop();
+    void closeQueue();
+
+    serviceOptions mOptions;
+    std::vector<std::thread> mWorkers;
+    std::unique_ptr<solutionCache> mCache;
+    const frontierTable* mFrontier = nullptr;
+
+    std::mutex mQueueMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+    std::deque<std::unique_ptr<solveRequest>> mQueue;
+    bool mClosed = false;
+
+    std::chrono::steady_clock::time_point mStartTime;
+    std::atomic<uint64_t> mReceived{0};
+    std::atomic<uint64_t> mSolved{0};
+    std::atomic<uint64_t> mFailed{0};
+    std::atomic<uint64_t> mNodes{0};
+    std::atomic<uint64_t> mMoveTotal{0};
+    std::atomic<uint64_t> mAutoId{0};
+
+    //The most recent latencies, percentiles are computed from these on request
+    static const size_t LATENCY_WINDOW = 8192;
+    std::mutex mStatsMutex;
+    std::vector<float> mLatencies;
+    size_t mLatencyNext = 0;
+};
+
+//Parses the arguments after --serve and runs the service until its input ends
+int runSolverService(int argc, char* argv[]);
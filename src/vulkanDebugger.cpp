@@ -51,7 +51,10 @@ void vulkanDebugger::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreat
     CI.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT; //Receive all information about possible problems without general debug info
     CI.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT; //Receive all message types
     CI.pfnUserCallback = debugCallback; //Pointer to callback function
-    CI.pUserData = nullptr; // Optional
+    CI.pUserData = &messageSink;        //Callback queues into the sink, the logger thread does the slow I/O
+
+    //The instance create info chains this struct too, so the logger has to be running before vkCreateInstance
+    messageSink.start();
 }
 
 void vulkanDebugger::setUpDebugMessenger(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger)
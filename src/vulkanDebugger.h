@@ -6,6 +6,8 @@
 #include <SDL.h>
 #include <SDL_vulkan.h>
 
+#include "debugMessageSink.h"
+
 //If debug, enable validation layers; if release, don't
 #ifdef NDEBUG
     const bool enableValidationLayers = false;
@@ -18,6 +20,7 @@ class vulkanDebugger
 public:
     VkDebugUtilsMessengerEXT debugMessenger;
     VkDebugUtilsMessengerCreateInfoEXT createInfo{};
+    debugMessageSink messageSink;   //Messages are queued here and written by a logger thread instead of inside driver calls
 
     const std::vector<const char*> validationLayers = 
     {
@@ -34,10 +37,13 @@ public:
     //Param 1: The severity of the message (diagnostic, warning, invalid, bug)
     //Param 2: How the message relates (performance, possible mistakes, non-optimal use of Vulkan)
     //Param 3: Contains the details of the message
-    //Param 4: For user's use to place data in
+    //Param 4: For user's use to place data in (points to the messageSink)
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) 
     {
-        std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
+        if (pUserData != nullptr)
+            static_cast<debugMessageSink*>(pUserData)->push(messageSeverity, messageType, pCallbackData);
+        else
+            std::cerr << "validation layer: " << pCallbackData->pMessage << '\n';
 
         return VK_FALSE;
     }